@@ -2,23 +2,115 @@
 #define GAMECORE_HPP
 
 #include "mapGenerator.hpp"
+#include "distanceField.hpp"
+#include "occupancyPyramid.hpp"
+#include "visibleCells.hpp"
+#include "rendThreadPool.hpp"
 #include "gameDataStructures.hpp"
+#include <array>
+#include <cstdint>
+#include <limits>
 
 #define DEFAULT_MAP_PATH "map.txt"
 
+class GameCore;
+
+//-----------------thread-pool-helpers----------------------------
+
+class RayCastSectionFactory : public IRenderingSectionFactory
+{
+public:
+	class RayCastSection : public IRenderingSection
+	{
+	public:
+		RayCastSection(int, int, int, RayCastSectionFactory*);
+		void operator()() const override;
+	protected:
+		RayCastSectionFactory* m_source = nullptr;
+		int m_index = 0;
+	};
+
+	RayCastSectionFactory(int taskNumber, int workers) :
+		IRenderingSectionFactory(taskNumber, workers) {}
+
+	RayCastSection create_section(int index);
+	void set_target(GameCore* core) { m_core = core; }
+	void set_camera_plane(bool useCameraPlane) { m_useCameraPlane = useCameraPlane; }
+
+protected:
+	GameCore* m_core = nullptr;
+	bool m_useCameraPlane = true;
+};
+
+class SightSectionFactory : public IRenderingSectionFactory
+{
+public:
+	class SightSection : public IRenderingSection
+	{
+	public:
+		SightSection(int, int, SightSectionFactory*);
+		void operator()() const override;
+	protected:
+		SightSectionFactory* m_source = nullptr;
+	};
+
+	SightSectionFactory(int taskNumber, int workers) :
+		IRenderingSectionFactory(taskNumber, workers) {}
+
+	SightSection create_section(int index);
+	void set_target(GameCore* core) { m_core = core; }
+	void set_queries(const std::vector<rcm::SightQuery>* queries, std::vector<rcm::SightResult>* results) { m_queries = queries; m_results = results; }
+
+protected:
+	GameCore* m_core = nullptr;
+	const std::vector<rcm::SightQuery>* m_queries = nullptr;
+	std::vector<rcm::SightResult>* m_results = nullptr;
+};
+
+//-----------------------------------------------------------------------
+
 class GameCore
 {
 public:
 	GameCore() = delete;
-	GameCore(rcm::GameCameraVars& gc, rcm::GameMap&, rcm::EntityTransform&);
+	GameCore(rcm::GameCameraVars& gc, rcm::GameMap&, rcm::EntityTransform&, RendThreadPool&);
 
 	void update_entities();
 	void remove_destroyed_entities();
+	/// @brief Cast the walls of every camera in a single thread pool batch, then place the entities billboards
 	void view_by_ray_casting(bool cameraPlane);
 	void start_internal_time();
 
-	const rcm::GameCameraPlane& get_camera_vecs() const { return m_cameraVecs; }
-	const rcm::RayInfoArr& get_ray_info_arr()  const { return m_rayInfoArr; }
+	/// @brief Time spent casting wall rays (all cameras) during the last call to view_by_ray_casting()
+	/// @return : nanoseconds
+	int get_ray_casting_time() const { return m_rayCastingTime; }
+	/// @brief Wall rays filled from their neighbours instead of being cast during the last call to view_by_ray_casting()
+	/// (column subdivision only, see GameCameraVars::raySubdivision)
+	int get_saved_rays() const { return m_savedRays; }
+	/// @brief Wall rays copied from the previous frame instead of being cast during the last call to view_by_ray_casting()
+	/// (camera still, or turned in the non linear perspective)
+	int get_reused_rays() const { return m_reusedRays; }
+
+	/// @brief Add a camera whose walls are cast together with the player ones (e.g. a rear view or a security camera)
+	/// @param vars : fov, render distance, render width (pixelWidth, it can't change) and ray casting options of the camera.
+	/// Visible cells and the frame time target only apply to the player camera
+	/// @param transform : where the camera looks from, it must stay valid until the camera is removed
+	/// @return : index of the camera, the player camera is 0
+	int add_camera(const rcm::GameCameraVars&, const rcm::EntityTransform&);
+	/// @brief Remove an added camera, the ones after it move back by one index
+	void remove_camera(int);
+	int get_cameras_number() const { return static_cast<int>(m_cameras.size()); }
+
+	const rcm::GameCameraPlane& get_camera_vecs(int camera = 0) const { return m_cameras.at(camera)->cameraVecs; }
+	const rcm::RayInfoArr& get_ray_info_arr(int camera = 0) const { return m_cameras.at(camera)->rays; }
+	const rcm::GameCameraVars& get_camera_vars(int camera = 0) const { return m_cameras.at(camera)->vars; }
+	/// @brief Direction of the wall ray of a column in the last frame: unit vector in the non linear perspective,
+	/// unitary length along the view direction in the linear one
+	math::Vect2 get_column_ray_direction(int column, int camera = 0) const;
+	/// @brief Billboards of the entities seen by an added camera in the last frame (the player camera writes the ones of the entities)
+	const std::vector<rcm::Billboard>& get_camera_billboards(int camera) const { return m_cameras.at(camera)->billboards; }
+	/// @brief Cells reached by the wall rays of the last frame, empty unless GameCameraVars::trackVisibleCells is set
+	const VisibleCells& get_visible_cells() const { return m_visibleCells; }
 
 	std::vector<std::unique_ptr<rcm::IEntity>>& get_entities() { return m_entities; }
 	void add_entity(rcm::IEntity *);
@@ -38,21 +130,267 @@ public:
 	bool generate_map_step();
 	bool generate_map();
 
+	/// @brief Change a cell of the map, acceleration structures are updated accordingly
+	/// @param cellX
+	/// @param cellY
+	/// @param cell : map file char ('w', 'b', 'g' or ' ')
+	void set_map_cell(int, int, char);
+
+	/// @brief Change the structure used by rays to skip empty cells (all cameras), it is built the first time it is needed
+	void set_ray_acceleration(rcm::RayAcceleration);
+
+	/// @brief Change the number of wall rays (rendered columns) of the player camera cast from the next frame on, nothing is reallocated
+	/// @param width : in [1, get_max_render_width()]
+	void set_render_width(int);
+	int get_max_render_width() const { return m_cameras.front()->rays.get_capacity(); }
+
+	/// @brief Switch between casting a ray per column and projecting the visible wall sides (all cameras, see GameCameraVars::wallSpans)
+	void set_wall_spans(bool);
+
+	/// @brief Check a batch of segments against the map walls, big batches are split over the thread pool
+	/// @param queries
+	/// @param results : resized to the number of queries, same order
+	void check_lines_of_sight(const std::vector<rcm::SightQuery>&, std::vector<rcm::SightResult>&);
+
 private:
 	rcm::GameCameraVars& m_gameCamera;
 	rcm::GameMap& m_gameMap;
 	rcm::EntityTransform& m_playerTransform;
-	rcm::GameCameraPlane m_cameraVecs{ {1,0}, {0,1} };
 
 	std::chrono::time_point<std::chrono::high_resolution_clock> m_lastTime;
 	int m_processorCount = 1;
 
-	rcm::RayInfoArr m_rayInfoArr;
 	std::unique_ptr<MapGenerator> m_mapGenerator;
 	std::vector<std::unique_ptr<rcm::IEntity>> m_entities;
 
+	RendThreadPool& m_rendThreadPool;
+	RayCastSectionFactory m_rayCastSecFactory;
+	std::vector<RayCastSectionFactory::RayCastSection> m_rayCastSectionsVec;
+	//columns covered by the ray casting sections: the sum of the widths of the cameras cast by the batch
+	int m_rayCastColumns = 0;
+	SightSectionFactory m_sightSecFactory;
+	std::vector<SightSectionFactory::SightSection> m_sightSectionsVec;
+	debug::GameTimer m_rayCastingTimer;
+	int m_rayCastingTime = 0;
+	//rays filled by each ray casting section, summed in m_savedRays at the end of the frame
+	std::vector<int> m_sectionSavedRays;
+	int m_savedRays = 0;
+	int m_reusedRays = 0;
+
+	//camera and map state the rays of a camera were cast with: if nothing changed they are reused
+	struct RayCastState
+	{
+		bool valid = false;
+		math::Vect2 coordinates;
+		float forewardAngle = 0.f, fov = 0.f, maxRenderDist = 0.f;
+		//view angle in whole columns (non linear perspective)
+		int yawStep = 0;
+		bool useCameraPlane = true;
+		unsigned int mapVersion = 0;
+	};
+	//changes every time the map cells do
+	unsigned int m_mapVersion = 0;
+
+	//everything a camera needs to cast its walls, the map and the structures built over it are shared.
+	//The player camera (the first one) uses the vars and the transform the core was created with
+	struct RayCamera
+	{
+		RayCamera(rcm::GameCameraVars&, const rcm::EntityTransform&, std::unique_ptr<rcm::GameCameraVars> ownedVars = nullptr);
+
+		std::unique_ptr<rcm::GameCameraVars> ownedVars;
+		rcm::GameCameraVars& vars;
+		const rcm::EntityTransform& transform;
+		rcm::GameCameraPlane cameraVecs{ {1,0}, {0,1} };
+		rcm::RayInfoArr rays;
+
+		//instruction set used to cast packets of adjacent rays (requested one, if supported by the cpu)
+		utils::SimdLevel raySimdLevel = utils::SimdLevel::Scalar;
+
+		//linear perspective: per column ray directions in view space (x along the view direction, y to its left).
+		//They only depend on fov and width: every frame just rotates them with the view axes
+		std::vector<math::Vect2> planeRayDirs;
+		//non linear perspective: world space unit directions one column apart, covering every view angle in whole columns.
+		//The ray of a column only depends on the view angle step minus the column, so turning shifts the rays of the last frame
+		std::vector<math::Vect2> angleRayDirs;
+		//index of the direction of the first column when the view angle step is 0
+		int angleRayDirsBase = 0;
+		float rayDirsFov = 0.f;
+		int rayDirsWidth = 0;
+		//same tables in 16.16 fixed point, computed with integers only (fixed point rays)
+		std::vector<std::array<int64_t, 2>> fixedPlaneRayDirs;
+		std::vector<std::array<int64_t, 2>> fixedAngleRayDirs;
+
+		//per frame view axes, shared by all ray casting sections
+		math::Vect2 viewForeward;
+		math::Vect2 viewLeft;
+		//per frame index of the direction of the first column in angleRayDirs
+		int firstAngleRayDir = 0;
+		int64_t fixedViewForeward[2]{};
+
+		RayCastState rayCastState;
+		//the rays can leave the resident cells this frame (added cameras on chunked maps): they are walked with checked lookups
+		bool checkedRays = false;
+		//first column of the camera among the ones cast by the batch, -1 if it is not cast by the batch this frame
+		int batchOffset = -1;
+		//wall spans: for each column the first one not covered by a wall side yet (itself if not covered), one more for the screen end
+		std::vector<int> spanNextColumn;
+		//added cameras only
+		std::vector<rcm::Billboard> billboards;
+	};
+	std::vector<std::unique_ptr<RayCamera>> m_cameras;
+	//cameras that project wall spans in the current frame
+	std::vector<RayCamera*> m_spanCameras;
+
+	DistanceField m_distanceField;
+	OccupancyPyramid m_occupancyPyramid;
+	//sized only if cells are tracked, one list of marked cells per ray casting section
+	VisibleCells m_visibleCells;
+
+	//state of a single DDA ray
+	struct DDARay
+	{
+		float lengthIncrementX = 0, lengthIncrementY = 0;
+		//length of the ray at the first intersection with a cell side on the x and y axis
+		float firstLengthX = 0, firstLengthY = 0;
+		//intersections crossed on each axis. Lengths are computed from the count (not accumulated),
+		//so that skipping several cells at once gives the same values of stepping one cell at a time
+		int stepsX = 0, stepsY = 0;
+		int posInMap[2]{};
+		int unitaryStepX = 1, unitaryStepY = 1;
+
+		float length_x(int steps) const { return firstLengthX + float(steps) * lengthIncrementX; }
+		float length_y(int steps) const { return firstLengthY + float(steps) * lengthIncrementY; }
+		//length at the last intersection crossed, the one that reached inside the current cell
+		float last_length(rcm::CellSide lastSideChecked) const { return lastSideChecked == rcm::CellSide::Vert ? length_x(stepsX - 1) : length_y(stepsY - 1); }
+	};
+
+	//how the walk of a wall ray went (column subdivision). The rays between two with the same path
+	//cross the same cell sides in the same order, so their walk can be replaced by its last state
+	struct RayPath
+	{
+		rcm::HitType hitMarker = rcm::HitType::NoHit;
+		rcm::CellSide lastSideChecked = rcm::CellSide::Unknown;
+		int stepsX = 0, stepsY = 0;
+		int unitaryStepX = 1, unitaryStepY = 1;
+		float length = 0;
+		//sum of the y intersections crossed before each x one: the order of the intersections,
+		//it can only be the same for two rays with the same steps if the intersections come in the same order
+		long long order = 0;
+		//smallest difference between two intersections compared by the walk, closer ones could be swapped by rounding
+		float minGap = std::numeric_limits<float>::infinity();
+	};
+
 	void view_walls(bool);
+	/// @brief Set up the view axes and ray directions of a camera for this frame
+	/// @return : false if its walls don't have to be cast (out of the map, or the last rays were reused)
+	bool prepare_camera_walls(RayCamera&, bool);
+	bool reuse_walls(RayCamera&, const RayCastState&);
+	//added cameras never track them
+	bool is_tracking_visible_cells(const RayCamera& camera) const { return camera.vars.trackVisibleCells && m_visibleCells.is_sized(); }
+	/// @brief Cast the columns of the batch in [start, end), over the cameras that cover them
+	void view_walls_batch_section(int, int, bool, int);
+	//the last parameter is the section index, used to mark visible cells
+	void view_walls_section(RayCamera&, int, int, bool, int);
+	//if path is not null the walk is recorded in it (no empty areas are skipped)
+	void view_walls_column(RayCamera&, int, bool, int, RayPath* path = nullptr);
+	/// @brief Cast one column every raySubdivision, the columns in between are filled or split in half until their ends have the same path
+	/// @return : number of rays filled
+	int view_walls_section_subdivided(RayCamera&, int, int, bool, int);
+	int fill_walls_span(RayCamera&, int, const RayPath&, int, const RayPath&, bool, int);
+	bool is_same_path(const RayCamera&, const RayPath&, const RayPath&) const;
+
+	//visible cells and fixed point lengths are only produced by rays, and spans read the resident cells unchecked
+	bool is_using_wall_spans(const RayCamera& camera) const
+	{
+		return camera.vars.wallSpans && !camera.vars.fixedPointRays && !camera.checkedRays && !is_tracking_visible_cells(camera);
+	}
+	/// @brief Fill the rays of the camera by projecting the solid cells it sees, found front to back (single thread)
+	void view_walls_spans(RayCamera&, bool);
+	/// @brief Fill the columns not covered yet whose ray hits the cell, if the cell is solid
+	/// @return : number of columns covered
+	int project_cell(RayCamera&, int, int, bool);
+	/// @brief Screen columns the cell can cover (conservative)
+	/// @return : false if the cell is out of view
+	bool get_cell_columns(const RayCamera&, int, int, bool, int&, int&) const;
+	/// @brief Check if the walk of a ray reaches a cell, with the comparisons of trace_dda_ray()
+	/// @param ray : state at the camera cell
+	/// @param cellDx : cell position from the camera cell
+	/// @param cellDy
+	/// @param maxLength : the walk stops before the first intersection longer than this
+	/// @param side : side the cell is entered from
+	/// @return : false if the walk passes beside the cell or stops before it
+	static bool is_cell_reached(const DDARay&, int, int, float, rcm::CellSide&);
+	/// @brief Move the ray to the state the walk stops at if it hits nothing before maxLength
+	/// @param side : side of the last intersection crossed, Unknown if none
+	static void walk_to_length(DDARay&, float, rcm::CellSide&);
+	static int next_uncovered_column(RayCamera&, int);
+	//same as view_walls_column() with integer lengths
+	void view_walls_column_fixed(RayCamera&, int, bool, int);
+	static void build_ray_directions(RayCamera&);
+	static math::Vect2 get_ray_direction(const RayCamera& camera, int column, bool useCameraPlane)
+	{
+		if (!useCameraPlane)
+			return camera.angleRayDirs[camera.firstAngleRayDir - column];
+
+		const math::Vect2& viewDir = camera.planeRayDirs[column];
+		return camera.viewForeward * viewDir.x + camera.viewLeft * viewDir.y;
+	}
+	/// @brief Non linear perspective view angle, rounded to whole columns (the one rays and billboards are projected with)
+	/// @return : number of columns from angle 0, the angle is taken in [-PI, PI]
+	static int get_yaw_step(const RayCamera&);
+	/// @brief View angle rays and billboards are projected with
+	static float get_view_angle(const RayCamera&, bool);
+	static void update_camera_vecs(RayCamera&);
+	void init_dda_ray(const math::Vect2&, const math::Vect2&, DDARay&) const;
+
+	/// @brief Move the ray one cell at a time (or skip empty areas) until it reaches inside a solid cell
+	/// @param ray : the starting cell must be inside the map
+	/// @param maxLength : the ray stops before the first intersection longer than this
+	/// @param lastSideChecked : side of the last intersection crossed
+	/// @param rayAcceleration : structure used to skip empty cells
+	/// @param visibleCells : if not null every cell reached is marked (no empty areas are skipped)
+	/// @param section : index used to mark cells
+	/// @param path : if not null the order of the intersections is recorded (no empty areas are skipped)
+	/// @return : the solid cell hit, Nothing if maxLength was reached first
+	rcm::HitType trace_dda_ray(DDARay&, float, rcm::CellSide&, rcm::RayAcceleration, VisibleCells*, int, RayPath* path = nullptr) const;
+	/// @brief Same walk of trace_dda_ray() (no skips, no marks) with checked lookups, for rays that leave the resident cells
+	rcm::HitType trace_dda_ray_checked(DDARay&, float, rcm::CellSide&) const;
+	static void store_dda_ray(RayCamera&, int, const math::Vect2&, const DDARay&, rcm::HitType, rcm::CellSide);
+	static void store_ray(RayCamera&, int column, const math::Vect2& hitPos, float rayLength, rcm::HitType, rcm::CellSide);
+
+	/// @brief Move the ray forward, up to the last intersection before it leaves an area of known empty cells
+	/// @param ray : the current cell must be empty
+	/// @param maxStepsX : how many cells can be crossed in the ray x direction
+	/// @param maxStepsY : how many cells can be crossed in the ray y direction
+	/// @param maxLength : the ray is not moved past intersections longer than this
+	void jump_dda_ray(DDARay&, int, int, float) const;
+
+#ifdef RCM_X86_SIMD
+	/// @brief Cast the rays of 4 (sse2) or 8 (avx2) adjacent columns together, the output is the same of view_walls_column()
+	/// @param firstColumn : the first column of the packet
+	/// @param useCameraPlane
+	void view_walls_packet_sse2(RayCamera&, int, bool);
+	RCM_TARGET_AVX2 void view_walls_packet_avx2(RayCamera&, int, bool);
+#endif
 	void view_billboards(bool);
+	/// @brief Place a billboard on the screen of a camera
+	/// @return : true if the entity is within the camera render distance
+	static bool project_billboard(const RayCamera&, const rcm::EntityTransform&, bool, rcm::Billboard&);
+	/// @brief Check the visible cells in a square around a position
+	bool is_near_visible_cell(const math::Vect2&, int) const;
+
+	void check_lines_of_sight_section(int, int, const std::vector<rcm::SightQuery>&, std::vector<rcm::SightResult>&) const;
+	rcm::SightResult check_line_of_sight(const rcm::SightQuery&) const;
+
+	void load_map_grid();
+	/// @brief Keep the cells around the camera resident (chunked maps), the structures over them are built again when they move
+	void update_map_window();
+	/// @brief Cells reached by wall rays (and checked by wall spans) are within this distance from the camera cell
+	int get_map_window_radius(const rcm::GameCameraVars&) const;
+	void build_ray_acceleration();
+
+	friend class RayCastSectionFactory;
+	friend class SightSectionFactory;
 
 	bool check_out_of_map_bounds(const math::Vect2 &) const;
 	bool check_out_of_map_bounds(int, int) const;
@@ -2,9 +2,14 @@
 #define GAMEDATASTRUCTURES_HPP
 
 #include "utils.hpp"
+#include "mapGrid.hpp"
 #include <memory>
+#include <cstddef>
 
+//can be set at build time (e.g. -DWINDOW_HEIGHT=1440), the width follows a 16:9 ratio
+#ifndef WINDOW_HEIGHT
 #define WINDOW_HEIGHT 720
+#endif
 
 namespace windowVars
 {
@@ -31,6 +36,8 @@ namespace rcm
 		bool hadFocus = false;
 		bool isPaused = false;
 		bool isFindPathRequested = false;
+		bool isRayAccelerationSwitchRequested = false;
+		bool isWallRendererSwitchRequested = false;
 		bool isTabbed = false;
 		bool isLinearPersp = true;
 		bool drawSky = false;
@@ -43,6 +50,14 @@ namespace rcm
 		float forewardAngle = 0.f;
 	};
 
+	//structure used to skip empty cells while casting wall rays
+	enum class RayAcceleration
+	{
+		None,
+		DistanceField,
+		Pyramid
+	};
+
 	struct GameCameraVars
 	{
 		int pixelWidth = 0;
@@ -50,6 +65,26 @@ namespace rcm
 		float fov = 90.f;
 		float maxRenderDist = 10.f;
 		float rayPrecision = 0.1f;
+		//if true wall rays are cast by the rendering thread pool, otherwise by the main thread only
+		bool parallelRayCasting = true;
+		//widest instruction set used to cast packets of rays, lowered to what the cpu supports
+		utils::SimdLevel raySimdLevel = utils::SimdLevel::AVX2;
+		//rays that use an acceleration structure are cast one by one (no packets)
+		RayAcceleration rayAcceleration = RayAcceleration::None;
+		//record the map cells reached by wall rays every frame, rays are then cast one by one without skipping cells
+		bool trackVisibleCells = false;
+		//walk wall rays with 16.16 fixed point lengths: same results on every compiler and instruction set (one by one, no skipping)
+		bool fixedPointRays = false;
+		//cast one column every raySubdivision and fill the ones in between when both ends crossed the same cells (1 casts every column).
+		//Same results of casting every column, bit by bit, rays are cast one by one without skipping cells
+		int raySubdivision = 1;
+		//find the wall sides seen by the camera and project each one on the columns it covers, instead of walking a ray per column.
+		//Single thread, not used with visible cells or fixed point rays
+		bool wallSpans = false;
+		//frame time (ms) the render width is adjusted to, 0 keeps pixelWidth equal to the window width
+		float frameTimeTarget = 0.f;
+		//lowest render width allowed, as a fraction of the window width
+		float minRenderScale = 1.f;
 	};
 
 	struct GameCameraPlane
@@ -77,6 +112,22 @@ namespace rcm
 		int minimapScale = 6;
 		float halfWallHeight = 0.5f;
 		float maxSightDepth = 10.f;
+		//widest instruction set used to draw floor and ceiling, lowered to what the cpu supports
+		utils::SimdLevel backgroundSimdLevel = utils::SimdLevel::AVX2;
+		//sample smaller copies of wall, floor and ceiling textures where a pixel steps over several texels (far walls and floor rows)
+		bool mipmaps = false;
+		//views at least this tall draw their walls in columns, then copy them to the view rows (see tests/wallColumnsBenchmark.cpp).
+		//Stretched rays always are
+		int columnMajorWallsMinHeight = 1440;
+	};
+
+	//rectangle of the window a camera view is drawn in, as fractions of the window size
+	struct ViewportRect
+	{
+		float left = 0.f;
+		float top = 0.f;
+		float width = 1.f;
+		float height = 1.f;
 	};
 
 	struct GameMap
@@ -84,6 +135,10 @@ namespace rcm
 		int width = 0, height = 0;
 		bool generated = false;
 		std::unique_ptr<std::string> cells;
+		//maps too big to be kept in memory are read from a chunk file instead of cells (which is then empty)
+		std::shared_ptr<MapChunkFile> chunks;
+		//compact copy of cells (or of the chunks around the camera) used for lookups, built by the core once the map is complete
+		MapGrid grid;
 	};
 
 	enum class HitType : char
@@ -96,7 +151,7 @@ namespace rcm
 		NoHit = '\0'
 	};
 
-	enum class CellSide
+	enum class CellSide : char
 	{
 		Vert,
 		Hori,
@@ -109,21 +164,79 @@ namespace rcm
 		math::Vect2 hitPos = { 0, 0 };
 		float length = 0;
 		CellSide lastSideChecked = CellSide::Unknown;
+		//position of the hit along the wall side, in [0, 1) (not mirrored by the side the wall is seen from)
+		float textureU = 0;
 	};
 
+	/// @brief Results of the wall rays, one per rendered column. Each field is kept in its own array,
+	/// renderers only read the fields they need (the lengths for sprites, the hit positions for the minimap).
+	/// Arrays are allocated once for the widest render, the number of rays in use can then change every frame.
 	class RayInfoArr
 	{
 	public:
-		RayInfoArr(int size) : arrSize(size) { m_rayArr = new RayInfo[size]{}; }
-		~RayInfoArr() { delete[] m_rayArr; }
-		RayInfo& at(int);
-		const RayInfo& const_at(int) const;
+		//arrays alignment, enough for avx loads
+		static constexpr std::size_t alignment = 32;
+
+		RayInfoArr(int capacity);
+		~RayInfoArr();
 		RayInfoArr& operator=(const RayInfoArr&) = delete;
 		RayInfoArr(const RayInfoArr&) = delete;
 
-		const int arrSize;
+		int get_size() const noexcept { return m_size; }
+		int get_capacity() const noexcept { return m_capacity; }
+		//no reallocation, the size must be in [1, capacity]
+		void resize(int);
+
+		//checked access
+		RayInfo const_at(int) const;
+		void set(int, const RayInfo&);
+
+		//unchecked access for the hot paths, the index must be in [0, size)
+		HitType hit_type(int i) const noexcept { return m_hitTypes[i]; }
+		const math::Vect2& hit_pos(int i) const noexcept { return m_hitPositions[i]; }
+		float length(int i) const noexcept { return m_lengths[i]; }
+		CellSide side(int i) const noexcept { return m_sides[i]; }
+		float texture_u(int i) const noexcept { return m_textureUs[i]; }
+		const float* lengths() const noexcept { return m_lengths; }
+
+		void store(int i, HitType hitType, const math::Vect2& hitPos, float length, CellSide side, float textureU) noexcept
+		{
+			m_hitTypes[i] = hitType;
+			m_hitPositions[i] = hitPos;
+			m_lengths[i] = length;
+			m_sides[i] = side;
+			m_textureUs[i] = textureU;
+		}
+		void copy(int to, int from) noexcept
+		{
+			store(to, m_hitTypes[from], m_hitPositions[from], m_lengths[from], m_sides[from], m_textureUs[from]);
+		}
+
 	private:
-		RayInfo* m_rayArr;
+		const int m_capacity;
+		int m_size;
+		HitType* m_hitTypes;
+		math::Vect2* m_hitPositions;
+		float* m_lengths;
+		CellSide* m_sides;
+		float* m_textureUs;
+	};
+
+	//segment checked by a line of sight query, e.g. from an enemy to the player
+	struct SightQuery
+	{
+		math::Vect2 from;
+		math::Vect2 to;
+	};
+
+	struct SightResult
+	{
+		//no solid cell between from and to
+		bool visible = false;
+		//what stopped the line, Nothing if visible
+		HitType hitType = HitType::NoHit;
+		//distance from the start to the first solid cell, the whole segment length if visible
+		float hitDistance = 0;
 	};
 
 	//--------------------- entity related structures --------------------------
@@ -29,10 +29,15 @@ struct GameView
     GameView& operator=(const GameView&) = delete;
 
     void create(int, int, bool);
+    //uploads the pixels and draws them opaque. The texture is created on the first draw: views can be rendered without a window
+    void draw(sf::RenderTarget&);
     
     sf::Texture m_texture;
     sf::Sprite m_sprite;
     sf::Uint8* m_pixels = nullptr;
+    //pixels, a row is m_width pixels
+    int m_width = 0;
+    int m_height = 0;
 private:
     bool m_hasPixelArray = false;
 };
@@ -42,13 +47,34 @@ struct Texture
 public:
     Texture() = default;
     Texture(const std::string& filePath) { create(filePath); }
-    void create(const std::string&);
+    /// @param columnMajor : also keep a copy of the pixels stored column by column (for textures sampled along columns, as walls)
+    /// @param mipmaps : also build the levels of halved size (mip chain), down to one pixel wide or high
+    void create(const std::string&, bool columnMajor = false, bool mipmaps = false);
     const sf::Uint8& get_pixel_at(int) const;
     int width() const { return m_image.getSize().x; }
     int height() const { return m_image.getSize().y; }
+    //some pixels have zero alpha (not drawn on walls in linear perspective)
+    bool has_clear_pixels() const { return m_hasClearPixels; }
+    //rows can be wrapped with height() - 1 as a mask
+    bool has_power_of_two_height() const { return m_powerOfTwoHeight; }
+    bool has_column_major_copy() const { return !m_columnPixels.empty(); }
+    //pixels of column u, top to bottom (only if created with a column major copy)
+    const sf::Uint8* get_column(int u) const { return m_columnPixels.data() + u * height() * 4; }
+    //level 0 is this texture, levels past the last one give the last one
+    const Texture& get_mip(int level) const;
+    //level with about one texel per pixel, from the texels a pixel steps over at full size
+    int get_mip_for_step(float texelStep) const;
     const sf::Uint8* m_texturePixels = nullptr;
 private:
+    void init_pixels(bool columnMajor);
+    void create_mips(bool columnMajor);
+
     sf::Image m_image;
+    std::vector<sf::Uint8> m_columnPixels;
+    //levels from 1, each half the size of the previous one
+    std::vector<std::unique_ptr<Texture>> m_mips;
+    bool m_hasClearPixels = false;
+    bool m_powerOfTwoHeight = false;
     int m_width = 0;
     int m_height = 0;
 };
@@ -71,10 +97,32 @@ struct BackgroundVars
     float skyPixPerCircle = 0.f;
     float skyUIncrement = 0.f;
     float skyVIncrement = 0.f;
+    //widest instruction set used for floor and ceiling pixels
+    utils::SimdLevel simdLevel = utils::SimdLevel::Scalar;
+    bool mipmaps = false;
+};
+
+//background pixels of one view row: floor or ceiling, where the world position seen by a column is start + increment * column, or sky
+struct BackgroundRow
+{
+    math::Vect2 start{};
+    math::Vect2 increment{};
+    sf::Uint8 shading = 0;
+    //first pixel of the row in the view, nullptr if the row has no background (middle row of an odd height)
+    sf::Uint8* pixels = nullptr;
+    //floor or ceiling texture, nullptr if the row shows the sky
+    const Texture* texture = nullptr;
+    //row of the sky texture, if shown
+    const sf::Uint8* skyTexels = nullptr;
 };
 
+//a sprite of the frame, drawn on view columns [screenUStart, screenUEnd) (not clipped to the view)
 struct SpriteRendVars
 {
+    const rcm::Billboard* billboard = nullptr;
+    const Texture* texture = nullptr;
+    int screenUStart = 0;
+    int screenUEnd = 0;
     float screenSpriteHeight = 0.f;
     float floorHeight = 0.f;
     float screenSpriteWidth = 0;
@@ -85,61 +133,115 @@ struct SpriteRendVars
     int screenVEnd = 0;
 };
 
-//------main-view----
-class ViewRendSectionFactory : public IRenderingSectionFactory
+//distance of the floor (and ceiling) seen by each row of the upper half of a view, rows [0, height / 2],
+//and its shading. They only depend on the row and on the graphics vars, tables are rebuilt when those change
+struct FloorRowTables
 {
-public:
-    class ViewRendSection : public IRenderingSection
-    {
-    public:
-        ViewRendSection(int, int, ViewRendSectionFactory*);
-        void operator()() const override;
-    protected:
-        ViewRendSectionFactory* m_source = nullptr;
-    };
+    void update(const rcm::GraphicsVars&, int viewHeight);
 
-    ViewRendSectionFactory(int taskNumber, int workers) : 
-        IRenderingSectionFactory(taskNumber, workers) {}
+    std::vector<float> distance;
+    std::vector<sf::Uint8> shading;
+private:
+    float m_halfWallHeight = 0.f;
+    float m_maxSightDepth = 0.f;
+    int m_viewHeight = 0;
+};
 
-    ViewRendSection create_section(int index);
-    void set_target(const rcm::RayInfoArr* rays, GameView* view, const StaticTextures* tex, const rcm::GameStateVars* state, const rcm::GraphicsVars* graphVars, const rcm::EntityTransform* camTransform);
+//wall pass output: rows covered by the wall of each ray. On tall views, or when rays are stretched, their pixels are also stored
+//in a contiguous column (column major), groups of columns are then copied to the rows of the view while they are still in cache
+struct WallColumns
+{
+    void create(int columns, int height);
+    sf::Uint8* column(int ray) { return pixels.data() + ray * columnSize; }
+
+    //rows of the view
+    int height = 0;
+    int columnSize = 0;
+    std::vector<sf::Uint8> pixels;
+    //rows [start, end) written in each column
+    std::vector<int> start, end;
+    //columns with rows left to the background (clear texels in linear perspective), only the rows set in mask are copied
+    std::vector<sf::Uint8> masked;
+    std::vector<sf::Uint8> mask;
+};
+
+//----background----
+
+//floor, ceiling and sky of a view. They are drawn by the view sections, only around the walls of their columns
+//(see GameGraphics::draw_background_columns()), from rows that only depend on the camera and are set up once per frame
+class BackgroundRows
+{
+public:
+    void set_target(GameView*, const StaticTextures*, const rcm::GameStateVars*, const rcm::GraphicsVars*, rcm::GameCameraView*);
+    //to be called before the sections of a frame run (not thread safe)
+    void update();
+    const FloorRowTables& get_row_tables() const { return m_rowTables; }
+    const BackgroundVars& get_vars() const { return m_backgroundVars; }
+    const BackgroundRow& get_row(int viewRow) const { return m_rows[viewRow]; }
+    //column of the sky texture seen by each view column
+    const int* get_sky_columns() const { return m_skyColumns.data(); }
+    int get_view_width() const { return m_view->m_width; }
 
 protected:
-    const rcm::RayInfoArr* m_rays = nullptr;
     GameView* m_view = nullptr;
     const StaticTextures* m_staticTex = nullptr;
+    rcm::GameCameraView* m_camera = nullptr;
     const rcm::GameStateVars* m_state = nullptr;
     const rcm::GraphicsVars* m_graphVars = nullptr;
-    const rcm::EntityTransform* m_camTransform = nullptr;
+    BackgroundVars m_backgroundVars{};
+    FloorRowTables m_rowTables;
+    std::vector<BackgroundRow> m_rows;
+    std::vector<int> m_skyColumns;
 };
 
-//----background----
+//view pixels covered by the sprites drawn so far in a batch (sprites are drawn front to back). A pixel is covered
+//if its stamp is the one of the batch, so stamps are only cleared when they wrap around
+struct SpriteCoverage
+{
+    void create(int width, int height);
+    //to be called before each batch (not thread safe)
+    void next_batch();
+    sf::Uint8* column(int x) { return stamps.data() + x * columnSize; }
+
+    int columnSize = 0;
+    //column major
+    std::vector<sf::Uint8> stamps;
+    sf::Uint8 stamp = 0;
+    //rows [coveredStart, coveredEnd) of each column are all covered
+    std::vector<int> coveredStart, coveredEnd;
+};
 
-class BackgroundRendSectionFactory : public IRenderingSectionFactory
+//------main-view----
+class ViewRendSectionFactory : public IRenderingSectionFactory
 {
 public:
-    class BackgroundRendSection : public IRenderingSection
+    class ViewRendSection : public IRenderingSection
     {
     public:
-        BackgroundRendSection(int, int, BackgroundRendSectionFactory*);
+        ViewRendSection() : IRenderingSection() {}
+        ViewRendSection(int, int, ViewRendSectionFactory*);
         void operator()() const override;
     protected:
-        BackgroundRendSectionFactory* m_source = nullptr;
+        ViewRendSectionFactory* m_source = nullptr;
     };
 
-    BackgroundRendSectionFactory(int taskNumber, int workers) :
+    ViewRendSectionFactory(int taskNumber, int workers) : 
         IRenderingSectionFactory(taskNumber, workers) {}
 
-    BackgroundRendSection create_section(int index);
-    void set_target(GameView*, const StaticTextures*, const rcm::GameStateVars*, const rcm::GraphicsVars*, rcm::GameCameraView*);
-    
+    ViewRendSection create_section(int index);
+    void set_target(const rcm::RayInfoArr* rays, GameView* view, const StaticTextures* tex, const rcm::GameStateVars* state, const rcm::GraphicsVars* graphVars, const rcm::EntityTransform* camTransform, const BackgroundRows* background);
+    //sections are split over the rays (render width), not over the view columns
+    int get_columns() const { return m_rays->get_size(); }
+
 protected:
+    const rcm::RayInfoArr* m_rays = nullptr;
     GameView* m_view = nullptr;
     const StaticTextures* m_staticTex = nullptr;
-    rcm::GameCameraView* m_camera = nullptr;
     const rcm::GameStateVars* m_state = nullptr;
     const rcm::GraphicsVars* m_graphVars = nullptr;
-    BackgroundVars m_backgroundVars{};
+    const rcm::EntityTransform* m_camTransform = nullptr;
+    const BackgroundRows* m_background = nullptr;
+    WallColumns m_columns;
 };
 
 struct MapSquareAsset
@@ -169,17 +271,48 @@ public:
     SpriteRendSectionFactory(int taskNumber, int workers) :
         IRenderingSectionFactory(taskNumber, workers) {}
 
+    //sections are strips of view columns, each one draws every sprite that overlaps it
     SpriteRendSection create_section(int index);
+    //sprites are then drawn on this view, depth tested against its rays
     void set_environment(GameView*, const rcm::GraphicsVars*, const rcm::RayInfoArr*);
-    void set_target(const rcm::Billboard&, const Texture&);
+    //sprites of the next batch, to be added front to back
+    void clear_sprites() { m_sprites.clear(); m_coverage.next_batch(); }
+    void add_sprite(const rcm::Billboard&, const Texture&);
+    bool has_sprites() const { return !m_sprites.empty(); }
 
 protected:
-    const rcm::Billboard* m_billboard = nullptr;
     GameView* m_view = nullptr;
     const rcm::GraphicsVars* m_graphVars = nullptr;
     const rcm::RayInfoArr* m_rays = nullptr;
-    const Texture* m_tex = nullptr;
-    SpriteRendVars m_sVars{};
+    std::vector<SpriteRendVars> m_sprites;
+    SpriteCoverage m_coverage;
+};
+
+//-----added-cameras----
+
+//a camera added to the core: rendered in its own buffer by its own sections, then drawn scaled in a rectangle of the window.
+//The buffer has a column per ray of the camera and the rows of the rectangle
+struct CameraViewRender
+{
+    CameraViewRender(const rcm::GameCameraView&, const rcm::RayInfoArr&, const std::vector<rcm::Billboard>&, const rcm::ViewportRect&, int workers);
+    CameraViewRender(const CameraViewRender&) = delete;
+    CameraViewRender& operator=(const CameraViewRender&) = delete;
+
+    void update_view_sections();
+
+    GameView view;
+    rcm::GameCameraView camera;
+    const rcm::RayInfoArr& rays;
+    const std::vector<rcm::Billboard>& billboards;
+
+    ViewRendSectionFactory viewSecFactory;
+    std::vector<ViewRendSectionFactory::ViewRendSection> viewSectionsVec;
+    int viewColumns = 0;
+    BackgroundRows background;
+
+    //sprites are drawn in the same batch of the main view ones
+    SpriteRendSectionFactory spriteSecFactory;
+    std::vector<SpriteRendSectionFactory::SpriteRendSection> spriteSectionsVec;
 };
 
 //-----------------------------------------------------------------------
@@ -187,7 +320,7 @@ protected:
 class GameGraphics
 {
 public:
-    GameGraphics(sf::RenderWindow& window, const rcm::GraphicsVars& graphicsVars);
+    GameGraphics(sf::RenderWindow& window, const rcm::GraphicsVars& graphicsVars, RendThreadPool& rendThreadPool);
     GameGraphics() = delete;
     GameGraphics& operator=(const GameGraphics&) = delete;
 
@@ -203,12 +336,32 @@ public:
     void set_text_ui(const std::string&, const rcm::TextVerticalAlignment, const rcm::TextHorizontalAlignment, const int, const int, const int);
     void draw_text_ui();
     void draw_path_out();
-    void draw_view(bool, const std::vector<std::unique_ptr<rcm::IEntity>>&);
+    void draw_view(const std::vector<std::unique_ptr<rcm::IEntity>>&);
+    /// @brief Render the walls, background and sprites of every view in their pixel buffers, without drawing them on the window
+    void render_views(const std::vector<std::unique_ptr<rcm::IEntity>>&);
+    /// @param index : 0 is the main view, then the same index of the camera in the core
+    const GameView& get_view(int index) const;
+    /// @brief Draw a camera added to the core over the main view, its walls are rendered in the same batches of the main ones.
+    /// Only available after create_assets()
+    /// @param camera : transform, vars and vecs of the core camera, they must stay valid until the view is removed
+    /// @param billboards : the ones the core places for this camera
+    /// @param viewport : rectangle of the window the view is drawn in
+    void add_camera_view(const rcm::GameCameraView& camera, const rcm::RayInfoArr& rays, const std::vector<rcm::Billboard>& billboards, const rcm::ViewportRect& viewport);
+    /// @param index : same index of the camera in the core (1 is the first added one)
+    void remove_camera_view(int index);
     void calculate_shortest_path(const rcm::EntityTransform&);
 
-    void static draw_view_section(int startY, int endY, bool linear, const rcm::RayInfoArr&, GameView&, const rcm::GraphicsVars&, const StaticTextures&, const rcm::EntityTransform&);
-    void static draw_background_section(int startX, int endX, bool drawSky, GameView&, const BackgroundVars&, const rcm::GraphicsVars&, rcm::GameCameraView&, const StaticTextures&);
-    void static draw_sprite_section(int startU, int endU, GameView&, const SpriteRendVars&, const rcm::Billboard&, const Texture&, const rcm::GraphicsVars&, const rcm::RayInfoArr&);
+    void static draw_view_section(int startY, int endY, bool linear, const rcm::RayInfoArr&, GameView&, WallColumns&, const rcm::GraphicsVars&, const BackgroundRows&, const StaticTextures&, const rcm::EntityTransform&);
+    //pixels : first row of the ray (its column or the view), pixelStride : bytes from one row to the next
+    void static draw_wall_column(int ray, bool linear, const rcm::RayInfoArr&, sf::Uint8* pixels, int pixelStride, WallColumns&, const rcm::GraphicsVars&, const FloorRowTables&, const StaticTextures&, const rcm::EntityTransform&);
+    void static copy_wall_columns(int startRay, int endRay, const rcm::RayInfoArr&, GameView&, const WallColumns&);
+    void static draw_background_columns(int startRay, int endRay, const rcm::RayInfoArr&, const WallColumns&, const BackgroundRows&);
+    void static draw_background_span(const BackgroundRow&, int startX, int endX, const BackgroundVars&, const int* skyColumns);
+    void static draw_background_pixel(const BackgroundRow&, int x);
+    //4 and 8 adjacent pixels, only available on x86 (see backgroundPackets.cpp)
+    void static draw_background_pixels_sse2(const BackgroundRow&, int firstX);
+    void static draw_background_pixels_avx2(const BackgroundRow&, int firstX);
+    void static draw_sprite_section(int startX, int endX, GameView&, const std::vector<SpriteRendVars>&, const rcm::RayInfoArr&, SpriteCoverage&);
 
 private:
     sf::RenderWindow& m_window;
@@ -229,24 +382,33 @@ private:
     inline void load_text_ui(const std::string&);
     inline void load_textures(const rcm::GameAssets&);
 
-    RendThreadPool m_rendThreadPool;
+    RendThreadPool& m_rendThreadPool;
 
     ViewRendSectionFactory m_viewSecFactory;
     std::vector<ViewRendSectionFactory::ViewRendSection> m_viewSectionsVec;
+    int m_viewColumns = 0;
     void create_view_sections();
+    void update_view_sections();
 
-    BackgroundRendSectionFactory m_backgroundSecFactory;
-    std::vector<BackgroundRendSectionFactory::BackgroundRendSection> m_backgroundSectionsVec;
-    void create_background_sections();
+    BackgroundRows m_background;
 
     SpriteRendSectionFactory m_spriteSecFactory;
     std::vector<SpriteRendSectionFactory::SpriteRendSection> m_spriteSectionsVec;
     void create_sprite_sections();
-    void update_sprite_sections();
 
-    void render_view(bool);
+    //cameras added to the core, in the same order
+    std::vector<std::unique_ptr<CameraViewRender>> m_cameraViews;
+    const rcm::RayInfoArr* m_mainRays = nullptr;
+    const rcm::GameStateVars* m_gameState = nullptr;
+    const rcm::GraphicsVars* m_graphicsVars = nullptr;
+    void draw_camera_views();
+
+    void render_view();
     void render_sprites(const std::vector<std::unique_ptr<rcm::IEntity>>&);
+    //sorts the billboards and sets them as the sprites of the next batch of a view
+    void queue_billboards(std::vector<const rcm::Billboard*>&, SpriteRendSectionFactory&);
     void render_sprite();
+    std::vector<const rcm::Billboard*> m_billboardsToDraw;
 };
 
 inline void copy_pixels( sf::Uint8 *, const sf::Uint8 *, int, int, sf::Uint8 );
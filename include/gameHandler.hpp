@@ -4,6 +4,7 @@
 #include <string>
 #include <vector>
 #include "gameDataStructures.hpp"
+#include "visibleCells.hpp"
 
 namespace rcm
 {
@@ -68,6 +69,35 @@ namespace rcm
 		/// @brief Get a reference to the current map.
 		/// @return a reference to the current map
 		virtual inline const GameMap& get_active_map() = 0;
+
+		/// @brief Change a cell of the current map (e.g. open or close a passage). Only available once the map is complete (after generation).
+		/// @param cellX 
+		/// @param cellY 
+		/// @param cell : the new char value ('w' wall, 'b' boundary, 'g' goal, ' ' empty)
+		virtual void set_map_cell(const int cellX, const int cellY, const char cell) = 0;
+
+		/// @brief Check which segments are free of walls (e.g. whether an enemy can see the player). 
+		/// Queries from all scripts should be gathered in a single call: big batches are split over the rendering threads.
+		/// @param queries : segments from a position inside the map to a target
+		/// @param results : resized to the number of queries, in the same order
+		virtual void check_lines_of_sight(const std::vector<SightQuery>& queries, std::vector<SightResult>& results) = 0;
+
+		/// @brief Map cells reached by the camera rays during the last frame (e.g. to skip the logics of entities nobody can see).
+		/// Only filled if the gameCamera "visibleCells" option is set in the config file.
+		/// @return a read only reference, valid for the whole game
+		virtual const VisibleCells& get_visible_cells() = 0;
+
+		/// @brief Add a camera (e.g. a rear view or a security camera) drawn over the main view, in a rectangle of the window.
+		/// Its walls are cast and drawn in the same batches of the player ones, with the gameCamera options of the config file. Only available after create_assets().
+		/// @param transform : where the camera looks from (e.g. the one of an entity), it must stay valid until the camera is removed
+		/// @param fov : field of view in degrees
+		/// @param renderWidth : number of wall rays, in [1, window width], stretched to the viewport
+		/// @param viewport : rectangle of the window the view is drawn in, as fractions of the window size
+		/// @return : index of the camera, the first added one is 1 (the player camera is 0)
+		virtual int add_camera(const EntityTransform& transform, float fov, int renderWidth, const ViewportRect& viewport) = 0;
+
+		/// @brief Remove an added camera, the ones added after it move back by one index
+		virtual void remove_camera(int index) = 0;
 	protected:
 		std::string m_configFilePath;
 	};
@@ -0,0 +1,46 @@
+#ifndef DISTANCEFIELD_HPP
+#define DISTANCEFIELD_HPP
+
+#include "mapGrid.hpp"
+#include <vector>
+
+/// @brief Chebyshev distance of every resident MapGrid cell (border included) from the nearest solid cell.
+/// A cell at distance d has only empty cells within d - 1 steps on both axis, rays can cross them without checks.
+/// When the resident cells move, only the distances near the cells that changed are computed again.
+class DistanceField
+{
+public:
+	//distances are capped, so that a changed cell only affects a limited area around it
+	static constexpr int maxDistance = 32;
+
+	DistanceField() = default;
+
+	void build(const MapGrid&);
+
+	/// @brief Update the distances after a single cell of the grid has changed (nothing to do if it is not resident)
+	/// @param grid : the grid the field was built from, already changed
+	void update(const MapGrid& grid, int x, int y);
+
+	/// @brief Follow the resident cells after they moved: distances of the cells still resident are kept,
+	/// except for the ones within maxDistance of the new cells and of the window border
+	/// @param grid : the grid the field was built from, after its window moved
+	void update_window(const MapGrid& grid);
+
+	bool is_built() const { return !m_distances.empty(); }
+
+	/// @brief Same indexing of the grid the field was built from
+	unsigned char at_unchecked(int x, int y) const { return m_distances[(x - m_originX + 1) + (y - m_originY + 1) * m_stride]; }
+
+private:
+	//first resident cell, the field covers the resident cells and their border
+	int m_originX = 0, m_originY = 0;
+	int m_width = 0, m_height = 0, m_stride = 0;
+	std::vector<unsigned char> m_distances;
+	//distances before the window moved, kept to reuse its memory
+	std::vector<unsigned char> m_lastDistances;
+
+	void reset_area(const MapGrid&, int, int, int, int);
+	void propagate_area(int, int, int, int);
+};
+
+#endif
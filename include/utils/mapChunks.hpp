@@ -0,0 +1,76 @@
+#ifndef MAPCHUNKS_HPP
+#define MAPCHUNKS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+/// @brief Map cells stored in square chunks in a binary file that is mapped in memory: only the pages of the chunks
+/// that are read are loaded, so opening is immediate and memory follows the area in use, not the map size.
+/// File layout: Header, then the chunks row by row, each one chunkSide * chunkSide MapGrid cells (row major).
+/// Edge chunks are padded with empty cells. Values are in the byte order of the machine that wrote the file.
+class MapChunkFile
+{
+public:
+	struct Header
+	{
+		char magic[4];
+		uint32_t version;
+		uint32_t width, height;
+		uint32_t chunkSide;
+	};
+
+	static constexpr char magic[4] = { 'R', 'C', 'M', 'C' };
+	static constexpr uint32_t version = 1;
+	//chunks are a whole number of the coarsest occupancy pyramid blocks
+	static constexpr int minChunkSide = 16;
+	static constexpr int defaultChunkSide = 64;
+
+	/// @brief Map a chunk file, changes to its cells are kept in memory and never written back
+	explicit MapChunkFile(const std::string& path);
+	~MapChunkFile();
+
+	MapChunkFile(const MapChunkFile&) = delete;
+	MapChunkFile& operator=(const MapChunkFile&) = delete;
+
+	/// @brief Write a chunk file one chunk at a time, without keeping the map in memory
+	/// @param cellAt : map file char of the cell at (x, y) ('w' wall, 'b' boundary, 'g' goal, anything else is empty)
+	/// @param chunkSide : power of two, at least minChunkSide
+	static void write(const std::string& path, int width, int height, const std::function<char(int, int)>& cellAt, int chunkSide = defaultChunkSide);
+
+	int get_width() const { return m_width; }
+	int get_height() const { return m_height; }
+	int get_chunk_side() const { return 1 << m_chunkShift; }
+
+	/// @brief x and y must be inside the map
+	unsigned char at(int x, int y) const { return m_cells[offset(x, y)]; }
+	/// @brief Change a cell in memory only, x and y must be inside the map
+	void set(int x, int y, unsigned char cell) { m_cells[offset(x, y)] = cell; }
+
+	/// @brief Copy a row of cells that doesn't leave the map, chunk by chunk
+	void copy_row(int x, int y, int length, unsigned char* destination) const;
+
+private:
+	int m_width = 0, m_height = 0;
+	int m_chunkShift = 0;
+	int m_chunksPerRow = 0;
+	unsigned char* m_cells = nullptr;
+	void* m_mapping = nullptr;
+	size_t m_mappingSize = 0;
+#ifdef _WIN32
+	void* m_fileHandle = nullptr;
+	void* m_mappingHandle = nullptr;
+#endif
+
+	size_t offset(int x, int y) const
+	{
+		int chunkMask = (1 << m_chunkShift) - 1;
+		size_t chunk = size_t(x >> m_chunkShift) + size_t(y >> m_chunkShift) * m_chunksPerRow;
+		return (chunk << (2 * m_chunkShift)) + (size_t(y & chunkMask) << m_chunkShift) + (x & chunkMask);
+	}
+
+	void unmap();
+};
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef MAPGRID_HPP
+#define MAPGRID_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+
+class MapChunkFile;
+
+/// @brief One byte per map cell, surrounded by a border of out-of-bounds cells.
+/// Rays and searches that start inside the map can walk without bounds checks: they always stop at the border.
+/// Maps stored in a chunk file only keep a window of whole chunks in memory (the resident cells), moved around the camera:
+/// unchecked and raw accesses are limited to it and its border, at() reads any cell.
+class MapGrid
+{
+public:
+	//the solid bit marks cells that stop rays and movement, the other 7 bits hold the map file char
+	static constexpr unsigned char solidBit = 0x80;
+
+	enum Cell : unsigned char
+	{
+		Empty = ' ',
+		Goal = 'g',
+		Wall = solidBit | 'w',
+		Boundary = solidBit | 'b',
+		Oob = solidBit | 'o'
+	};
+
+	MapGrid() = default;
+
+	/// @brief Convert a char map ('w' wall, 'b' boundary, 'g' goal, anything else is empty)
+	/// @param cells : row major, missing cells are considered empty and exceeding ones are ignored
+	void load(int width, int height, const std::string& cells);
+
+	/// @brief Use a chunk file, the resident cells are the chunks within radius cells from (x, y)
+	void load(std::shared_ptr<MapChunkFile> chunks, int x, int y, int radius);
+
+	/// @brief Move the resident cells if some of the ones within radius cells from (x, y) are not resident
+	/// @return : true if they moved, indices and unchecked accesses are then relative to the new ones
+	bool update_window(int x, int y, int radius);
+
+	/// @brief Change a single cell of the map, same conversion of load()
+	void set_cell(int x, int y, char cell);
+
+	int get_width() const { return m_width; }
+	int get_height() const { return m_height; }
+	bool is_loaded() const { return !m_cells.empty(); }
+
+	bool is_inside(int x, int y) const { return (x >= 0 && y >= 0 && x < m_width && y < m_height); }
+
+	//resident cells, the whole map unless it comes from a chunk file
+	int get_window_x() const { return m_windowX; }
+	int get_window_y() const { return m_windowY; }
+	int get_window_width() const { return m_windowWidth; }
+	int get_window_height() const { return m_windowHeight; }
+	bool is_resident(int x, int y) const
+	{
+		return x >= m_windowX && y >= m_windowY && x < m_windowX + m_windowWidth && y < m_windowY + m_windowHeight;
+	}
+	/// @brief Check that the cells of the map within radius cells from (x, y) are all resident
+	bool is_area_resident(int x, int y, int radius) const;
+
+	/// @return : the cell at the given position, Oob if outside of the map
+	unsigned char at(int x, int y) const { return is_resident(x, y) ? m_cells[index(x, y)] : at_chunks(x, y); }
+
+	/// @brief No checks, x and y must be resident or in the border around the resident cells (out of bounds cells)
+	unsigned char at_unchecked(int x, int y) const { return m_cells[index(x, y)]; }
+
+	//raw access for code that walks the resident cells by index (one row is get_stride() cells)
+	int index(int x, int y) const { return (x - m_windowX + 1) + (y - m_windowY + 1) * m_stride; }
+	int get_stride() const { return m_stride; }
+	const unsigned char* data() const { return m_cells.data(); }
+
+	static bool is_solid(unsigned char cell) { return (cell & solidBit) != 0; }
+	static Cell from_char(char);
+	/// @return : the char the cell was loaded from ('o' for the border)
+	static char to_char(unsigned char cell) { return static_cast<char>(cell & ~solidBit); }
+
+private:
+	int m_width = 0, m_height = 0, m_stride = 0;
+	int m_windowX = 0, m_windowY = 0, m_windowWidth = 0, m_windowHeight = 0;
+	std::vector<unsigned char> m_cells;
+	std::shared_ptr<MapChunkFile> m_chunks;
+
+	unsigned char at_chunks(int, int) const;
+	void copy_window(int, int, int);
+};
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef OCCUPANCYPYRAMID_HPP
+#define OCCUPANCYPYRAMID_HPP
+
+#include "mapGrid.hpp"
+#include <vector>
+
+/// @brief Coarse occupancy levels over the resident MapGrid cells: a block is empty if none of its cells is solid.
+/// It takes 1/16 + 1/256 of the grid memory, rays can cross a whole empty block without checking its cells.
+/// Blocks are aligned to the map (resident cells start on a chunk), so they are kept when the resident cells move.
+class OccupancyPyramid
+{
+public:
+	//block sides are 1 << shift cells, from the finest level to the coarsest
+	static constexpr int levelsNumber = 2;
+	static constexpr int levelShifts[levelsNumber] = { 2, 4 };
+
+	OccupancyPyramid() = default;
+
+	void build(const MapGrid&);
+
+	/// @brief Update the blocks that contain a cell after it has changed (nothing to do if it is not resident)
+	/// @param grid : the grid the pyramid was built from, already changed
+	void update(const MapGrid& grid, int x, int y);
+
+	/// @brief Follow the resident cells after they moved: the blocks still resident are kept, only the new ones are computed
+	/// @param grid : the grid the pyramid was built from, after its window moved
+	void update_window(const MapGrid& grid);
+
+	bool is_built() const { return m_levels[0].width != 0; }
+
+	/// @param x : must be resident
+	/// @param y : must be resident
+	/// @return : the shift of the biggest empty block that contains the cell, 0 if none is empty
+	int empty_block_shift(int x, int y) const
+	{
+		x -= m_originX;
+		y -= m_originY;
+		for (int level = levelsNumber - 1; level >= 0; --level)
+		{
+			const Level& current = m_levels[level];
+			if (current.emptyBlocks[(x >> levelShifts[level]) + (y >> levelShifts[level]) * current.width])
+				return levelShifts[level];
+		}
+		return 0;
+	}
+
+private:
+	struct Level
+	{
+		int width = 0, height = 0;
+		std::vector<unsigned char> emptyBlocks;
+	};
+
+	Level m_levels[levelsNumber];
+	//first resident cell, block (0, 0) of every level starts there
+	int m_originX = 0, m_originY = 0;
+
+	void update_block(const MapGrid&, int, int, int);
+};
+
+#endif
@@ -1,7 +1,7 @@
 #ifndef PATHFINDER_H
 #define PATHFINDER_H
 
-#include <string>
+#include "mapGrid.hpp"
 #include <vector>
 #include <set>
 
@@ -9,18 +9,13 @@ class PathFinder
 {
 public:
 	PathFinder() = delete;
-	PathFinder(int,int, const std::string& tiles, std::vector<std::pair<int,int>>&);
+	PathFinder(const MapGrid& tiles, std::vector<std::pair<int,int>>&);
 	bool find_path(int,int);
 private:
-	int m_width;
-	int m_height;
-	char m_walkable = ' ';
-	char m_goal= 'g';
-	const std::string& m_tiles;
+	const MapGrid& m_tiles;
 	std::vector<std::pair<int, int>>& m_solVec;
 
 	bool recursive_dfs(std::set<std::pair<int, int>>&);
-	bool check_is_oob(int, int);
 };
 
 #endif
\ No newline at end of file
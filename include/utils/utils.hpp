@@ -6,6 +6,17 @@
 
 #define PI 3.14159265359f
 #define SQRT2 1.41421356237f
+
+//SIMD code paths are only available on x86. AVX2 functions are compiled individually
+//(so that the rest of the project doesn't require it) and selected at runtime
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define RCM_X86_SIMD
+	#if defined(_MSC_VER) && !defined(__clang__)
+		#define RCM_TARGET_AVX2
+	#else
+		#define RCM_TARGET_AVX2 __attribute__((target("avx2")))
+	#endif
+#endif
 //DEBUG
 namespace debug
 {
@@ -59,6 +70,16 @@ namespace utils
 {
 	int get_thread_number();
 
+	enum class SimdLevel
+	{
+		Scalar,
+		SSE2,
+		AVX2
+	};
+
+	/// @return : the widest instruction set supported by both the build and the running cpu
+	SimdLevel get_simd_level();
+
 	class SimpleCooldown 
 	{
 	public:
@@ -0,0 +1,64 @@
+#ifndef VISIBLECELLS_HPP
+#define VISIBLECELLS_HPP
+
+#include "mapGrid.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/// @brief Map cells crossed or hit by the wall rays of the last frame.
+/// Cells are stamped with the frame number, so that nothing has to be cleared between frames.
+/// Stamps cover the resident MapGrid cells, they have to be reset when the resident cells move.
+class VisibleCells
+{
+public:
+	VisibleCells() = default;
+
+	/// @brief Size the stamps for the grid, no cell is visible until the next frame
+	/// @param sections : number of sections (threads) that can mark cells at the same time
+	void reset(const MapGrid&, int sections);
+
+	bool is_sized() const { return m_stamps != nullptr; }
+
+	/// @brief Forget the cells of the last frame
+	void new_frame();
+
+	/// @brief Mark a cell as visible, different sections can mark cells concurrently
+	/// @param gridIndex : MapGrid::index() of the cell
+	/// @param section : in [0, sections)
+	void mark(int gridIndex, int section)
+	{
+		//most cells are crossed by many rays: only the first one pays for the exchange
+		std::atomic<unsigned int>& stamp = m_stamps[gridIndex];
+		if (stamp.load(std::memory_order_relaxed) != m_frame && stamp.exchange(m_frame, std::memory_order_relaxed) != m_frame)
+			m_sectionCells[section].push_back(gridIndex);
+	}
+
+	/// @brief Gather the cells marked by all sections, once all of them are done
+	void end_frame();
+
+	/// @return : false for cells that are not resident (rays only reach resident cells)
+	bool is_visible(int x, int y) const
+	{
+		x -= m_originX;
+		y -= m_originY;
+		return x >= 0 && y >= 0 && x < m_width && y < m_height &&
+			m_stamps[(x + 1) + (y + 1) * m_stride].load(std::memory_order_relaxed) == m_frame;
+	}
+
+	/// @return : cells visible during the last frame as map indices (x + y * map width), without duplicates
+	const std::vector<int64_t>& get_cells() const { return m_cells; }
+
+private:
+	//first resident cell and map width, to convert grid indices to map indices
+	int m_originX = 0, m_originY = 0, m_mapWidth = 0;
+	int m_width = 0, m_height = 0, m_stride = 0;
+	//0 is never used as a frame number, so that new stamps are not visible
+	unsigned int m_frame = 1;
+	std::unique_ptr<std::atomic<unsigned int>[]> m_stamps;
+	std::vector<std::vector<int>> m_sectionCells;
+	std::vector<int64_t> m_cells;
+};
+
+#endif
@@ -0,0 +1,106 @@
+#include "gameGraphics.hpp"
+
+#ifdef RCM_X86_SIMD
+#include <immintrin.h>
+#include <cstring>
+
+//Packet versions of GameGraphics::draw_background_pixel(). Adjacent pixels of a scanline are drawn together, one lane per column:
+//world positions, their fractional parts and the texture coordinates are computed with the same operations of the scalar
+//function (no fused multiply add), so the results match it. Texels are read as packed 32 bit pixels, their channels are
+//multiplied by the shading of the row with the rounding of the shade tables used by copy_pixels() and written opaque.
+//The multiplications make the packets slower than storing the shading as alpha (about 10 to 15%), but the view sprite
+//is then drawn without blending over a window that is no longer cleared.
+
+namespace
+{
+    //index of the texel of each lane, from the fractional parts of the world position
+    inline __m128i texel_indices_sse2(__m128 fractX, __m128 fractY, const Texture& texture)
+    {
+        __m128i u = _mm_cvttps_epi32(_mm_mul_ps(fractX, _mm_set1_ps((float)texture.width())));
+        __m128i v = _mm_cvttps_epi32(_mm_mul_ps(fractY, _mm_set1_ps((float)texture.height())));
+
+        //absolute values (fractional parts are negative for negative positions)
+        __m128i signU = _mm_srai_epi32(u, 31);
+        __m128i signV = _mm_srai_epi32(v, 31);
+        u = _mm_sub_epi32(_mm_xor_si128(u, signU), signU);
+        v = _mm_sub_epi32(_mm_xor_si128(v, signV), signV);
+
+        //no 32 bit multiplication in sse2: 16 bit products are enough for any texture up to 32768 pixels
+        return _mm_add_epi32(_mm_madd_epi16(v, _mm_set1_epi32(texture.width())), u);
+    }
+
+    //channel * shade / 255 rounded to nearest, on 16 bit lanes: (t + (t >> 8)) >> 8 with t = channel * shade + 128,
+    //taken as the high half of t * 257 (the same value for any t below 65536, with one multiplication instead of two shifts and an addition)
+    inline __m128i shade_channels_sse2(__m128i channels, __m128i shade)
+    {
+        __m128i t = _mm_add_epi16(_mm_mullo_epi16(channels, shade), _mm_set1_epi16(128));
+        return _mm_mulhi_epu16(t, _mm_set1_epi16(257));
+    }
+
+    inline void store_texels_sse2(sf::Uint8* pixels, __m128i indices, const Texture& texture, __m128i shade)
+    {
+        alignas(16) int index[4];
+        alignas(16) sf::Uint32 texels[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(index), indices);
+
+        for (int l = 0; l < 4; ++l)
+            std::memcpy(&texels[l], texture.m_texturePixels + index[l] * 4, 4);
+
+        __m128i texelsV = _mm_load_si128(reinterpret_cast<const __m128i*>(texels));
+        __m128i low = shade_channels_sse2(_mm_unpacklo_epi8(texelsV, _mm_setzero_si128()), shade);
+        __m128i high = shade_channels_sse2(_mm_unpackhi_epi8(texelsV, _mm_setzero_si128()), shade);
+        texelsV = _mm_or_si128(_mm_packus_epi16(low, high), _mm_set1_epi32((int)0xFF000000));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels), texelsV);
+    }
+
+    RCM_TARGET_AVX2 inline __m256i texel_indices_avx2(__m256 fractX, __m256 fractY, const Texture& texture)
+    {
+        __m256i u = _mm256_abs_epi32(_mm256_cvttps_epi32(_mm256_mul_ps(fractX, _mm256_set1_ps((float)texture.width()))));
+        __m256i v = _mm256_abs_epi32(_mm256_cvttps_epi32(_mm256_mul_ps(fractY, _mm256_set1_ps((float)texture.height()))));
+
+        return _mm256_add_epi32(_mm256_mullo_epi32(v, _mm256_set1_epi32(texture.width())), u);
+    }
+
+    RCM_TARGET_AVX2 inline __m256i shade_channels_avx2(__m256i channels, __m256i shade)
+    {
+        __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(channels, shade), _mm256_set1_epi16(128));
+        return _mm256_mulhi_epu16(t, _mm256_set1_epi16(257));
+    }
+
+    RCM_TARGET_AVX2 inline void store_texels_avx2(sf::Uint8* pixels, __m256i indices, const Texture& texture, __m256i shade)
+    {
+        __m256i texels = _mm256_i32gather_epi32(reinterpret_cast<const int*>(texture.m_texturePixels), indices, 4);
+
+        //unpacking and packing work within 128 bit lanes, so the pixel order is kept
+        __m256i low = shade_channels_avx2(_mm256_unpacklo_epi8(texels, _mm256_setzero_si256()), shade);
+        __m256i high = shade_channels_avx2(_mm256_unpackhi_epi8(texels, _mm256_setzero_si256()), shade);
+        texels = _mm256_or_si256(_mm256_packus_epi16(low, high), _mm256_set1_epi32((int)0xFF000000));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pixels), texels);
+    }
+}
+
+void GameGraphics::draw_background_pixels_sse2(const BackgroundRow& row, int firstX)
+{
+    const __m128 columns = _mm_cvtepi32_ps(_mm_add_epi32(_mm_set1_epi32(firstX), _mm_setr_epi32(0, 1, 2, 3)));
+    const __m128 posX = _mm_add_ps(_mm_set1_ps(row.start.x), _mm_mul_ps(_mm_set1_ps(row.increment.x), columns));
+    const __m128 posY = _mm_add_ps(_mm_set1_ps(row.start.y), _mm_mul_ps(_mm_set1_ps(row.increment.y), columns));
+    const __m128 fractX = _mm_sub_ps(posX, _mm_cvtepi32_ps(_mm_cvttps_epi32(posX)));
+    const __m128 fractY = _mm_sub_ps(posY, _mm_cvtepi32_ps(_mm_cvttps_epi32(posY)));
+    const __m128i shade = _mm_set1_epi16(row.shading);
+
+    store_texels_sse2(row.pixels + firstX * 4, texel_indices_sse2(fractX, fractY, *row.texture), *row.texture, shade);
+}
+
+RCM_TARGET_AVX2 void GameGraphics::draw_background_pixels_avx2(const BackgroundRow& row, int firstX)
+{
+    const __m256 columns = _mm256_cvtepi32_ps(_mm256_add_epi32(_mm256_set1_epi32(firstX), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)));
+    const __m256 posX = _mm256_add_ps(_mm256_set1_ps(row.start.x), _mm256_mul_ps(_mm256_set1_ps(row.increment.x), columns));
+    const __m256 posY = _mm256_add_ps(_mm256_set1_ps(row.start.y), _mm256_mul_ps(_mm256_set1_ps(row.increment.y), columns));
+    const __m256 fractX = _mm256_sub_ps(posX, _mm256_cvtepi32_ps(_mm256_cvttps_epi32(posX)));
+    const __m256 fractY = _mm256_sub_ps(posY, _mm256_cvtepi32_ps(_mm256_cvttps_epi32(posY)));
+    const __m256i shade = _mm256_set1_epi16(row.shading);
+
+    store_texels_avx2(row.pixels + firstX * 4, texel_indices_avx2(fractX, fractY, *row.texture), *row.texture, shade);
+}
+
+#endif
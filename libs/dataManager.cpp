@@ -1,5 +1,6 @@
 
 #include "dataManager.hpp"
+#include "mapChunks.hpp"
 #include <fstream>
 #include <nlohmann/json.hpp>
 #include <exception>
@@ -8,6 +9,9 @@
 using json = nlohmann::json;
 
 void load_map_from_file(std::unique_ptr<std::string>& tiles, const std::string&);
+void load_map_chunks(rcm::GameMap&, const std::string&, const std::string&);
+utils::SimdLevel simd_level_from_string(const std::string&);
+rcm::RayAcceleration ray_acceleration_from_string(const std::string&);
 
 std::unique_ptr<DataUtils::GameData> DataUtils::load_game_data(const std::string& configPath)
 {
@@ -17,6 +21,7 @@ std::unique_ptr<DataUtils::GameData> DataUtils::load_game_data(const std::string
 		throw std::invalid_argument("Could not open configuration file.");
 	std::unique_ptr<GameData> gameData = std::make_unique<GameData>();
 	std::string mapFilePath;
+	std::string mapChunksPath;
 
 	try
 	{
@@ -28,6 +33,19 @@ std::unique_ptr<DataUtils::GameData> DataUtils::load_game_data(const std::string
 		gameData->gameCameraVars.fov = math::deg_to_rad( data.at("gameCamera").at("FOV").get<float>() );
 		gameData->gameCameraVars.maxRenderDist = data.at("gameCamera").at("maxRenderDist").get<float>();
 		gameData->gameCameraVars.rayPrecision = data.at("gameCamera").at("rayPrecision").get<float>();
+		gameData->gameCameraVars.parallelRayCasting = data.at("gameCamera").at("parallelRayCasting").get<bool>();
+		gameData->gameCameraVars.raySimdLevel = simd_level_from_string(data.at("gameCamera").at("raySimd").get<std::string>());
+		gameData->gameCameraVars.rayAcceleration = ray_acceleration_from_string(data.at("gameCamera").at("rayAcceleration").get<std::string>());
+		gameData->gameCameraVars.trackVisibleCells = data.at("gameCamera").at("visibleCells").get<bool>();
+		gameData->gameCameraVars.fixedPointRays = data.at("gameCamera").at("fixedPointRays").get<bool>();
+		gameData->gameCameraVars.raySubdivision = data.at("gameCamera").at("raySubdivision").get<int>();
+		if (gameData->gameCameraVars.raySubdivision < 1)
+			throw std::invalid_argument("raySubdivision must be at least 1.");
+		gameData->gameCameraVars.wallSpans = data.at("gameCamera").at("wallSpans").get<bool>();
+		gameData->gameCameraVars.frameTimeTarget = data.at("gameCamera").at("frameTimeTargetMs").get<float>();
+		gameData->gameCameraVars.minRenderScale = data.at("gameCamera").at("minRenderScale").get<float>();
+		if (gameData->gameCameraVars.minRenderScale <= 0.f || gameData->gameCameraVars.minRenderScale > 1.f)
+			throw std::invalid_argument("minRenderScale must be in (0, 1].");
 
 		gameData->gameMap.width = data.at("gameMap").at("mapW").get<int>();
 		gameData->gameMap.height = data.at("gameMap").at("mapH").get<int>();
@@ -41,6 +59,8 @@ std::unique_ptr<DataUtils::GameData> DataUtils::load_game_data(const std::string
 		gameData->graphicsVars.halfWallHeight = data.at("windowStats").at("halfWallHeight").get<float>();
 		gameData->graphicsVars.maxSightDepth = gameData->gameCameraVars.maxRenderDist;
 		gameData->graphicsVars.frameRate = data.at("windowStats").at("frameRate").get<int>();
+		gameData->graphicsVars.backgroundSimdLevel = simd_level_from_string(data.at("windowStats").at("backgroundSimd").get<std::string>());
+		gameData->graphicsVars.mipmaps = data.at("windowStats").at("mipmaps").get<bool>();
 
 		gameData->gameAssets.fontFilePath = data.at("assets").at("font").get<std::string>();
 		gameData->gameAssets.wallTexFilePath = data.at("assets").at("textures").at("wallTexPath").get<std::string>();
@@ -53,6 +73,9 @@ std::unique_ptr<DataUtils::GameData> DataUtils::load_game_data(const std::string
 			gameData->gameSprites.emplace_back(sprite.at(0).get<int>(), sprite.at(1).get<std::string>());
 
 		mapFilePath = data.at("gameMap").at("mapCellsFile").get<std::string>();
+		mapChunksPath = data.at("gameMap").at("mapChunksFile").get<std::string>();
+		if (!mapChunksPath.empty() && gameData->gameMap.generated)
+			throw std::invalid_argument("Generated maps can't be read from a map chunks file.");
 		std::cout << data.dump(4);
 	}
 	catch (std::exception& e)
@@ -63,7 +86,10 @@ std::unique_ptr<DataUtils::GameData> DataUtils::load_game_data(const std::string
 	}
 	try
 	{
-		load_map_from_file(gameData->gameMap.cells, mapFilePath);
+		if (mapChunksPath.empty())
+			load_map_from_file(gameData->gameMap.cells, mapFilePath);
+		else
+			load_map_chunks(gameData->gameMap, mapChunksPath, mapFilePath);
 	}
 	catch (std::exception& e)
 	{
@@ -90,3 +116,45 @@ void load_map_from_file(std::unique_ptr<std::string>& tiles, const std::string&
 		throw std::runtime_error("Could not open map file.");
 }
 
+void load_map_chunks(rcm::GameMap& gameMap, const std::string& chunksPath, const std::string& mapPath)
+{
+	//the chunk file is written from the map file the first time
+	if (!std::ifstream(chunksPath).good())
+	{
+		std::unique_ptr<std::string> tiles;
+		load_map_from_file(tiles, mapPath);
+		size_t width = gameMap.width;
+		MapChunkFile::write(chunksPath, gameMap.width, gameMap.height, [&](int x, int y)
+			{
+				size_t i = x + y * width;
+				return i < tiles->size() ? tiles->at(i) : ' ';
+			});
+	}
+
+	//the map size is the one of the chunk file
+	gameMap.chunks = std::make_shared<MapChunkFile>(chunksPath);
+	gameMap.width = gameMap.chunks->get_width();
+	gameMap.height = gameMap.chunks->get_height();
+}
+
+utils::SimdLevel simd_level_from_string(const std::string& level)
+{
+	if (level == "avx2")
+		return utils::SimdLevel::AVX2;
+	if (level == "sse2")
+		return utils::SimdLevel::SSE2;
+	if (level == "none")
+		return utils::SimdLevel::Scalar;
+	throw std::invalid_argument("Unknown instruction set: " + level + " (expected \"avx2\", \"sse2\" or \"none\").");
+}
+
+rcm::RayAcceleration ray_acceleration_from_string(const std::string& acceleration)
+{
+	if (acceleration == "distanceField")
+		return rcm::RayAcceleration::DistanceField;
+	if (acceleration == "pyramid")
+		return rcm::RayAcceleration::Pyramid;
+	if (acceleration == "none")
+		return rcm::RayAcceleration::None;
+	throw std::invalid_argument("Unknown ray acceleration: " + acceleration + " (expected \"distanceField\", \"pyramid\" or \"none\").");
+}
\ No newline at end of file
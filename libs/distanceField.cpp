@@ -0,0 +1,138 @@
+#include "distanceField.hpp"
+#include <algorithm>
+
+void DistanceField::build(const MapGrid& grid)
+{
+	m_originX = grid.get_window_x();
+	m_originY = grid.get_window_y();
+	m_width = grid.get_window_width();
+	m_height = grid.get_window_height();
+	m_stride = grid.get_stride();
+	m_distances.assign(m_stride * (m_height + 2), 0);
+
+	//the border is part of the field, so that it can be read with the same unchecked indices of the grid
+	reset_area(grid, -1, -1, m_width, m_height);
+	propagate_area(-1, -1, m_width, m_height);
+}
+
+void DistanceField::update(const MapGrid& grid, int x, int y)
+{
+	if (!is_built() || !grid.is_resident(x, y))
+		return;
+
+	//areas are in field coordinates (the first resident cell is 0, 0)
+	x -= m_originX;
+	y -= m_originY;
+
+	//cells further than maxDistance - 1 are either already capped or closer to another solid cell
+	const int radius = maxDistance - 1;
+
+	reset_area(grid, std::max(x - radius, -1), std::max(y - radius, -1), std::min(x + radius, m_width), std::min(y + radius, m_height));
+
+	//the ring around the reset area is unchanged and acts as a source for it
+	propagate_area(std::max(x - radius - 1, -1), std::max(y - radius - 1, -1), std::min(x + radius + 1, m_width), std::min(y + radius + 1, m_height));
+}
+
+void DistanceField::update_window(const MapGrid& grid)
+{
+	if (!is_built())
+		return;
+
+	int lastOriginX = m_originX, lastOriginY = m_originY;
+	int lastWidth = m_width, lastHeight = m_height, lastStride = m_stride;
+	m_originX = grid.get_window_x();
+	m_originY = grid.get_window_y();
+	m_width = grid.get_window_width();
+	m_height = grid.get_window_height();
+	m_stride = grid.get_stride();
+
+	//areas are in field coordinates (the first resident cell is 0, 0). Cells resident before and after the move are kept
+	//unless they are within maxDistance - 1 of a window side that moved: cells on the other side of it changed
+	const int radius = maxDistance - 1;
+	int keptX = std::max(lastOriginX, m_originX) - m_originX;
+	int keptY = std::max(lastOriginY, m_originY) - m_originY;
+	int keptEndX = std::min(lastOriginX + lastWidth, m_originX + m_width) - m_originX;
+	int keptEndY = std::min(lastOriginY + lastHeight, m_originY + m_height) - m_originY;
+	if (lastOriginX != m_originX)
+		keptX += radius;
+	if (lastOriginY != m_originY)
+		keptY += radius;
+	if (lastOriginX + lastWidth != m_originX + m_width)
+		keptEndX -= radius;
+	if (lastOriginY + lastHeight != m_originY + m_height)
+		keptEndY -= radius;
+
+	if (keptX >= keptEndX || keptY >= keptEndY)
+	{
+		build(grid);
+		return;
+	}
+
+	std::swap(m_distances, m_lastDistances);
+	m_distances.assign(m_stride * (m_height + 2), 0);
+	for (int y = keptY; y < keptEndY; ++y)
+	{
+		int lastIndex = (keptX + m_originX - lastOriginX + 1) + (y + m_originY - lastOriginY + 1) * lastStride;
+		std::copy_n(m_lastDistances.begin() + lastIndex, keptEndX - keptX, m_distances.begin() + (keptX + 1) + (y + 1) * m_stride);
+	}
+
+	//the other cells (border included) are computed again, in strips: the ones above and below the kept cells span the whole width
+	reset_area(grid, -1, -1, m_width, keptY - 1);
+	reset_area(grid, -1, keptEndY, m_width, m_height);
+	reset_area(grid, -1, keptY, keptX - 1, keptEndY - 1);
+	reset_area(grid, keptEndX, keptY, m_width, keptEndY - 1);
+
+	//a strip is right once the ring around it is (strips of border cells only are right once reset): the side strips are
+	//propagated after the ones above and below them. Those can be closest to solid cells of the side strips, so they are
+	//propagated together with the radius rows next to them (with every solid cell within radius, the result is exact whatever the ring)
+	bool sideStrips = keptX > 0 || keptEndX < m_width;
+	int rows = sideStrips ? radius : 1;
+	if (keptY > 0)
+		propagate_area(-1, -1, m_width, std::min(keptY - 1 + rows, m_height));
+	if (keptEndY < m_height)
+		propagate_area(-1, std::max(keptEndY - rows, -1), m_width, m_height);
+	if (keptX > 0)
+		propagate_area(-1, keptY - 1, keptX, keptEndY);
+	if (keptEndX < m_width)
+		propagate_area(keptEndX - 1, keptY - 1, m_width, keptEndY);
+}
+
+void DistanceField::reset_area(const MapGrid& grid, int firstX, int firstY, int lastX, int lastY)
+{
+	for (int y = firstY; y <= lastY; ++y)
+		for (int x = firstX; x <= lastX; ++x)
+			m_distances[grid.index(m_originX + x, m_originY + y)] = MapGrid::is_solid(grid.at_unchecked(m_originX + x, m_originY + y)) ? 0 : maxDistance;
+}
+
+void DistanceField::propagate_area(int firstX, int firstY, int lastX, int lastY)
+{
+	//two passes chamfer transform: with unitary weights for all 8 neighbours the result is the exact Chebyshev distance
+	auto relax = [this](int x, int y, int neighbourX, int neighbourY)
+		{
+			if (neighbourX < -1 || neighbourY < -1 || neighbourX > m_width || neighbourY > m_height)
+				return;
+
+			unsigned char& distance = m_distances[(x + 1) + (y + 1) * m_stride];
+			unsigned char neighbour = m_distances[(neighbourX + 1) + (neighbourY + 1) * m_stride];
+			if (neighbour + 1 < distance)
+				distance = neighbour + 1;
+		};
+
+	for (int y = firstY; y <= lastY; ++y)
+		for (int x = firstX; x <= lastX; ++x)
+		{
+			relax(x, y, x - 1, y);
+			relax(x, y, x - 1, y - 1);
+			relax(x, y, x, y - 1);
+			relax(x, y, x + 1, y - 1);
+		}
+
+	for (int y = lastY; y >= firstY; --y)
+		for (int x = lastX; x >= firstX; --x)
+		{
+			relax(x, y, x + 1, y);
+			relax(x, y, x + 1, y + 1);
+			relax(x, y, x, y + 1);
+			relax(x, y, x - 1, y + 1);
+		}
+}
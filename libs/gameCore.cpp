@@ -4,38 +4,213 @@
 #include <stdexcept>
 #include <cmath>
 #include <cassert>
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <cstdint>
+#include <numeric>
 
 #define TIME_CORRECTION 1e-9f
 
+//cap for the ray length increments: big enough to never be reached, finite so that 0 * increment == 0
+constexpr float g_maxLengthIncrement = 1e30f;
+//fixed point ray lengths: 16 bits for the fractional part
+constexpr int g_fixedShift = 16;
+constexpr int64_t g_fixedOne = int64_t(1) << g_fixedShift;
+//increment of axis aligned rays, never reached
+constexpr int64_t g_fixedMaxIncrement = int64_t(1) << 40;
+//pi in 2.30 fixed point
+constexpr int64_t g_fixedPi30 = 3373259426;
+//line of sight batches are split over the thread pool only if every section gets at least this many queries
+constexpr int g_minParallelSightQueries = 64;
+//column subdivision: smallest gap between two intersections compared by the ends of a span (relative to the ray length).
+//Lengths are rounded by a few ulps (below 1e-6), the gap keeps every comparison of the rays in between on the same side
+constexpr float g_pathMinGap = 1e-5f;
+
 using namespace rcm;
 
 //----------------------RayInfo----------------------
 
-RayInfo& RayInfoArr::at(int index)
+template<typename T>
+static T* new_ray_array(int size, T value)
+{
+	T* arr = static_cast<T*>(::operator new[](sizeof(T) * size, std::align_val_t(RayInfoArr::alignment)));
+	std::uninitialized_fill_n(arr, size, value);
+	return arr;
+}
+
+template<typename T>
+static void delete_ray_array(T* arr)
+{
+	::operator delete[](arr, std::align_val_t(RayInfoArr::alignment));
+}
+
+RayInfoArr::RayInfoArr(int capacity) :
+	m_capacity(capacity),
+	m_size(capacity),
+	m_hitTypes(new_ray_array(capacity, HitType::NoHit)),
+	m_hitPositions(new_ray_array(capacity, math::Vect2{ 0, 0 })),
+	m_lengths(new_ray_array(capacity, 0.f)),
+	m_sides(new_ray_array(capacity, CellSide::Unknown)),
+	m_textureUs(new_ray_array(capacity, 0.f))
+{}
+
+RayInfoArr::~RayInfoArr()
 {
-	if (index < 0 || index >= arrSize)
+	delete_ray_array(m_hitTypes);
+	delete_ray_array(m_hitPositions);
+	delete_ray_array(m_lengths);
+	delete_ray_array(m_sides);
+	delete_ray_array(m_textureUs);
+}
+
+void RayInfoArr::resize(int size)
+{
+	if (size < 1 || size > m_capacity)
+		throw std::invalid_argument("Size exceeds the rays capacity.");
+	else
+		m_size = size;
+}
+
+RayInfo RayInfoArr::const_at(int index) const
+{
+	if (index < 0 || index >= m_size)
 		throw std::invalid_argument("Index is out of range.");
 	else
-		return m_rayArr[index];
+		return { m_hitTypes[index], m_hitPositions[index], m_lengths[index], m_sides[index], m_textureUs[index] };
 }
 
-const RayInfo& RayInfoArr::const_at(int index) const
+void RayInfoArr::set(int index, const RayInfo& ray)
 {
-	if (index < 0 || index >= arrSize)
+	if (index < 0 || index >= m_size)
 		throw std::invalid_argument("Index is out of range.");
 	else
-		return m_rayArr[index];
+		store(index, ray.entityHit, ray.hitPos, ray.length, ray.lastSideChecked, ray.textureU);
+}
+
+//----------------------fixed-point----------------------
+
+//sine and cosine on integers only, so that fixed point rays don't depend on the math library
+//angle and results are 16.16 fixed point, the series are computed in 2.30
+static void fixed_sin_cos(int64_t angle, int64_t& sinOut, int64_t& cosOut)
+{
+	constexpr int64_t one = int64_t(1) << 30;
+
+	int64_t x = (angle * (one >> g_fixedShift)) % (2 * g_fixedPi30);
+	if (x >= g_fixedPi30)
+		x -= 2 * g_fixedPi30;
+	else if (x < -g_fixedPi30)
+		x += 2 * g_fixedPi30;
+
+	//in [-pi/2, pi/2] the series converge quickly: sin(pi - x) = sin(x), cos(pi - x) = -cos(x)
+	int64_t cosSign = 1;
+	if (x > g_fixedPi30 / 2)
+	{
+		x = g_fixedPi30 - x;
+		cosSign = -1;
+	}
+	else if (x < -g_fixedPi30 / 2)
+	{
+		x = -g_fixedPi30 - x;
+		cosSign = -1;
+	}
+
+	int64_t x2 = (x * x) / one;
+
+	//Taylor series in Horner form, the first omitted terms are below 2^-24
+	int64_t sine = one;
+	for (int64_t divisor : { 110, 72, 42, 20, 6 })
+		sine = one - (x2 * sine) / one / divisor;
+	sine = (x * sine) / one;
+
+	int64_t cosine = one;
+	for (int64_t divisor : { 132, 90, 56, 30, 12, 2 })
+		cosine = one - (x2 * cosine) / one / divisor;
+	cosine *= cosSign;
+
+	sinOut = sine / (one >> g_fixedShift);
+	cosOut = cosine / (one >> g_fixedShift);
+}
+
+//---------------------------THREAD-POOL-HELPERS---
+
+RayCastSectionFactory::RayCastSection::RayCastSection(int start, int end, int index, RayCastSectionFactory* source) :
+	IRenderingSection(start, end),
+	m_source(source),
+	m_index(index)
+{}
+
+void RayCastSectionFactory::RayCastSection::operator()() const
+{
+	if (m_source == nullptr || m_source->m_core == nullptr)
+		throw std::runtime_error("Ray casting section called while no target was set.");
+
+	//if the section is empty do nothing
+	if (m_start == m_end)
+		return;
+
+	m_source->m_core->view_walls_batch_section(m_start, m_end, m_source->m_useCameraPlane, m_index);
+}
+
+RayCastSectionFactory::RayCastSection RayCastSectionFactory::create_section(int index)
+{
+	int sectionStart = m_sectionSize * index;
+	return RayCastSection(sectionStart, sectionStart + get_section(index), index, this);
+}
+
+SightSectionFactory::SightSection::SightSection(int start, int end, SightSectionFactory* source) :
+	IRenderingSection(start, end),
+	m_source(source)
+{}
+
+void SightSectionFactory::SightSection::operator()() const
+{
+	if (m_source == nullptr || m_source->m_core == nullptr || m_source->m_queries == nullptr || m_source->m_results == nullptr)
+		throw std::runtime_error("Line of sight section called while no target was set.");
+
+	if (m_start == m_end)
+		return;
+
+	m_source->m_core->check_lines_of_sight_section(m_start, m_end, *(m_source->m_queries), *(m_source->m_results));
+}
+
+SightSectionFactory::SightSection SightSectionFactory::create_section(int index)
+{
+	int sectionStart = m_sectionSize * index;
+	return SightSection(sectionStart, sectionStart + get_section(index), this);
 }
 
 //----------------------GameCore----------------------
 
-GameCore::GameCore(GameCameraVars& gameCameraVars, GameMap& gameMap, EntityTransform& transform) : 
+GameCore::RayCamera::RayCamera(GameCameraVars& cameraVars, const EntityTransform& cameraTransform, std::unique_ptr<GameCameraVars> ownVars) :
+	ownedVars(std::move(ownVars)),
+	vars(cameraVars),
+	transform(cameraTransform),
+	rays(cameraVars.pixelWidth),
+	raySimdLevel(std::min(cameraVars.raySimdLevel, utils::get_simd_level()))
+{}
+
+GameCore::GameCore(GameCameraVars& gameCameraVars, GameMap& gameMap, EntityTransform& transform, RendThreadPool& rendThreadPool) : 
 	m_gameCamera(gameCameraVars),
 	m_gameMap(gameMap),
 	m_playerTransform(transform),
 	m_processorCount(utils::get_thread_number()),
-	m_rayInfoArr(gameCameraVars.pixelWidth)
+	m_rendThreadPool(rendThreadPool),
+	m_rayCastSecFactory(gameCameraVars.pixelWidth, rendThreadPool.get_size()),
+	m_rayCastColumns(gameCameraVars.pixelWidth),
+	m_sightSecFactory(0, rendThreadPool.get_size())
 {
+	m_cameras.push_back(std::make_unique<RayCamera>(m_gameCamera, m_playerTransform));
+
+	//columns are split in as many sections as there are workers, the last one is run by the calling thread
+	m_rayCastSecFactory.set_target(this);
+	for (int i = 0; i < m_rayCastSecFactory.get_size(); ++i)
+		m_rayCastSectionsVec.push_back(m_rayCastSecFactory.create_section(i));
+	m_sectionSavedRays.resize(m_rayCastSecFactory.get_size(), 0);
+
+	//line of sight sections are created for each batch
+	m_sightSecFactory.set_target(this);
+
 
 	if (m_gameMap.generated)
 	{
@@ -44,9 +219,61 @@ GameCore::GameCore(GameCameraVars& gameCameraVars, GameMap& gameMap, EntityTrans
 
 		m_mapGenerator = std::make_unique<MapGenerator>((int)m_playerTransform.coordinates.x, (int)m_playerTransform.coordinates.y, m_gameMap.width, m_gameMap.height, *(m_gameMap.cells));
 	}
+	else
+	{
+		//a loaded map is already complete, a generated one is converted when generation ends
+		load_map_grid();
+	}
 	//camera plane vars
-	m_cameraVecs.forewardDirection = { std::cos(m_playerTransform.forewardAngle), std::sin(m_playerTransform.forewardAngle) };
-	m_cameraVecs.plane = math::Vect2( m_cameraVecs.forewardDirection.y , -m_cameraVecs.forewardDirection.x ) * std::tan( m_gameCamera.fov/2 ) * 2;
+	update_camera_vecs(*m_cameras.front());
+}
+
+int GameCore::add_camera(const GameCameraVars& cameraVars, const EntityTransform& transform)
+{
+	if (cameraVars.pixelWidth < 1)
+		throw std::invalid_argument("Camera render width must be positive.");
+
+	std::unique_ptr<GameCameraVars> vars = std::make_unique<GameCameraVars>(cameraVars);
+	vars->trackVisibleCells = false;
+	vars->frameTimeTarget = 0.f;
+
+	GameCameraVars& varsRef = *vars;
+	m_cameras.push_back(std::make_unique<RayCamera>(varsRef, transform, std::move(vars)));
+	update_camera_vecs(*m_cameras.back());
+	build_ray_acceleration();
+
+	return get_cameras_number() - 1;
+}
+
+void GameCore::remove_camera(int camera)
+{
+	if (camera < 1 || camera >= get_cameras_number())
+		throw std::invalid_argument("Only added cameras can be removed.");
+
+	m_cameras.erase(m_cameras.begin() + camera);
+}
+
+math::Vect2 GameCore::get_column_ray_direction(int column, int cameraIndex) const
+{
+	const RayCamera& camera = *m_cameras.at(cameraIndex);
+	if (!camera.rayCastState.valid)
+		throw std::runtime_error("No rays were cast by the camera in the last frame.");
+	if (column < 0 || column >= camera.vars.pixelWidth)
+		throw std::invalid_argument("Column is out of range.");
+
+	return get_ray_direction(camera, column, camera.rayCastState.useCameraPlane);
+}
+
+void GameCore::update_camera_vecs(RayCamera& camera)
+{
+	camera.cameraVecs.forewardDirection = {
+		std::cos(camera.transform.forewardAngle),
+		std::sin(camera.transform.forewardAngle)
+	};
+	camera.cameraVecs.plane = math::Vect2(
+		camera.cameraVecs.forewardDirection.y,
+		-camera.cameraVecs.forewardDirection.x
+	) * std::tan(camera.vars.fov / 2) * 2;
 }
 
 bool GameCore::check_out_of_map_bounds(const math::Vect2& pos) const 
@@ -72,26 +299,91 @@ void GameCore::chech_position_in_map(const math::Vect2& rayPosInMap, HitType& hi
 
 void GameCore::chech_position_in_map(int rayPosInMapX, int rayPosInMapY, HitType& hitMarker) const
 {
-	if (!check_out_of_map_bounds(rayPosInMapX, rayPosInMapY))
-	{
-		switch (m_gameMap.cells->at(rayPosInMapX + rayPosInMapY * m_gameMap.width))
-		{
-		case 'w':
-			hitMarker = HitType::Wall;
-			break;
-		case 'b':
-			hitMarker = HitType::Baudry;
-			break;
-		default:
-			break;
-		}
-	}
+	//out of bounds positions are read as solid Oob cells
+	unsigned char cell = m_gameMap.grid.at(rayPosInMapX, rayPosInMapY);
+	if (MapGrid::is_solid(cell))
+		hitMarker = static_cast<HitType>(MapGrid::to_char(cell));
+}
+
+void GameCore::load_map_grid()
+{
+	if (m_gameMap.chunks != nullptr)
+		m_gameMap.grid.load(m_gameMap.chunks, (int)m_playerTransform.coordinates.x, (int)m_playerTransform.coordinates.y, get_map_window_radius(m_gameCamera));
+	else if (m_gameMap.cells.get() == nullptr)
+		throw std::runtime_error("No map cells to load.");
 	else
+		m_gameMap.grid.load(m_gameMap.width, m_gameMap.height, *(m_gameMap.cells));
+	++m_mapVersion;
+
+	if (m_gameCamera.trackVisibleCells)
+		m_visibleCells.reset(m_gameMap.grid, m_rayCastSecFactory.get_size());
+
+	build_ray_acceleration();
+}
+
+void GameCore::update_map_window()
+{
+	if (!m_gameMap.grid.update_window((int)m_playerTransform.coordinates.x, (int)m_playerTransform.coordinates.y, get_map_window_radius(m_gameCamera)))
+		return;
+
+	//grid indices changed, the cells didn't. The field only computes the distances near the cells that became resident
+	//and near the moved border, the pyramid only the blocks that became resident
+	m_distanceField.update_window(m_gameMap.grid);
+	m_occupancyPyramid.update_window(m_gameMap.grid);
+	if (m_visibleCells.is_sized())
+		m_visibleCells.reset(m_gameMap.grid, m_rayCastSecFactory.get_size());
+}
+
+int GameCore::get_map_window_radius(const GameCameraVars& cameraVars) const
+{
+	//camera plane lengths are measured along the view direction: up to 1 / cos(fov / 2) longer for the side columns.
+	//Wall spans visit the cells up to a manhattan distance of (about) sqrt(2) times that, and check their neighbours
+	int mapSide = std::max(m_gameMap.width, m_gameMap.height);
+	float lengthScale = std::cos(cameraVars.fov / 2);
+	if (lengthScale <= 0)
+		return mapSide;
+
+	float radius = cameraVars.maxRenderDist * std::sqrt(2.f) / lengthScale + 4;
+	return radius < mapSide ? (int)radius : mapSide;
+}
+
+void GameCore::build_ray_acceleration()
+{
+	if (!m_gameMap.grid.is_loaded())
+		return;
+
+	//the ones requested by any camera
+	for (const std::unique_ptr<RayCamera>& camera : m_cameras)
 	{
-		hitMarker = HitType::Oob;
+		if (camera->vars.rayAcceleration == RayAcceleration::DistanceField && !m_distanceField.is_built())
+			m_distanceField.build(m_gameMap.grid);
+		else if (camera->vars.rayAcceleration == RayAcceleration::Pyramid && !m_occupancyPyramid.is_built())
+			m_occupancyPyramid.build(m_gameMap.grid);
 	}
 }
 
+void GameCore::set_ray_acceleration(RayAcceleration rayAcceleration)
+{
+	for (std::unique_ptr<RayCamera>& camera : m_cameras)
+		camera->vars.rayAcceleration = rayAcceleration;
+	build_ray_acceleration();
+}
+
+void GameCore::set_map_cell(int cellX, int cellY, char cell)
+{
+	if (!m_gameMap.grid.is_loaded())
+		throw std::runtime_error("Map cells can't be changed before the map is complete.");
+
+	m_gameMap.grid.set_cell(cellX, cellY, cell);
+	if (m_gameMap.cells.get() != nullptr)
+		m_gameMap.cells->at(cellX + cellY * m_gameMap.width) = cell;
+	++m_mapVersion;
+
+	//structures that were never built are left as they are
+	m_distanceField.update(m_gameMap.grid, cellX, cellY);
+	m_occupancyPyramid.update(m_gameMap.grid, cellX, cellY);
+}
+
 void GameCore::add_entity(IEntity* entity)
 {
 	m_entities.emplace_back(entity);
@@ -99,11 +391,24 @@ void GameCore::add_entity(IEntity* entity)
 
 bool GameCore::generate_map_step() 
 { 
-	return ((m_mapGenerator.get() != nullptr) && m_mapGenerator->generate_map_step()); 
+	if (m_mapGenerator.get() == nullptr)
+		return false;
+	if (m_mapGenerator->generate_map_step())
+		return true;
+
+	//generation is over
+	if (m_mapGenerator->is_done() && !m_gameMap.grid.is_loaded())
+		load_map_grid();
+	return false;
 }
 bool GameCore::generate_map() 
 { 
-	return ((m_mapGenerator.get() != nullptr) && m_mapGenerator->generate_map()); 
+	if ((m_mapGenerator.get() != nullptr) && m_mapGenerator->generate_map())
+	{
+		load_map_grid();
+		return true;
+	}
+	return false;
 }
 
 void GameCore::update_entities()
@@ -149,15 +454,9 @@ void GameCore::update_entities()
 		}
 	}
 
-	//update camera direction
-	m_cameraVecs.forewardDirection = {
-		std::cos(m_playerTransform.forewardAngle),
-		std::sin(m_playerTransform.forewardAngle)
-	};
-	m_cameraVecs.plane = math::Vect2(
-		m_cameraVecs.forewardDirection.y,
-		-m_cameraVecs.forewardDirection.x
-	) * std::tan(m_gameCamera.fov / 2) * 2;
+	//update cameras direction
+	for (std::unique_ptr<RayCamera>& camera : m_cameras)
+		update_camera_vecs(*camera);
 }
 
 void GameCore::remove_destroyed_entities()
@@ -171,6 +470,23 @@ void GameCore::remove_destroyed_entities()
 	}
 }
 
+void GameCore::set_render_width(int width)
+{
+	if (width < 1 || width > get_max_render_width())
+		throw std::invalid_argument("Render width is out of range.");
+
+	if (width == m_gameCamera.pixelWidth)
+		return;
+
+	RayCamera& camera = *m_cameras.front();
+	m_gameCamera.pixelWidth = width;
+	camera.rays.resize(width);
+
+	//the last rays were cast for another width, directions are rebuilt by the next frame
+	//(sections follow the columns of the next batch)
+	camera.rayCastState.valid = false;
+}
+
 void GameCore::view_by_ray_casting(bool useCameraPlane)
 {
 	view_walls(useCameraPlane);
@@ -179,177 +495,929 @@ void GameCore::view_by_ray_casting(bool useCameraPlane)
 
 void GameCore::view_walls(bool useCameraPlane)
 {
-	math::Vect2 startPos = m_playerTransform.coordinates;
-	math::Vect2 currentRayDir;
-	math::Vect2 rayRotationIncrement;
-	math::Mat2x2 rayRotationIncrementMat;
+	m_rayCastingTimer.reset_timer();
+	std::fill(m_sectionSavedRays.begin(), m_sectionSavedRays.end(), 0);
+	m_savedRays = 0;
+	m_reusedRays = 0;
+
+	//the resident cells follow the player camera
+	if (m_gameMap.grid.is_inside((int)m_playerTransform.coordinates.x, (int)m_playerTransform.coordinates.y))
+		update_map_window();
+
+	//the columns of the cameras cast by rays are laid one after the other and split over the sections of a single batch,
+	//wall spans are projected by the calling thread while the workers cast
+	int batchColumns = 0;
+	bool trackVisibleCells = false;
+	m_spanCameras.clear();
+
+	for (std::unique_ptr<RayCamera>& camera : m_cameras)
+	{
+		camera->batchOffset = -1;
+		if (!prepare_camera_walls(*camera, useCameraPlane))
+			continue;
 
-	if (useCameraPlane)
+		trackVisibleCells = trackVisibleCells || is_tracking_visible_cells(*camera);
+		if (is_using_wall_spans(*camera))
+		{
+			m_spanCameras.push_back(camera.get());
+		}
+		else
+		{
+			camera->batchOffset = batchColumns;
+			batchColumns += camera->vars.pixelWidth;
+		}
+	}
+
+	if (trackVisibleCells)
+		m_visibleCells.new_frame();
+
+	if (batchColumns > 0 && m_gameCamera.parallelRayCasting)
 	{
-		currentRayDir = m_cameraVecs.forewardDirection - m_cameraVecs.plane / 2;
-		rayRotationIncrement = m_cameraVecs.plane / (m_gameCamera.pixelWidth);
+		//same sections, only the columns they cover change
+		if (batchColumns != m_rayCastColumns)
+		{
+			m_rayCastColumns = batchColumns;
+			m_rayCastSecFactory.set_task_number(batchColumns);
+			for (int i = 0; i < m_rayCastSecFactory.get_size(); ++i)
+				m_rayCastSectionsVec.at(i) = m_rayCastSecFactory.create_section(i);
+		}
+		m_rayCastSecFactory.set_camera_plane(useCameraPlane);
+
+		int lastSection = m_rayCastSecFactory.get_size() - 1;
+		m_rendThreadPool.new_batch(m_rayCastSecFactory.get_size() - 1);
+
+		for (int i = 0; i < lastSection; ++i)
+		{
+			m_rendThreadPool.enqueue(&m_rayCastSectionsVec.at(i));
+		}
+		for (RayCamera* camera : m_spanCameras)
+			view_walls_spans(*camera, useCameraPlane);
+		m_rayCastSectionsVec.at(lastSection)();
+
+		while (m_rendThreadPool.is_busy())
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(0));
+		}
 	}
 	else
 	{
-		math::Mat2x2 halfFOVRotationMat = math::rotation_mat2x2(m_gameCamera.fov / 2);
-		math::Vect2 playerForwDir{ std::cos(m_playerTransform.forewardAngle), std::sin(m_playerTransform.forewardAngle) };
-		currentRayDir = playerForwDir * halfFOVRotationMat;
-		rayRotationIncrementMat = math::rotation_mat2x2(-m_gameCamera.fov / m_gameCamera.pixelWidth);
+		for (RayCamera* camera : m_spanCameras)
+			view_walls_spans(*camera, useCameraPlane);
+		if (batchColumns > 0)
+			view_walls_batch_section(0, batchColumns, useCameraPlane, 0);
 	}
 
-	for (int i = 0; i < m_gameCamera.pixelWidth; ++i)
-	{
-		//DDA
+	if (trackVisibleCells)
+		m_visibleCells.end_frame();
 
-		math::Vect2 startingPos = m_playerTransform.coordinates;
-		HitType hitMarker = HitType::Nothing;
+	m_savedRays = std::accumulate(m_sectionSavedRays.begin(), m_sectionSavedRays.end(), 0);
+	m_rayCastingTime = m_rayCastingTimer.get_time_nano();
+}
 
-		float lengthIncrementX;
-		float lengthIncrementY;
+bool GameCore::prepare_camera_walls(RayCamera& camera, bool useCameraPlane)
+{
+	const EntityTransform& transform = camera.transform;
+	const GameCameraVars& cameraVars = camera.vars;
+	const MapGrid& grid = m_gameMap.grid;
+	int cameraCellX = (int)transform.coordinates.x;
+	int cameraCellY = (int)transform.coordinates.y;
+
+	//map lookups are unchecked, rays have to start inside the map: from outside only the out of bounds area is visible
+	if (!grid.is_inside(cameraCellX, cameraCellY))
+	{
+		for (int i = 0; i < cameraVars.pixelWidth; ++i)
+			camera.rays.store(i, HitType::Oob, { 0, 0 }, 0, CellSide::Unknown, 0);
 
-		if (useCameraPlane)
+		if (is_tracking_visible_cells(camera))
 		{
-			//increment in ray length that projects in an unitaty movement (unitaryStep) in X and Y direction
-			lengthIncrementX = (1 / std::abs(currentRayDir.x));
-			lengthIncrementY = (1 / std::abs(currentRayDir.y));
+			m_visibleCells.new_frame();
+			m_visibleCells.end_frame();
 		}
-		else
+
+		camera.rayCastState.valid = false;
+		return false;
+	}
+
+	//the resident cells are the ones around the player camera, added cameras can see farther
+	camera.checkedRays = !grid.is_area_resident(cameraCellX, cameraCellY, get_map_window_radius(cameraVars));
+
+	if (camera.rayDirsFov != cameraVars.fov || camera.rayDirsWidth != cameraVars.pixelWidth)
+		build_ray_directions(camera);
+
+	int yawStep = get_yaw_step(camera);
+	RayCastState currentState{ true, transform.coordinates, transform.forewardAngle, cameraVars.fov, cameraVars.maxRenderDist, yawStep, useCameraPlane, m_mapVersion };
+
+	//rays are derived from the column index, so that every section can start from its own first column
+	if (useCameraPlane)
+	{
+		camera.viewForeward = camera.cameraVecs.forewardDirection;
+	}
+	else
+	{
+		//rays are cast at the view angle rounded to whole columns, the sprites are projected with the same one
+		float viewAngle = get_view_angle(camera, false);
+		camera.viewForeward = { std::cos(viewAngle), std::sin(viewAngle) };
+		camera.firstAngleRayDir = camera.angleRayDirsBase + yawStep;
+	}
+	camera.viewLeft = { -camera.viewForeward.y, camera.viewForeward.x };
+
+	if (cameraVars.fixedPointRays)
+	{
+		int64_t fixedViewAngle = std::llround(get_view_angle(camera, useCameraPlane) * g_fixedOne);
+		fixed_sin_cos(fixedViewAngle, camera.fixedViewForeward[1], camera.fixedViewForeward[0]);
+	}
+
+	bool reused = reuse_walls(camera, currentState);
+	camera.rayCastState = currentState;
+	return !reused;
+}
+
+bool GameCore::reuse_walls(RayCamera& camera, const RayCastState& currentState)
+{
+	const RayCastState& lastState = camera.rayCastState;
+
+	if (!lastState.valid ||
+		lastState.coordinates.x != currentState.coordinates.x || lastState.coordinates.y != currentState.coordinates.y ||
+		lastState.fov != currentState.fov || lastState.maxRenderDist != currentState.maxRenderDist ||
+		lastState.useCameraPlane != currentState.useCameraPlane || lastState.mapVersion != currentState.mapVersion)
+		return false;
+
+	//linear perspective rays only match if the camera didn't move at all
+	if (currentState.useCameraPlane)
+	{
+		if (lastState.forewardAngle != currentState.forewardAngle)
+			return false;
+		m_reusedRays += camera.vars.pixelWidth;
+		return true;
+	}
+
+	//non linear perspective: the ray of a column is the ray of the column shifted by the rotation (in columns) of the last frame.
+	//Rays are cast at the view angle rounded to whole columns, so the same table entry gives the same ray bit by bit
+	int shift = currentState.yawStep - lastState.yawStep;
+	int width = camera.vars.pixelWidth;
+
+	//recasting more columns than a section takes longer on a single thread than recasting all of them in parallel
+	//(the view angle wrapping at PI gives a shift bigger than the whole screen)
+	if (std::abs(shift) > width / m_rayCastSecFactory.get_size())
+		return false;
+
+	//fixed point rays rotate their column directions with the view
+	if (shift != 0 && camera.vars.fixedPointRays)
+		return false;
+
+	//cells seen only by the columns shifted out would be kept in the visible set
+	if (shift != 0 && is_tracking_visible_cells(camera))
+		return false;
+
+	//wall sides are projected on the whole screen at once
+	if (shift != 0 && is_using_wall_spans(camera))
+		return false;
+
+	if (shift > 0)
+	{
+		for (int i = width - 1; i >= shift; --i)
+			camera.rays.copy(i, i - shift);
+		view_walls_section(camera, 0, shift, false, 0);
+	}
+	else if (shift < 0)
+	{
+		for (int i = 0; i < width + shift; ++i)
+			camera.rays.copy(i, i - shift);
+		view_walls_section(camera, width + shift, width, false, 0);
+	}
+	m_reusedRays += width - std::abs(shift);
+	return true;
+}
+
+int GameCore::get_yaw_step(const RayCamera& camera)
+{
+	float angleIncrement = camera.vars.fov / camera.vars.pixelWidth;
+	return (int)std::lround(std::remainder(camera.transform.forewardAngle, 2 * PI) / angleIncrement);
+}
+
+float GameCore::get_view_angle(const RayCamera& camera, bool useCameraPlane)
+{
+	if (useCameraPlane)
+		return camera.transform.forewardAngle;
+	return get_yaw_step(camera) * (camera.vars.fov / camera.vars.pixelWidth);
+}
+
+void GameCore::build_ray_directions(RayCamera& camera)
+{
+	int width = camera.vars.pixelWidth;
+	float fov = camera.vars.fov;
+	float halfPlane = std::tan(fov / 2);
+	float angleIncrement = fov / width;
+
+	camera.planeRayDirs.resize(width);
+
+	//linear perspective: points of the camera plane, at unitary distance along the view direction
+	for (int i = 0; i < width; ++i)
+		camera.planeRayDirs[i] = { 1.f, halfPlane * (1.f - 2.f * i / width) };
+
+	//non linear perspective: unit vectors at a constant angle from each other. The first column of the view
+	//is at fov / 2 from the view angle, the last one width - 1 columns after it, for any view angle step in [-PI, PI]
+	int maxYawStep = (int)std::ceil(PI / angleIncrement) + 1;
+	camera.angleRayDirsBase = maxYawStep + width - 1;
+	camera.angleRayDirs.resize(2 * maxYawStep + width);
+
+	for (int i = 0; i < (int)camera.angleRayDirs.size(); ++i)
+	{
+		double angle = double(fov) / 2 + double(i - camera.angleRayDirsBase) * (double(fov) / width);
+		camera.angleRayDirs[i] = { (float)std::cos(angle), (float)std::sin(angle) };
+	}
+
+	//fixed point: only the fov is rounded, the rest is integer math
+	int64_t fixedFov = std::llround(fov * g_fixedOne);
+	int64_t fixedSinHalfFov = 0, fixedCosHalfFov = 0;
+	fixed_sin_cos(fixedFov / 2, fixedSinHalfFov, fixedCosHalfFov);
+	int64_t fixedHalfPlane = (fixedSinHalfFov * g_fixedOne) / fixedCosHalfFov;
+
+	camera.fixedPlaneRayDirs.resize(width);
+	camera.fixedAngleRayDirs.resize(width);
+
+	for (int i = 0; i < width; ++i)
+	{
+		camera.fixedPlaneRayDirs[i] = { g_fixedOne, fixedHalfPlane * (width - 2 * i) / width };
+
+		int64_t sine = 0, cosine = 0;
+		fixed_sin_cos(fixedFov * (width - 2 * i) / (2 * width), sine, cosine);
+		camera.fixedAngleRayDirs[i] = { cosine, sine };
+	}
+
+	camera.rayDirsFov = fov;
+	camera.rayDirsWidth = width;
+}
+
+void GameCore::view_walls_batch_section(int startColumn, int endColumn, bool useCameraPlane, int section)
+{
+	for (std::unique_ptr<RayCamera>& camera : m_cameras)
+	{
+		if (camera->batchOffset < 0)
+			continue;
+
+		//columns of the batch covered by this camera
+		int first = std::max(startColumn, camera->batchOffset);
+		int last = std::min(endColumn, camera->batchOffset + camera->vars.pixelWidth);
+		if (first < last)
+			view_walls_section(*camera, first - camera->batchOffset, last - camera->batchOffset, useCameraPlane, section);
+	}
+}
+
+void GameCore::view_walls_section(RayCamera& camera, int startColumn, int endColumn, bool useCameraPlane, int section)
+{
+	const GameCameraVars& cameraVars = camera.vars;
+	int i = startColumn;
+
+	//fixed point walks handle checked rays themselves
+	if (cameraVars.fixedPointRays)
+	{
+		for (; i < endColumn; ++i)
+			view_walls_column_fixed(camera, i, useCameraPlane, section);
+		return;
+	}
+
+	//checked walks are only done one by one, with no skips
+	if (camera.checkedRays)
+	{
+		for (; i < endColumn; ++i)
+			view_walls_column(camera, i, useCameraPlane, section);
+		return;
+	}
+
+	if (cameraVars.raySubdivision > 1)
+	{
+		m_sectionSavedRays[section] += view_walls_section_subdivided(camera, startColumn, endColumn, useCameraPlane, section);
+		return;
+	}
+
+#ifdef RCM_X86_SIMD
+	//packets of adjacent columns, the remaining columns are cast one by one
+	if (cameraVars.rayAcceleration != RayAcceleration::None)
+	{
+		//lanes would skip different amounts of cells
+	}
+	else if (is_tracking_visible_cells(camera))
+	{
+		//packets don't report the cells they cross
+	}
+	else if (camera.raySimdLevel == utils::SimdLevel::AVX2)
+	{
+		for (; i + 8 <= endColumn; i += 8)
+			view_walls_packet_avx2(camera, i, useCameraPlane);
+	}
+	else if (camera.raySimdLevel == utils::SimdLevel::SSE2)
+	{
+		for (; i + 4 <= endColumn; i += 4)
+			view_walls_packet_sse2(camera, i, useCameraPlane);
+	}
+#endif
+
+	for (; i < endColumn; ++i)
+		view_walls_column(camera, i, useCameraPlane, section);
+}
+
+void GameCore::init_dda_ray(const math::Vect2& startingPos, const math::Vect2& currentRayDir, DDARay& ray) const
+{
+	//increment in ray length that projects in an unitaty movement (unitaryStep) in X and Y direction.
+	//Lengths are in units of the direction: euclidean for the unit rays of the non linear perspective
+	ray.lengthIncrementX = (1 / std::abs(currentRayDir.x));
+	ray.lengthIncrementY = (1 / std::abs(currentRayDir.y));
+	//axis aligned rays would have infinite increments, and lengths computed as 0 * inf would be nan
+	ray.lengthIncrementX = std::min(ray.lengthIncrementX, g_maxLengthIncrement);
+	ray.lengthIncrementY = std::min(ray.lengthIncrementY, g_maxLengthIncrement);
+
+	//same as currentRay but rounded to int 
+	ray.posInMap[0] = (int)startingPos.x;
+	ray.posInMap[1] = (int)startingPos.y;
+
+	//initialize steps so they match the ray direction
+	//also take care of the first shorter not unitary step
+	if (currentRayDir.x < 0)
+	{
+		ray.unitaryStepX = -1;
+		ray.firstLengthX = (startingPos.x - ray.posInMap[0]) * ray.lengthIncrementX;
+	}
+	else
+	{
+		ray.unitaryStepX = 1;
+		ray.firstLengthX = (float(ray.posInMap[0]) + (1 - startingPos.x)) * ray.lengthIncrementX;
+	}
+	if (currentRayDir.y < 0)
+	{
+		ray.unitaryStepY = -1;
+		ray.firstLengthY = (startingPos.y - ray.posInMap[1]) * ray.lengthIncrementY;
+	}
+	else
+	{
+		ray.unitaryStepY = 1;
+		ray.firstLengthY = (float(ray.posInMap[1]) + (1 - startingPos.y)) * ray.lengthIncrementY;
+	}
+}
+
+void GameCore::store_dda_ray(RayCamera& camera, int column, const math::Vect2& currentRayDir, const DDARay& ray, HitType hitMarker, CellSide lastSideChecked)
+{
+	//Length at the last intersection crossed, the one that reached inside a solid cell.
+	float rayLength = ray.last_length(lastSideChecked);
+
+	store_ray(camera, column, currentRayDir * rayLength, rayLength, hitMarker, lastSideChecked);
+}
+
+void GameCore::store_ray(RayCamera& camera, int column, const math::Vect2& hitPos, float rayLength, HitType hitMarker, CellSide lastSideChecked)
+{
+	//the hit is on a horizontal side when the last intersection was on the y axis
+	float posOnWallSide = (lastSideChecked == CellSide::Hori)
+		? hitPos.x + camera.transform.coordinates.x
+		: hitPos.y + camera.transform.coordinates.y;
+	posOnWallSide -= std::floor(posOnWallSide);
+
+	camera.rays.store(column, hitMarker, hitPos, rayLength, lastSideChecked, posOnWallSide);
+}
+
+void GameCore::view_walls_column(RayCamera& camera, int column, bool useCameraPlane, int section, RayPath* path)
+{
+	//DDA
+
+	math::Vect2 currentRayDir = get_ray_direction(camera, column, useCameraPlane);
+
+	DDARay ray;
+	init_dda_ray(camera.transform.coordinates, currentRayDir, ray);
+
+	//keeps track of what was the last cell side checked
+	CellSide lastSideChecked = CellSide::Unknown;
+	HitType hitMarker = HitType::Nothing;
+	if (camera.checkedRays)
+	{
+		hitMarker = trace_dda_ray_checked(ray, camera.vars.maxRenderDist, lastSideChecked);
+	}
+	else
+	{
+		VisibleCells* visibleCells = is_tracking_visible_cells(camera) ? &m_visibleCells : nullptr;
+		hitMarker = trace_dda_ray(ray, camera.vars.maxRenderDist, lastSideChecked, camera.vars.rayAcceleration, visibleCells, section, path);
+	}
+
+	store_dda_ray(camera, column, currentRayDir, ray, hitMarker, lastSideChecked);
+
+	if (path != nullptr)
+	{
+		path->hitMarker = hitMarker;
+		path->lastSideChecked = lastSideChecked;
+		path->stepsX = ray.stepsX;
+		path->stepsY = ray.stepsY;
+		path->unitaryStepX = ray.unitaryStepX;
+		path->unitaryStepY = ray.unitaryStepY;
+		path->length = ray.last_length(lastSideChecked);
+	}
+}
+
+int GameCore::view_walls_section_subdivided(RayCamera& camera, int startColumn, int endColumn, bool useCameraPlane, int section)
+{
+	int savedRays = 0;
+
+	int leftColumn = startColumn;
+	RayPath leftPath;
+	view_walls_column(camera, leftColumn, useCameraPlane, section, &leftPath);
+
+	while (leftColumn < endColumn - 1)
+	{
+		int rightColumn = std::min(leftColumn + camera.vars.raySubdivision, endColumn - 1);
+		RayPath rightPath;
+		view_walls_column(camera, rightColumn, useCameraPlane, section, &rightPath);
+
+		savedRays += fill_walls_span(camera, leftColumn, leftPath, rightColumn, rightPath, useCameraPlane, section);
+
+		leftColumn = rightColumn;
+		leftPath = rightPath;
+	}
+	return savedRays;
+}
+
+int GameCore::fill_walls_span(RayCamera& camera, int leftColumn, const RayPath& leftPath, int rightColumn, const RayPath& rightPath, bool useCameraPlane, int section)
+{
+	if (rightColumn - leftColumn < 2)
+		return 0;
+
+	if (is_same_path(camera, leftPath, rightPath))
+	{
+		//the walk of the rays in between would end in the same state: only the lengths of that state are computed,
+		//with the same operations of the walk (the cells crossed were already marked by the two ends)
+		for (int column = leftColumn + 1; column < rightColumn; ++column)
 		{
-			lengthIncrementX = std::sqrt(1 + std::pow(currentRayDir.y / currentRayDir.x, 2));
-			lengthIncrementY = std::sqrt(1 + std::pow(currentRayDir.x / currentRayDir.y, 2));
+			math::Vect2 currentRayDir = get_ray_direction(camera, column, useCameraPlane);
+
+			DDARay ray;
+			init_dda_ray(camera.transform.coordinates, currentRayDir, ray);
+			ray.stepsX = leftPath.stepsX;
+			ray.stepsY = leftPath.stepsY;
+
+			store_dda_ray(camera, column, currentRayDir, ray, leftPath.hitMarker, leftPath.lastSideChecked);
 		}
-    
-		//same as currentRay but rounded to int 
-		int currentPosInMap[2] = { (int)startingPos.x, (int)startingPos.y };
+		return rightColumn - leftColumn - 1;
+	}
+
+	int middleColumn = (leftColumn + rightColumn) / 2;
+	RayPath middlePath;
+	view_walls_column(camera, middleColumn, useCameraPlane, section, &middlePath);
+
+	return fill_walls_span(camera, leftColumn, leftPath, middleColumn, middlePath, useCameraPlane, section) +
+		fill_walls_span(camera, middleColumn, middlePath, rightColumn, rightPath, useCameraPlane, section);
+}
 
-		//length of the ray at progressive intersections with cell on the x and y axis
-		float rayLengthAtIntersectX;
-		float rayLengthAtIntersectY;
+bool GameCore::is_same_path(const RayCamera& camera, const RayPath& first, const RayPath& second) const
+{
+	//the order of the intersections changes only once between two rays (when one passes through a cell corner),
+	//so same steps and same order mean same intersections for every ray in between
+	if (first.hitMarker != second.hitMarker || first.lastSideChecked != second.lastSideChecked ||
+		first.stepsX != second.stepsX || first.stepsY != second.stepsY ||
+		first.unitaryStepX != second.unitaryStepX || first.unitaryStepY != second.unitaryStepY ||
+		first.order != second.order)
+		return false;
+
+	//rays stopped by maxRenderDist could stop at a different intersection in between
+	if (first.hitMarker == HitType::Nothing)
+		return false;
+
+	//The ratio between the lengths of an x and a y intersection only depends on the ray angle, and it changes monotonically
+	//while the rays in between turn from one end to the other (same quadrant): it is at least as far from 1 as at the closer end.
+	//Intersections compared by the ends with a gap well above the rounding of the lengths are then compared the same way
+	//by every ray in between, which crosses the same cells and computes its last length with the same operations: same rays, bit by bit.
+	//The rays in between are also not longer than the longest end (the length to a wall side is convex in the ray angle)
+	float maxLength = std::max(first.length, second.length);
+	float minGap = maxLength * g_pathMinGap;
+	return maxLength + minGap < camera.vars.maxRenderDist && std::min(first.minGap, second.minGap) > minGap;
+}
 
-		int unitaryStepX;
-		int unitaryStepY;
+void GameCore::view_walls_column_fixed(RayCamera& camera, int column, bool useCameraPlane, int section)
+{
+	//DDA on integers: only the camera position, fov and angle are rounded to fixed point, everything after is exact
+
+	const MapGrid& grid = m_gameMap.grid;
+
+	//view space direction rotated by the view axes, the left axis is (-foreward.y, foreward.x)
+	const std::array<int64_t, 2>& viewDir = useCameraPlane ? camera.fixedPlaneRayDirs[column] : camera.fixedAngleRayDirs[column];
+	const int64_t* foreward = camera.fixedViewForeward;
+	int64_t rayDir[2] = {
+		(foreward[0] * viewDir[0] - foreward[1] * viewDir[1]) / g_fixedOne,
+		(foreward[1] * viewDir[0] + foreward[0] * viewDir[1]) / g_fixedOne };
+	//rounding must not move the start out of the map
+	int64_t startingPos[2] = {
+		std::clamp<int64_t>(std::llround(camera.transform.coordinates.x * g_fixedOne), 0, grid.get_width() * g_fixedOne - 1),
+		std::clamp<int64_t>(std::llround(camera.transform.coordinates.y * g_fixedOne), 0, grid.get_height() * g_fixedOne - 1) };
+	int64_t maxLength = std::llround(camera.vars.maxRenderDist * g_fixedOne);
+
+	int posInMap[2]{};
+	int unitaryStep[2]{};
+	//length of the ray at the next intersection on each axis, and the increment between intersections
+	int64_t length[2]{};
+	int64_t lengthIncrement[2]{};
+
+	for (int axis = 0; axis < 2; ++axis)
+	{
+		posInMap[axis] = static_cast<int>(startingPos[axis] >> g_fixedShift);
+		int64_t posInCell = startingPos[axis] & (g_fixedOne - 1);
 
-		float rayLength = 0;
+		lengthIncrement[axis] = (rayDir[axis] == 0) ? g_fixedMaxIncrement : (g_fixedOne << g_fixedShift) / std::abs(rayDir[axis]);
 
-		//initialize steps so they match the ray direction
-		//also take care of the first shorter not unitary step
-		if (currentRayDir.x < 0)
+		if (rayDir[axis] < 0)
 		{
-			unitaryStepX = -1;
-			rayLengthAtIntersectX = (startingPos.x - currentPosInMap[0]) * lengthIncrementX;
+			unitaryStep[axis] = -1;
+			length[axis] = (posInCell * lengthIncrement[axis]) >> g_fixedShift;
 		}
 		else
 		{
-			unitaryStepX = 1;
-			rayLengthAtIntersectX = (float(currentPosInMap[0]) + (1 - startingPos.x)) * lengthIncrementX;
+			unitaryStep[axis] = 1;
+			length[axis] = ((g_fixedOne - posInCell) * lengthIncrement[axis]) >> g_fixedShift;
 		}
-		if (currentRayDir.y < 0)
+	}
+
+	VisibleCells* visibleCells = is_tracking_visible_cells(camera) ? &m_visibleCells : nullptr;
+
+	//the walk moves by grid indices: a step on the y axis is a whole row
+	int cellIndex = grid.index(posInMap[0], posInMap[1]);
+	const int cellStepX = unitaryStep[0];
+	const int cellStepY = unitaryStep[1] * grid.get_stride();
+	int64_t lengthX = length[0], lengthY = length[1];
+	const unsigned char* cells = grid.data();
+	//cameras away from the resident cells read each cell with a checked lookup instead
+	const bool checked = camera.checkedRays;
+
+	if (visibleCells)
+		visibleCells->mark(cellIndex, section);
+
+	HitType hitMarker = HitType::Nothing;
+	CellSide lastSideChecked = CellSide::Unknown;
+	int64_t lastLength = 0;
+
+	while (hitMarker == HitType::Nothing)
+	{
+		//X first only if strictly shorter, as in the floating point loop
+		if (lengthX < lengthY)
 		{
-			unitaryStepY = -1;
-			rayLengthAtIntersectY = (startingPos.y - currentPosInMap[1]) * lengthIncrementY;
+			if (lengthX > maxLength)
+				break;
+			cellIndex += cellStepX;
+			posInMap[0] += unitaryStep[0];
+			lastLength = lengthX;
+			lengthX += lengthIncrement[0];
+			lastSideChecked = CellSide::Vert;
 		}
 		else
 		{
-			unitaryStepY = 1;
-			rayLengthAtIntersectY = (float(currentPosInMap[1]) + (1 - startingPos.y)) * lengthIncrementY;
+			if (lengthY > maxLength)
+				break;
+			cellIndex += cellStepY;
+			posInMap[1] += unitaryStep[1];
+			lastLength = lengthY;
+			lengthY += lengthIncrement[1];
+			lastSideChecked = CellSide::Hori;
 		}
 
-		//keeps track of what was the last cell side checked
-		CellSide lastSideChecked = CellSide::Unknown;
+		//the ray starts inside the map, so it reaches the grid border before leaving it
+		if (visibleCells)
+			visibleCells->mark(cellIndex, section);
+
+		unsigned char cell = checked ? grid.at(posInMap[0], posInMap[1]) : cells[cellIndex];
+		if (MapGrid::is_solid(cell))
+			hitMarker = static_cast<HitType>(MapGrid::to_char(cell));
+	}
+
+	math::Vect2 hitPos{
+		float(rayDir[0] * lastLength / g_fixedOne) / g_fixedOne,
+		float(rayDir[1] * lastLength / g_fixedOne) / g_fixedOne };
 
-		//The ray is incremented in order to reach the next cell intersection
-		//switching axis when one side becomes shorter then the other
-		while (hitMarker == HitType::Nothing)
+	store_ray(camera, column, hitPos, float(lastLength) / g_fixedOne, hitMarker, lastSideChecked);
+}
+
+HitType GameCore::trace_dda_ray(DDARay& ray, float maxLength, CellSide& lastSideChecked, RayAcceleration acceleration, VisibleCells* visibleCells, int section, RayPath* path) const
+{
+	HitType hitMarker = HitType::Nothing;
+
+	//The ray is incremented in order to reach the next cell intersection
+	//switching axis when one side becomes shorter then the other
+	const MapGrid& grid = m_gameMap.grid;
+	//skipped cells could not be marked or recorded
+	const RayAcceleration rayAcceleration = (visibleCells || path) ? RayAcceleration::None : acceleration;
+
+	if (visibleCells)
+		visibleCells->mark(grid.index(ray.posInMap[0], ray.posInMap[1]), section);
+
+	while (hitMarker == HitType::Nothing)
+	{
+		if (rayAcceleration == RayAcceleration::DistanceField)
 		{
-			if (rayLengthAtIntersectX < rayLengthAtIntersectY)
-			{
-				if (rayLengthAtIntersectX > m_gameCamera.maxRenderDist)
-					break;
-				currentPosInMap[0] += unitaryStepX;
-				lastSideChecked = CellSide::Vert;
-				rayLengthAtIntersectX += lengthIncrementX;
-			}
-			else
+			//cells closer than the distance from the nearest solid one are empty
+			int emptyRadius = m_distanceField.at_unchecked(ray.posInMap[0], ray.posInMap[1]) - 1;
+			if (emptyRadius > 1)
+				jump_dda_ray(ray, emptyRadius, emptyRadius, maxLength);
+		}
+		else if (rayAcceleration == RayAcceleration::Pyramid)
+		{
+			//the ray can cross the empty block up to its far sides
+			int blockShift = m_occupancyPyramid.empty_block_shift(ray.posInMap[0], ray.posInMap[1]);
+			if (blockShift != 0)
 			{
-				if (rayLengthAtIntersectY > m_gameCamera.maxRenderDist)
-					break;
-				currentPosInMap[1] += unitaryStepY;
-				lastSideChecked = CellSide::Hori;
-				rayLengthAtIntersectY += lengthIncrementY;
+				int blockMask = (1 << blockShift) - 1;
+				int maxStepsX = ray.unitaryStepX > 0 ? blockMask - (ray.posInMap[0] & blockMask) : (ray.posInMap[0] & blockMask);
+				int maxStepsY = ray.unitaryStepY > 0 ? blockMask - (ray.posInMap[1] & blockMask) : (ray.posInMap[1] & blockMask);
+				if (maxStepsX + maxStepsY > 1)
+					jump_dda_ray(ray, maxStepsX, maxStepsY, maxLength);
 			}
-			chech_position_in_map(currentPosInMap[0], currentPosInMap[1], hitMarker);
 		}
 
-		//Roll back the increment that reached inside a solid cell.
-		if (lastSideChecked == CellSide::Vert)
-			rayLength = rayLengthAtIntersectX - lengthIncrementX;
-		else 
-			rayLength = rayLengthAtIntersectY - lengthIncrementY;
+		float lengthX = ray.length_x(ray.stepsX);
+		float lengthY = ray.length_y(ray.stepsY);
 
-		m_rayInfoArr.at(i) = { hitMarker, currentRayDir * rayLength, rayLength, lastSideChecked };
+		if (path)
+		{
+			path->minGap = std::min(path->minGap, std::abs(lengthX - lengthY));
+			if (lengthX < lengthY)
+				path->order += ray.stepsY;
+		}
+
+		if (lengthX < lengthY)
+		{
+			if (lengthX > maxLength)
+				break;
+			ray.posInMap[0] += ray.unitaryStepX;
+			lastSideChecked = CellSide::Vert;
+			++ray.stepsX;
+		}
+		else
+		{
+			if (lengthY > maxLength)
+				break;
+			ray.posInMap[1] += ray.unitaryStepY;
+			lastSideChecked = CellSide::Hori;
+			++ray.stepsY;
+		}
+		//the ray starts inside the map, so it reaches the grid border before leaving it
+		int cellIndex = grid.index(ray.posInMap[0], ray.posInMap[1]);
+		if (visibleCells)
+			visibleCells->mark(cellIndex, section);
+
+		unsigned char cell = grid.data()[cellIndex];
+		if (MapGrid::is_solid(cell))
+			hitMarker = static_cast<HitType>(MapGrid::to_char(cell));
+	}
+
+	return hitMarker;
+}
+
+HitType GameCore::trace_dda_ray_checked(DDARay& ray, float maxLength, CellSide& lastSideChecked) const
+{
+	while (true)
+	{
+		float lengthX = ray.length_x(ray.stepsX);
+		float lengthY = ray.length_y(ray.stepsY);
 
-		if (useCameraPlane)
+		if (lengthX < lengthY)
 		{
-			//rotate ray for next iteration
-			currentRayDir += rayRotationIncrement;
+			if (lengthX > maxLength)
+				return HitType::Nothing;
+			ray.posInMap[0] += ray.unitaryStepX;
+			lastSideChecked = CellSide::Vert;
+			++ray.stepsX;
 		}
 		else
 		{
-			currentRayDir *= math::rotation_mat2x2(-m_gameCamera.fov / m_gameCamera.pixelWidth);
+			if (lengthY > maxLength)
+				return HitType::Nothing;
+			ray.posInMap[1] += ray.unitaryStepY;
+			lastSideChecked = CellSide::Hori;
+			++ray.stepsY;
 		}
+
+		//cells out of the map are solid Oob cells
+		unsigned char cell = m_gameMap.grid.at(ray.posInMap[0], ray.posInMap[1]);
+		if (MapGrid::is_solid(cell))
+			return static_cast<HitType>(MapGrid::to_char(cell));
 	}
 }
 
+void GameCore::jump_dda_ray(DDARay& ray, int maxStepsX, int maxStepsY, float maxLength) const
+{
+	//The plain loop merges the two sorted sequences of intersections (X first only if strictly shorter).
+	//The first intersection that leaves the area is the shorter between the (maxSteps + 1)-th on each axis,
+	//the ray is moved to the state that precedes it: every intersection before it is either skipped or counted.
+	float exitX = ray.length_x(ray.stepsX + maxStepsX);
+	float exitY = ray.length_y(ray.stepsY + maxStepsY);
+
+	//the plain loop would stop before reaching the exit, skip a smaller area
+	while ((exitX < exitY ? exitX : exitY) > maxLength)
+	{
+		maxStepsX /= 2;
+		maxStepsY /= 2;
+		if (maxStepsX == 0 && maxStepsY == 0)
+			return;
+		exitX = ray.length_x(ray.stepsX + maxStepsX);
+		exitY = ray.length_y(ray.stepsY + maxStepsY);
+	}
+
+	//number of intersections of a sequence that come before the exit, first estimated then fixed
+	//so that it matches the comparisons of the plain loop
+	auto count_before = [](auto length, float increment, float exit, bool inclusive, int first, int last) -> int
+		{
+			auto before = [&](int steps) { return inclusive ? length(steps) <= exit : length(steps) < exit; };
+
+			float estimate = (exit - length(0)) / increment;
+			int steps = first;
+			if (estimate > float(last))
+				steps = last;
+			else if (estimate > float(first))
+				steps = int(estimate);
+
+			while (steps > first && !before(steps - 1))
+				--steps;
+			while (steps < last && before(steps))
+				++steps;
+			return steps;
+		};
+
+	int stepsX = 0, stepsY = 0;
+	if (exitX < exitY)
+	{
+		stepsX = ray.stepsX + maxStepsX;
+		stepsY = count_before([&ray](int steps) { return ray.length_y(steps); }, ray.lengthIncrementY, exitX, true, ray.stepsY, ray.stepsY + maxStepsY);
+	}
+	else
+	{
+		stepsY = ray.stepsY + maxStepsY;
+		stepsX = count_before([&ray](int steps) { return ray.length_x(steps); }, ray.lengthIncrementX, exitY, false, ray.stepsX, ray.stepsX + maxStepsX);
+	}
+
+	ray.posInMap[0] += (stepsX - ray.stepsX) * ray.unitaryStepX;
+	ray.posInMap[1] += (stepsY - ray.stepsY) * ray.unitaryStepY;
+	ray.stepsX = stepsX;
+	ray.stepsY = stepsY;
+}
+
+void GameCore::check_lines_of_sight(const std::vector<SightQuery>& queries, std::vector<SightResult>& results)
+{
+	int queriesNumber = static_cast<int>(queries.size());
+	results.resize(queries.size());
+
+	//small batches take less than waking up the workers
+	if (queriesNumber < g_minParallelSightQueries * m_sightSecFactory.get_size())
+	{
+		check_lines_of_sight_section(0, queriesNumber, queries, results);
+		return;
+	}
+
+	m_sightSecFactory.set_task_number(queriesNumber);
+	m_sightSecFactory.set_queries(&queries, &results);
+	m_sightSectionsVec.clear();
+	for (int i = 0; i < m_sightSecFactory.get_size(); ++i)
+		m_sightSectionsVec.push_back(m_sightSecFactory.create_section(i));
+
+	int lastSection = m_sightSecFactory.get_size() - 1;
+	m_rendThreadPool.new_batch(m_sightSecFactory.get_size() - 1);
+
+	for (int i = 0; i < lastSection; ++i)
+	{
+		m_rendThreadPool.enqueue(&m_sightSectionsVec.at(i));
+	}
+	m_sightSectionsVec.at(lastSection)();
+
+	while (m_rendThreadPool.is_busy())
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(0));
+	}
+
+	m_sightSecFactory.set_queries(nullptr, nullptr);
+}
+
+void GameCore::check_lines_of_sight_section(int start, int end, const std::vector<SightQuery>& queries, std::vector<SightResult>& results) const
+{
+	for (int i = start; i < end; ++i)
+		results[i] = check_line_of_sight(queries[i]);
+}
+
+SightResult GameCore::check_line_of_sight(const SightQuery& query) const
+{
+	const MapGrid& grid = m_gameMap.grid;
+
+	//rays walk the grid unchecked, they must start inside the map (false if the grid is not loaded yet)
+	if (!grid.is_inside((int)query.from.x, (int)query.from.y))
+		return { false, HitType::Oob, 0 };
+
+	if (MapGrid::is_solid(grid.at((int)query.from.x, (int)query.from.y)))
+		return { false, static_cast<HitType>(MapGrid::to_char(grid.at((int)query.from.x, (int)query.from.y))), 0 };
+
+	math::Vect2 segment = query.to - query.from;
+	float segmentLength = segment.Length();
+	if (segmentLength == 0)
+		return { true, HitType::Nothing, 0 };
+
+	//unit direction, so that ray lengths are distances
+	DDARay ray;
+	init_dda_ray(query.from, segment / segmentLength, ray);
+
+	//segments that leave the resident cells (chunked maps) are walked through checked lookups
+	bool resident = grid.is_resident((int)query.from.x, (int)query.from.y) && grid.is_resident((int)query.to.x, (int)query.to.y);
+
+	CellSide lastSideChecked = CellSide::Unknown;
+	HitType hitMarker = resident
+		? trace_dda_ray(ray, segmentLength, lastSideChecked, m_gameCamera.rayAcceleration, nullptr, 0)
+		: trace_dda_ray_checked(ray, segmentLength, lastSideChecked);
+
+	if (hitMarker == HitType::Nothing)
+		return { true, HitType::Nothing, segmentLength };
+	else
+		return { false, hitMarker, ray.last_length(lastSideChecked) };
+}
+
 void GameCore::view_billboards(bool useCameraPlane)
 {
+	const RayCamera& playerCamera = *m_cameras.front();
+	bool trackVisibleCells = is_tracking_visible_cells(playerCamera);
+
 	for (std::unique_ptr<IEntity>& entity : m_entities)
 	{
 		if(entity->get_active())
 		{
-			math::Vect2 rayToCamera = entity->m_transform.coordinates - m_playerTransform.coordinates;
-			float euclideanRayLength = rayToCamera.Length();
-
-			//relative to camera foreward view
-			float entityRelativeAngle = m_playerTransform.forewardAngle - math::vec_to_rad(rayToCamera);
-			if (entityRelativeAngle >= PI)
-				entityRelativeAngle -= 2 * PI;
-			else if (entityRelativeAngle <= -PI)
-				entityRelativeAngle += 2 * PI;
-
-			entity->m_billboard.cameraAngle = entity->m_transform.forewardAngle - math::vec_to_rad(rayToCamera);
-			if (entity->m_billboard.cameraAngle >= PI)
-				entity->m_billboard.cameraAngle -= 2 * PI;
-			else if (entity->m_billboard.cameraAngle <= -PI)
-				entity->m_billboard.cameraAngle += 2 * PI;
-
-			if (!useCameraPlane)
-			{
-				entity->m_billboard.distance = euclideanRayLength;
-
-				//mapping to screen pos
-				entity->m_billboard.positionOnScreen = (m_gameCamera.fov / 2 + (entityRelativeAngle)) / (m_gameCamera.fov) * m_gameCamera.pixelWidth;
+			entity->m_visible = project_billboard(playerCamera, entity->m_transform, useCameraPlane, entity->m_billboard);
 
-				entity->m_visible = entity->m_billboard.distance < m_gameCamera.maxRenderDist;
-			}
-			else
-			{
-				entity->m_billboard.distance = euclideanRayLength * std::cos(entityRelativeAngle);
+			//a sprite can only be seen if a wall ray reached the cells it covers
+			if (entity->m_visible && trackVisibleCells)
+				entity->m_visible = is_near_visible_cell(entity->m_transform.coordinates, 1 + int(entity->m_billboard.size / 2));
+		}
+	}
 
-				//mapping to screen pos
-				float projectionOnPlane = euclideanRayLength * std::sin(entityRelativeAngle);
-				float planeLength = std::tan(m_gameCamera.fov / 2) * 2;
+	//added cameras keep a copy of the billboards they see
+	for (size_t i = 1; i < m_cameras.size(); ++i)
+	{
+		RayCamera& camera = *m_cameras[i];
+		camera.billboards.clear();
 
-				//since rays are obtained by adding the plane position to a vertical vector: (planePos, 1) * rayLength
-				//the position on plane can be derived from the vector's x component normalized
-				float positionOnPlane = projectionOnPlane / entity->m_billboard.distance;
-				entity->m_billboard.positionOnScreen = (positionOnPlane / planeLength + 0.5f) * m_gameCamera.pixelWidth;
+		for (std::unique_ptr<IEntity>& entity : m_entities)
+		{
+			if (!entity->get_active())
+				continue;
 
-				entity->m_visible = entity->m_billboard.distance < m_gameCamera.maxRenderDist;
-			}
+			Billboard billboard = entity->m_billboard;
+			if (project_billboard(camera, entity->m_transform, useCameraPlane, billboard))
+				camera.billboards.push_back(billboard);
 		}
 	}
 }
 
+bool GameCore::project_billboard(const RayCamera& camera, const EntityTransform& entityTransform, bool useCameraPlane, Billboard& billboard)
+{
+	const math::Vect2& forewardDirection = camera.cameraVecs.forewardDirection;
+	const GameCameraVars& cameraVars = camera.vars;
+
+	math::Vect2 rayToCamera = entityTransform.coordinates - camera.transform.coordinates;
+	float rayAngle = math::vec_to_rad(rayToCamera);
+
+	billboard.cameraAngle = entityTransform.forewardAngle - rayAngle;
+	if (billboard.cameraAngle >= PI)
+		billboard.cameraAngle -= 2 * PI;
+	else if (billboard.cameraAngle <= -PI)
+		billboard.cameraAngle += 2 * PI;
+
+	if (!useCameraPlane)
+	{
+		//relative to camera foreward view, the one the wall rays were cast with
+		float entityRelativeAngle = get_view_angle(camera, false) - rayAngle;
+		if (entityRelativeAngle >= PI)
+			entityRelativeAngle -= 2 * PI;
+		else if (entityRelativeAngle <= -PI)
+			entityRelativeAngle += 2 * PI;
+
+		billboard.distance = rayToCamera.Length();
+
+		//mapping to screen pos (window columns, the render width only changes the rays)
+		billboard.positionOnScreen = (cameraVars.fov / 2 + (entityRelativeAngle)) / (cameraVars.fov) * windowVars::g_windowWidth;
+	}
+	else
+	{
+		float planeLength = std::tan(cameraVars.fov / 2) * 2;
+
+		//components of the ray along the view direction and along the plane (to the right)
+		billboard.distance = rayToCamera.x * forewardDirection.x + rayToCamera.y * forewardDirection.y;
+		float projectionOnPlane = rayToCamera.x * forewardDirection.y - rayToCamera.y * forewardDirection.x;
+
+		//since rays are obtained by adding the plane position to a vertical vector: (planePos, 1) * rayLength
+		//the position on plane can be derived from the vector's x component normalized
+		float positionOnPlane = projectionOnPlane / billboard.distance;
+		billboard.positionOnScreen = (positionOnPlane / planeLength + 0.5f) * windowVars::g_windowWidth;
+	}
+
+	return billboard.distance < cameraVars.maxRenderDist;
+}
+
+bool GameCore::is_near_visible_cell(const math::Vect2& pos, int radius) const
+{
+	int cellX = (int)std::floor(pos.x);
+	int cellY = (int)std::floor(pos.y);
+
+	for (int y = cellY - radius; y <= cellY + radius; ++y)
+		for (int x = cellX - radius; x <= cellX + radius; ++x)
+			if (m_visibleCells.is_visible(x, y))
+				return true;
+	return false;
+}
+
 bool GameCore::move_entity_with_collisions_entity_space(EntityTransform& transform, float front, float latereal, float rotation, float collisionSize)
 {
 	bool hasMoved = false;
@@ -1,9 +1,14 @@
 #include <math.h>
 #include <stdexcept>
-#include <queue>
 #include <cassert>
+#include <cstring>
+#include <algorithm>
 #include "gameGraphics.hpp"
 
+#ifdef RCM_X86_SIMD
+#include <emmintrin.h>
+#endif
+
 using namespace windowVars;
 using namespace rcm;
 
@@ -11,11 +16,23 @@ using namespace rcm;
 
 void GameView::create(int width, int height, bool createPixelArray = false)
 {
+    m_width = width;
+    m_height = height;
     m_hasPixelArray = createPixelArray;
     if (createPixelArray)
         m_pixels = new sf::Uint8[width * height * 4];
-    m_texture.create(width, height);
-    m_sprite.setTexture(m_texture);
+}
+
+void GameView::draw(sf::RenderTarget& target)
+{
+    //the sprite takes the size of the texture it is given first
+    if (m_texture.getSize() != sf::Vector2u(m_width, m_height))
+    {
+        m_texture.create(m_width, m_height);
+        m_sprite.setTexture(m_texture, true);
+    }
+    m_texture.update(m_pixels);
+    target.draw(m_sprite, sf::BlendNone);
 }
 
 inline GameView::GameView(int width, int height, bool createPixelArray = false)
@@ -25,7 +42,7 @@ inline GameView::GameView(int width, int height, bool createPixelArray = false)
 
 //---------------------------TEXTURE------
 
-void Texture::create(const std::string& filePath)
+void Texture::create(const std::string& filePath, bool columnMajor, bool mipmaps)
 {
     m_image.loadFromFile(filePath);
     if (m_image.getSize() == sf::Vector2u(0, 0))
@@ -34,7 +51,134 @@ void Texture::create(const std::string& filePath)
         err.append(filePath);
         throw std::invalid_argument(err);
     }
+    init_pixels(columnMajor);
+
+    m_mips.clear();
+    if (mipmaps)
+        create_mips(columnMajor);
+}
+
+void Texture::init_pixels(bool columnMajor)
+{
     m_texturePixels = m_image.getPixelsPtr();
+
+    m_hasClearPixels = false;
+    for (int i = 3; i < width() * height() * 4 && !m_hasClearPixels; i += 4)
+        m_hasClearPixels = m_texturePixels[i] == 0;
+
+    m_powerOfTwoHeight = (height() & (height() - 1)) == 0;
+
+    m_columnPixels.clear();
+    if (columnMajor)
+    {
+        m_columnPixels.resize(width() * height() * 4);
+        for (int u = 0; u < width(); ++u)
+            for (int v = 0; v < height(); ++v)
+                std::memcpy(m_columnPixels.data() + (u * height() + v) * 4, m_texturePixels + (v * width() + u) * 4, 4);
+    }
+}
+
+void Texture::create_mips(bool columnMajor)
+{
+    const Texture* level = this;
+
+    while (level->width() >= 2 && level->height() >= 2)
+    {
+        int mipWidth = level->width() / 2;
+        int mipHeight = level->height() / 2;
+        std::vector<sf::Uint8> pixels(mipWidth * mipHeight * 4, 0);
+
+        //every texel is the average of a 2x2 block of the previous level. Clear texels are left out of the average,
+        //the texel is clear if most of the block is
+        for (int v = 0; v < mipHeight; ++v)
+        {
+            for (int u = 0; u < mipWidth; ++u)
+            {
+                int sum[3]{};
+                int opaque = 0;
+
+                for (int i = 0; i < 4; ++i)
+                {
+                    const sf::Uint8* texel = level->m_texturePixels + ((v * 2 + i / 2) * level->width() + u * 2 + i % 2) * 4;
+                    if (texel[3] == 0)
+                        continue;
+                    sum[0] += texel[0];
+                    sum[1] += texel[1];
+                    sum[2] += texel[2];
+                    ++opaque;
+                }
+
+                if (opaque < 2)
+                    continue;
+
+                sf::Uint8* texel = pixels.data() + (v * mipWidth + u) * 4;
+                texel[0] = sum[0] / opaque;
+                texel[1] = sum[1] / opaque;
+                texel[2] = sum[2] / opaque;
+                texel[3] = 0xFF;
+            }
+        }
+
+        std::unique_ptr<Texture> mip = std::make_unique<Texture>();
+        mip->m_image.create(mipWidth, mipHeight, pixels.data());
+        mip->init_pixels(columnMajor);
+        level = mip.get();
+        m_mips.push_back(std::move(mip));
+    }
+}
+
+const Texture& Texture::get_mip(int level) const
+{
+    if (level <= 0 || m_mips.empty())
+        return *this;
+    return *m_mips[std::min(level, (int)m_mips.size()) - 1];
+}
+
+int Texture::get_mip_for_step(float texelStep) const
+{
+    int level = 0;
+    while (texelStep >= 2.f && level < (int)m_mips.size())
+    {
+        texelStep /= 2;
+        ++level;
+    }
+    return level;
+}
+
+//---------------------------WALL-COLUMNS---
+
+void WallColumns::create(int columns, int viewHeight)
+{
+    height = viewHeight;
+    columnSize = height * 4;
+    pixels.assign(columns * columnSize, 0);
+    start.assign(columns, 0);
+    end.assign(columns, 0);
+    masked.assign(columns, 0);
+    mask.assign(columns * height, 0);
+}
+
+//---------------------------SPRITE-COVERAGE---
+
+void SpriteCoverage::create(int width, int height)
+{
+    columnSize = height;
+    stamps.assign(width * height, 0);
+    coveredStart.assign(width, 0);
+    coveredEnd.assign(width, 0);
+    stamp = 0;
+}
+
+void SpriteCoverage::next_batch()
+{
+    //stamps of old batches are cleared only when they are about to be reused
+    if (++stamp == 0)
+    {
+        std::fill(stamps.begin(), stamps.end(), 0);
+        stamp = 1;
+    }
+    std::fill(coveredStart.begin(), coveredStart.end(), 0);
+    std::fill(coveredEnd.begin(), coveredEnd.end(), 0);
 }
 const sf::Uint8& Texture::get_pixel_at(int index) const
 {
@@ -62,10 +206,10 @@ void ViewRendSectionFactory::ViewRendSection::operator()() const
     if (m_start == m_end)
         return;
 
-    GameGraphics::draw_view_section(m_start, m_end, m_source->m_state->isLinearPersp, *(m_source->m_rays), *(m_source->m_view), *(m_source->m_graphVars), *(m_source->m_staticTex), *(m_source->m_camTransform));
+    GameGraphics::draw_view_section(m_start, m_end, m_source->m_state->isLinearPersp, *(m_source->m_rays), *(m_source->m_view), m_source->m_columns, *(m_source->m_graphVars), *(m_source->m_background), *(m_source->m_staticTex), *(m_source->m_camTransform));
 }
 
-void ViewRendSectionFactory::set_target(const RayInfoArr* rays, GameView* view, const StaticTextures* tex, const GameStateVars* state, const GraphicsVars* graphVars, const EntityTransform* camTransform)
+void ViewRendSectionFactory::set_target(const RayInfoArr* rays, GameView* view, const StaticTextures* tex, const GameStateVars* state, const GraphicsVars* graphVars, const EntityTransform* camTransform, const BackgroundRows* background)
 {
     m_rays = rays; 
     m_view = view;
@@ -73,6 +217,8 @@ void ViewRendSectionFactory::set_target(const RayInfoArr* rays, GameView* view,
     m_state = state;
     m_graphVars = graphVars;
     m_camTransform = camTransform;
+    m_background = background;
+    m_columns.create(m_rays->get_capacity(), m_view->m_height);
 }
 
 ViewRendSectionFactory::ViewRendSection ViewRendSectionFactory::create_section(int index)
@@ -83,24 +229,31 @@ ViewRendSectionFactory::ViewRendSection ViewRendSectionFactory::create_section(i
 
 //--background--
 
-BackgroundRendSectionFactory::BackgroundRendSection::BackgroundRendSection(int start, int end, BackgroundRendSectionFactory* source) :
-    IRenderingSection(start, end),
-    m_source(source)
-{}
-
-void BackgroundRendSectionFactory::BackgroundRendSection::operator()() const
+void FloorRowTables::update(const GraphicsVars& graphVars, int viewHeight)
 {
-    if (m_source == nullptr)
-        throw std::runtime_error("Render section called while no target was set.");
-
-    //if the section is empty do nothing
-    if (m_start == m_end)
+    if (!distance.empty() && graphVars.halfWallHeight == m_halfWallHeight && graphVars.maxSightDepth == m_maxSightDepth && viewHeight == m_viewHeight)
         return;
 
-    GameGraphics::draw_background_section(m_start, m_end, (m_source->m_state->drawSky), *(m_source->m_view), m_source->m_backgroundVars, *(m_source->m_graphVars), *(m_source->m_camera), *(m_source->m_staticTex));
+    m_halfWallHeight = graphVars.halfWallHeight;
+    m_maxSightDepth = graphVars.maxSightDepth;
+    m_viewHeight = viewHeight;
+    distance.resize(m_viewHeight / 2 + 1);
+    shading.resize(m_viewHeight / 2 + 1);
+
+    for (int y = 0; y <= m_viewHeight / 2; ++y)
+    {
+        //inverse of the formula used in draw_wall_column() to calculate wall height, witch is:
+                    //  float screenWallHeight = (viewHeight / distance) * m_gameGraphics.m_halfWallHeight;
+                    //  float floorHeight = (viewHeight - screenWallHeight) / 2;
+        distance[y] = (m_viewHeight * m_halfWallHeight) / (m_viewHeight - (2.f * y));
+
+        shading[y] = 0x0;
+        if (distance[y] <= m_maxSightDepth)
+            shading[y] = 0xFF * (1 - (distance[y] / m_maxSightDepth));
+    }
 }
 
-void BackgroundRendSectionFactory::set_target(GameView* view, const StaticTextures* tex, const GameStateVars* state, const GraphicsVars* graphVars, GameCameraView* camera)
+void BackgroundRows::set_target(GameView* view, const StaticTextures* tex, const GameStateVars* state, const GraphicsVars* graphVars, GameCameraView* camera)
 {
     m_view = view;
     m_staticTex = tex;
@@ -108,14 +261,75 @@ void BackgroundRendSectionFactory::set_target(GameView* view, const StaticTextur
     m_graphVars = graphVars;
     m_camera = camera;
     m_backgroundVars.skyPixPerCircle = (m_staticTex->skyTexture.width() / (float)(2 * PI));
-    m_backgroundVars.skyUIncrement = m_backgroundVars.skyPixPerCircle * m_camera->vars.fov / g_windowWidth;
-    m_backgroundVars.skyVIncrement = m_staticTex->skyTexture.height() / ((float)g_windowHeight / 2);
+    m_backgroundVars.skyUIncrement = m_backgroundVars.skyPixPerCircle * m_camera->vars.fov / m_view->m_width;
+    m_backgroundVars.skyVIncrement = m_staticTex->skyTexture.height() / ((float)m_view->m_height / 2);
+    m_backgroundVars.simdLevel = std::min(m_graphVars->backgroundSimdLevel, utils::get_simd_level());
+    m_backgroundVars.mipmaps = m_graphVars->mipmaps;
+    m_rows.assign(m_view->m_height, BackgroundRow());
+    m_skyColumns.assign(m_view->m_width, 0);
+    update();
 }
 
-BackgroundRendSectionFactory::BackgroundRendSection BackgroundRendSectionFactory::create_section(int index)
+void BackgroundRows::update()
 {
-    int sectionStart = m_sectionSize * index;
-    return BackgroundRendSection(sectionStart, sectionStart + get_section(index), this);
+    //graphics vars could have changed since the last frame
+    m_rowTables.update(*m_graphVars, m_view->m_height);
+
+    const StaticTextures& tex = *m_staticTex;
+    bool drawSky = m_state->drawSky;
+
+    //the algorithm operates by linear inerpolating between the left and rightmost rays cast by the camera to obtain world coordinates 
+    //that are then translated into uv space. The lenght of the rays is calculated each scanline from the corresponding screen height.
+    math::Vect2 leftmostRayDir = m_camera->vecs.forewardDirection - m_camera->vecs.plane / 2;
+    math::Vect2 rightmostRayDir = m_camera->vecs.forewardDirection + m_camera->vecs.plane / 2;
+
+    //sky texels are stepped from the leftmost column and from the top row
+    if (drawSky)
+    {
+        float skyUPos = -m_backgroundVars.skyPixPerCircle * (m_camera->transform.forewardAngle - m_camera->vars.fov / 2);
+
+        for (int x = 0; x < m_view->m_width; ++x)
+        {
+            if (skyUPos >= tex.skyTexture.width())
+                skyUPos -= tex.skyTexture.width();
+            else if (skyUPos < 0)
+                skyUPos += tex.skyTexture.width();
+
+            m_skyColumns[x] = (int)skyUPos;
+            skyUPos += m_backgroundVars.skyUIncrement;
+        }
+    }
+    float skyVPos = 0.f;
+
+    //each row of the upper half (ceiling or sky) is mirrored by one of the lower half (floor)
+    for (int y = 0; y < m_view->m_height / 2; ++y)
+    {
+        float rayLength = m_rowTables.distance[y];
+
+        //world positions are interpolated from the leftmost one, towards the right
+        BackgroundRow row;
+        row.start = m_camera->transform.coordinates + (leftmostRayDir * rayLength);
+        row.increment = ((rightmostRayDir - leftmostRayDir) * rayLength) / m_view->m_width;
+        row.shading = m_rowTables.shading[y];
+
+        //distant rows step over several texels per pixel, smaller levels keep about one
+        float worldStep = m_backgroundVars.mipmaps ? std::max(std::abs(row.increment.x), std::abs(row.increment.y)) : 0.f;
+
+        BackgroundRow& ceilingRow = m_rows[y];
+        ceilingRow = row;
+        ceilingRow.pixels = m_view->m_pixels + y * m_view->m_width * 4;
+        if (drawSky)
+            ceilingRow.skyTexels = tex.skyTexture.m_texturePixels + (int)skyVPos * tex.skyTexture.width() * 4;
+        else
+            ceilingRow.texture = &tex.ceilingTexture.get_mip(tex.ceilingTexture.get_mip_for_step(worldStep * tex.ceilingTexture.width()));
+
+        BackgroundRow& floorRow = m_rows[m_view->m_height - y - 1];
+        floorRow = row;
+        floorRow.pixels = m_view->m_pixels + (m_view->m_height - y - 1) * m_view->m_width * 4;
+        floorRow.texture = &tex.floorTexture.get_mip(tex.floorTexture.get_mip_for_step(worldStep * tex.floorTexture.width()));
+
+        skyVPos += m_backgroundVars.skyVIncrement;
+    }
 }
 
 //---sprite---
@@ -134,7 +348,7 @@ void SpriteRendSectionFactory::SpriteRendSection::operator()() const
     if (m_start == m_end)
         return;
 
-    GameGraphics::draw_sprite_section(m_start, m_end, *(m_source->m_view), m_source->m_sVars, *(m_source->m_billboard), *(m_source->m_tex), *(m_source->m_graphVars), *(m_source->m_rays));
+    GameGraphics::draw_sprite_section(m_start, m_end, *(m_source->m_view), m_source->m_sprites, *(m_source->m_rays), m_source->m_coverage);
 }
 
 void SpriteRendSectionFactory::set_environment(GameView* view, const GraphicsVars* graphVars, const RayInfoArr* rays)
@@ -142,54 +356,64 @@ void SpriteRendSectionFactory::set_environment(GameView* view, const GraphicsVar
     m_view = view;
     m_graphVars = graphVars;
     m_rays = rays;
+    m_coverage.create(m_view->m_width, m_view->m_height);
 }
 
-void SpriteRendSectionFactory::set_target(const Billboard& billboard, const Texture& billTex)
+void SpriteRendSectionFactory::add_sprite(const Billboard& billboard, const Texture& billTex)
 {
-    m_billboard = &billboard;
-    m_tex = &billTex;
+    m_sprites.emplace_back();
+    SpriteRendVars& vars = m_sprites.back();
+    vars.billboard = &billboard;
+    vars.texture = &billTex;
+
+    //billboards are placed on window columns: views of another size (added cameras) are the window scaled to their size
+    float columnScale = m_view->m_width / (float)g_windowWidth;
+    float rowScale = m_view->m_height / (float)g_windowHeight;
+    int viewHeight = m_view->m_height;
 
     //set sprite dimensions on screen
-    float wallHeight = (g_windowHeight / billboard.distance) * m_graphVars->halfWallHeight;
-    m_sVars.screenSpriteHeight = wallHeight * billboard.size;
-    m_sVars.screenSpriteWidth = m_sVars.screenSpriteHeight * (billTex.width() / (float)billTex.height());
+    float wallHeight = (viewHeight / billboard.distance) * m_graphVars->halfWallHeight;
+    vars.screenSpriteHeight = wallHeight * billboard.size;
+    vars.screenSpriteWidth = vars.screenSpriteHeight * (billTex.width() / (float)billTex.height()) * columnScale / rowScale;
 
     //from where to start drawing the sprite (sprites are drawn top to bottom)
     switch (billboard.alignment)
     {
     case SpriteAlignment::TopWindow : 
-        m_sVars.floorHeight = 0;
+        vars.floorHeight = 0;
         break;
     case SpriteAlignment::Ceiling :
-        m_sVars.floorHeight = (g_windowHeight - wallHeight) / 2;
+        vars.floorHeight = (viewHeight - wallHeight) / 2;
         break;
     case SpriteAlignment::Center:
-        m_sVars.floorHeight = (g_windowHeight - m_sVars.screenSpriteHeight) / 2;
+        vars.floorHeight = (viewHeight - vars.screenSpriteHeight) / 2;
             break;
     case SpriteAlignment::Floor:
-        m_sVars.floorHeight =
-            m_sVars.floorHeight = (g_windowHeight + wallHeight) / 2 - m_sVars.screenSpriteHeight;
+        vars.floorHeight =
+            vars.floorHeight = (viewHeight + wallHeight) / 2 - vars.screenSpriteHeight;
             break;
     case SpriteAlignment::BottomWindow:
-        m_sVars.floorHeight = g_windowHeight - m_sVars.screenSpriteHeight;
+        vars.floorHeight = viewHeight - vars.screenSpriteHeight;
             break;
     }
     
 
-    m_sVars.shade = (1 - (billboard.distance / (m_graphVars->maxSightDepth))) * 0xFF;
+    vars.shade = (1 - (billboard.distance / (m_graphVars->maxSightDepth))) * 0xFF;
 
     //set texture reading steps
-    m_sVars.texVStep = billTex.height() / m_sVars.screenSpriteHeight;
-    m_sVars.texUStep = billTex.width() / m_sVars.screenSpriteWidth;
+    vars.texVStep = billTex.height() / vars.screenSpriteHeight;
+    vars.texUStep = billTex.width() / vars.screenSpriteWidth;
 
     //set texture start and end in V dimension
-    m_sVars.textureVstart = (m_sVars.floorHeight < 0)
-        ? m_sVars.texVStep * (-m_sVars.floorHeight)
+    vars.textureVstart = (vars.floorHeight < 0)
+        ? vars.texVStep * (-vars.floorHeight)
         : 0;
-    m_sVars.screenVEnd = m_sVars.floorHeight + m_sVars.screenSpriteHeight;
+    vars.screenVEnd = vars.floorHeight + vars.screenSpriteHeight;
 
-    //set number of tasks based on width
-    set_task_number(m_sVars.screenSpriteWidth);
+    //view columns covered by the sprite
+    float positionOnScreen = billboard.positionOnScreen * columnScale;
+    vars.screenUStart = positionOnScreen - vars.screenSpriteWidth / 2;
+    vars.screenUEnd = (int)vars.screenSpriteWidth + (positionOnScreen - vars.screenSpriteWidth / 2);
 }
 
 SpriteRendSectionFactory::SpriteRendSection SpriteRendSectionFactory::create_section(int index)
@@ -198,15 +422,39 @@ SpriteRendSectionFactory::SpriteRendSection SpriteRendSectionFactory::create_sec
     return SpriteRendSection(sectionStart, sectionStart + get_section(index), this);
 }
 
+//---added-cameras---
+
+CameraViewRender::CameraViewRender(const GameCameraView& cameraView, const RayInfoArr& cameraRays, const std::vector<Billboard>& cameraBillboards, const ViewportRect& viewport, int workers) :
+    camera(cameraView),
+    rays(cameraRays),
+    billboards(cameraBillboards),
+    viewSecFactory(cameraView.vars.pixelWidth, workers),
+    spriteSecFactory(cameraView.vars.pixelWidth, workers)
+{
+    //the columns are stretched to the rectangle, the rows already fill it
+    int viewHeight = std::max(1, (int)std::lround(viewport.height * g_windowHeight));
+    view.create(camera.vars.pixelWidth, viewHeight, true);
+    view.m_sprite.setPosition(viewport.left * g_windowWidth, viewport.top * g_windowHeight);
+    view.m_sprite.setScale(viewport.width * g_windowWidth / view.m_width, viewport.height * g_windowHeight / view.m_height);
+}
+
+void CameraViewRender::update_view_sections()
+{
+    viewColumns = viewSecFactory.get_columns();
+    viewSecFactory.set_task_number(viewColumns);
+    viewSectionsVec.clear();
+    for (int i = 0; i < viewSecFactory.get_size(); ++i)
+        viewSectionsVec.push_back(viewSecFactory.create_section(i));
+}
+
 //---------------------------GAME-GRAPHICS---
 
-GameGraphics::GameGraphics(sf::RenderWindow& window, const GraphicsVars& graphicsVars) :
+GameGraphics::GameGraphics(sf::RenderWindow& window, const GraphicsVars& graphicsVars, RendThreadPool& rendThreadPool) :
     m_window(window),
     m_pathToGoal(0),
     m_minimapInfo(graphicsVars.minimapScale, graphicsVars.maxSightDepth),
-    m_rendThreadPool(utils::get_thread_number()),
+    m_rendThreadPool(rendThreadPool),
     m_viewSecFactory(g_windowWidth, m_rendThreadPool.get_size()),
-    m_backgroundSecFactory(g_windowHeight/2, m_rendThreadPool.get_size()),
     m_spriteSecFactory(g_windowWidth, m_rendThreadPool.get_size())
 {
     m_window.clear(sf::Color::Black);
@@ -218,38 +466,105 @@ GameGraphics::GameGraphics(sf::RenderWindow& window, const GraphicsVars& graphic
 void GameGraphics::create_assets(const GameAssets& gameAssets, const GameMap& gameMap, const GraphicsVars& graphicsVars, const RayInfoArr& raysInfoVec, const GameStateVars& gameState, GameCameraView& gameCamera)
 {
     m_mainView.create(g_windowWidth, g_windowHeight, true);
-    m_pathFinder = std::make_unique<PathFinder>(gameMap.width, gameMap.height, *(gameMap.cells), m_pathToGoal);
+    m_pathFinder = std::make_unique<PathFinder>(gameMap.grid, m_pathToGoal);
     m_mapSquareAsset.create(gameMap.width, gameMap.height);
 
     load_text_ui(gameAssets.fontFilePath);
     load_textures(gameAssets);
 
-    m_viewSecFactory.set_target(&raysInfoVec, &m_mainView, &m_staticTextures, &gameState, &graphicsVars, &gameCamera.transform);
-    m_backgroundSecFactory.set_target(&m_mainView, &m_staticTextures, &gameState, &graphicsVars, &gameCamera);
+    m_mainRays = &raysInfoVec;
+    m_gameState = &gameState;
+    m_graphicsVars = &graphicsVars;
+
+    m_background.set_target(&m_mainView, &m_staticTextures, &gameState, &graphicsVars, &gameCamera);
+    m_viewSecFactory.set_target(&raysInfoVec, &m_mainView, &m_staticTextures, &gameState, &graphicsVars, &gameCamera.transform, &m_background);
     m_spriteSecFactory.set_environment(&m_mainView, &graphicsVars, &raysInfoVec);
 
-    create_background_sections();
     create_view_sections();
     create_sprite_sections();
 }
 
 void GameGraphics::load_textures(const GameAssets& gameAssets)
 {
-    m_staticTextures.wallTexture.create(gameAssets.wallTexFilePath);
-    m_staticTextures.baundryTexture.create(gameAssets.boundryTexFilePath);
-    m_staticTextures.floorTexture.create(gameAssets.floorTexFilePath);
-    m_staticTextures.ceilingTexture.create(gameAssets.ceilingTexFilePath);
+    //walls are sampled along columns
+    m_staticTextures.wallTexture.create(gameAssets.wallTexFilePath, true, true);
+    m_staticTextures.baundryTexture.create(gameAssets.boundryTexFilePath, true, true);
+    m_staticTextures.floorTexture.create(gameAssets.floorTexFilePath, false, true);
+    m_staticTextures.ceilingTexture.create(gameAssets.ceilingTexFilePath, false, true);
     m_staticTextures.skyTexture.create(gameAssets.skyTexFilePath);
 }
 
-void GameGraphics::draw_view(bool linearPersp, const std::vector<std::unique_ptr<IEntity>>& entities)
+//the sprite fills the part of the target its view shows
+inline bool covers_target(const sf::Sprite& sprite, const sf::RenderTarget& target)
 {
-    render_view(linearPersp);
+    sf::FloatRect bounds = sprite.getGlobalBounds();
+    const sf::View& view = target.getView();
+    float left = view.getCenter().x - view.getSize().x / 2;
+    float top = view.getCenter().y - view.getSize().y / 2;
+    return bounds.left <= left && bounds.top <= top &&
+        bounds.left + bounds.width >= left + view.getSize().x && bounds.top + bounds.height >= top + view.getSize().y;
+}
+
+void GameGraphics::draw_view(const std::vector<std::unique_ptr<IEntity>>& entities)
+{
+    render_views(entities);
+
+    //the opaque main view hides the last frame where it covers the window, the window is only cleared if some of it is left out
+    //(as on the first frame, before the view has its texture)
+    if (!covers_target(m_mainView.m_sprite, m_window))
+        m_window.clear(sf::Color::Black);
+    m_mainView.draw(m_window);
+
+    draw_camera_views();
+}
+
+void GameGraphics::render_views(const std::vector<std::unique_ptr<IEntity>>& entities)
+{
+    render_view();
 
     render_sprites(entities);
+}
+
+const GameView& GameGraphics::get_view(int index) const
+{
+    if (index < 0 || index > (int)m_cameraViews.size())
+        throw std::invalid_argument("View selected is out of range.");
+
+    return index == 0 ? m_mainView : m_cameraViews[index - 1]->view;
+}
+
+void GameGraphics::add_camera_view(const GameCameraView& camera, const RayInfoArr& rays, const std::vector<Billboard>& billboards, const ViewportRect& viewport)
+{
+    if (m_graphicsVars == nullptr)
+        throw std::runtime_error("Camera views can only be added after the game assets are created.");
+    if (viewport.width <= 0 || viewport.height <= 0)
+        throw std::invalid_argument("Camera viewport must have a positive size.");
+
+    m_cameraViews.push_back(std::make_unique<CameraViewRender>(camera, rays, billboards, viewport, m_rendThreadPool.get_size()));
+    CameraViewRender& cameraView = *m_cameraViews.back();
+
+    cameraView.background.set_target(&cameraView.view, &m_staticTextures, m_gameState, m_graphicsVars, &cameraView.camera);
+    cameraView.viewSecFactory.set_target(&cameraView.rays, &cameraView.view, &m_staticTextures, m_gameState, m_graphicsVars, &cameraView.camera.transform, &cameraView.background);
+    cameraView.update_view_sections();
+
+    //sprites of the camera are depth tested against its own rays
+    cameraView.spriteSecFactory.set_environment(&cameraView.view, m_graphicsVars, &cameraView.rays);
+    for (int i = 0; i < cameraView.spriteSecFactory.get_size(); ++i)
+        cameraView.spriteSectionsVec.push_back(cameraView.spriteSecFactory.create_section(i));
+}
+
+void GameGraphics::remove_camera_view(int index)
+{
+    if (index < 1 || index > (int)m_cameraViews.size())
+        throw std::invalid_argument("Camera view selected is out of range.");
 
-    m_mainView.m_texture.update(m_mainView.m_pixels);
-    m_window.draw(m_mainView.m_sprite);
+    m_cameraViews.erase(m_cameraViews.begin() + index - 1);
+}
+
+void GameGraphics::draw_camera_views()
+{
+    for (std::unique_ptr<CameraViewRender>& cameraView : m_cameraViews)
+        cameraView->view.draw(m_window);
 }
 
 void GameGraphics::draw_map_gen(int mapWidth, int mapHeight, int posX, int posY, const std::string& cells)
@@ -271,12 +586,34 @@ void GameGraphics::load_sprite(int id, const std::string& texturePath)
 
 //----------------utils----------
 
-void copy_pixels(sf::Uint8 * pixelsTo, const sf::Uint8 * pixelsFrom, int indexTo, int indexFrom, sf::Uint8 alpha)
+//one 256 entry multiply table per shade level: values[shade][channel] = channel * shade / 255, rounded to nearest
+struct ShadeTable
+{
+    sf::Uint8 values[256][256];
+
+    ShadeTable()
+    {
+        for (int shade = 0; shade < 256; ++shade)
+        {
+            for (int channel = 0; channel < 256; ++channel)
+            {
+                int product = channel * shade + 128;
+                values[shade][channel] = (sf::Uint8)((product + (product >> 8)) >> 8);
+            }
+        }
+    }
+};
+
+static const ShadeTable s_shadeTable;
+
+//pixels are written opaque, already darkened by the shade (as they looked once blended over the black window)
+void copy_pixels(sf::Uint8 * pixelsTo, const sf::Uint8 * pixelsFrom, int indexTo, int indexFrom, sf::Uint8 shade)
 {
-            pixelsTo[indexTo + 0] = pixelsFrom[indexFrom + 0];
-            pixelsTo[indexTo + 1] = pixelsFrom[indexFrom + 1];
-            pixelsTo[indexTo + 2] = pixelsFrom[indexFrom + 2];
-            pixelsTo[indexTo + 3] = alpha;
+            const sf::Uint8* shadeValues = s_shadeTable.values[shade];
+            pixelsTo[indexTo + 0] = shadeValues[pixelsFrom[indexFrom + 0]];
+            pixelsTo[indexTo + 1] = shadeValues[pixelsFrom[indexFrom + 1]];
+            pixelsTo[indexTo + 2] = shadeValues[pixelsFrom[indexFrom + 2]];
+            pixelsTo[indexTo + 3] = 0xFF;
 }
 
 //----------------end-screen-----
@@ -338,60 +675,55 @@ void GameGraphics::draw_text_ui()
 
 void GameGraphics::create_view_sections()
 {
-    for (int i = 0; i < m_viewSecFactory.get_size(); ++i)
-        m_viewSectionsVec.push_back(m_viewSecFactory.create_section(i));
+    m_viewSectionsVec.resize(m_viewSecFactory.get_size());
+    update_view_sections();
 }
 
-void GameGraphics::create_background_sections()
+void GameGraphics::update_view_sections()
 {
-    for (int i = 0; i < m_backgroundSecFactory.get_size(); ++i)
-        m_backgroundSectionsVec.push_back(m_backgroundSecFactory.create_section(i));
+    m_viewColumns = m_viewSecFactory.get_columns();
+    m_viewSecFactory.set_task_number(m_viewColumns);
+    for (int i = 0; i < m_viewSecFactory.get_size(); ++i)
+        m_viewSectionsVec.at(i) = m_viewSecFactory.create_section(i);
 }
 
 void GameGraphics::create_sprite_sections()
-{
-    m_spriteSectionsVec.resize(m_spriteSecFactory.get_size());
-}
-
-void GameGraphics::update_sprite_sections()
 {
     for (int i = 0; i < m_spriteSecFactory.get_size(); ++i)
-        m_spriteSectionsVec.at(i) = m_spriteSecFactory.create_section(i);
+        m_spriteSectionsVec.push_back(m_spriteSecFactory.create_section(i));
 }
 
-void GameGraphics::render_view(bool linearPersp)
+void GameGraphics::render_view()
 {
-    int lastSection = 0;
-
-    //----background-----
-
-    if (linearPersp)
+    //the background is drawn by the view sections, from rows set up here for the camera of this frame
+    m_background.update();
+    for (std::unique_ptr<CameraViewRender>& cameraView : m_cameraViews)
+        cameraView->background.update();
+
+    //the render width can change every frame, sections are only rebuilt when it does
+    if (m_viewSecFactory.get_columns() != m_viewColumns)
+        update_view_sections();
+
+    //the sections of every view run in the same batch, the last main view section runs on this thread
+    int addedSections = 0;
+    for (const std::unique_ptr<CameraViewRender>& cameraView : m_cameraViews)
     {
-        lastSection = m_backgroundSecFactory.get_size() - 1;
-        m_rendThreadPool.new_batch(m_backgroundSecFactory.get_size() - 1);
-
-        for (int i = 0; i < lastSection; ++i)
-        {
-            m_rendThreadPool.enqueue(&m_backgroundSectionsVec.at(i));
-        }
-        {
-            BackgroundRendSectionFactory::BackgroundRendSection lastSec(m_backgroundSecFactory.create_section(lastSection));
-            lastSec();
-        }
-        while (m_rendThreadPool.is_busy())
-        {
-            std::this_thread::sleep_for(std::chrono::milliseconds(0));
-        }
+        if (cameraView->viewSecFactory.get_columns() != cameraView->viewColumns)
+            cameraView->update_view_sections();
+        addedSections += cameraView->viewSectionsVec.size();
     }
 
-    //-----main-view-----
-
-    lastSection = m_viewSecFactory.get_size() - 1;
-    m_rendThreadPool.new_batch(m_viewSecFactory.get_size() - 1);
+    int lastSection = m_viewSecFactory.get_size() - 1;
+    m_rendThreadPool.new_batch(m_viewSecFactory.get_size() - 1 + addedSections);
     for (int i = 0; i < lastSection; ++i)
     {
         m_rendThreadPool.enqueue(&m_viewSectionsVec.at(i));
     }
+    for (std::unique_ptr<CameraViewRender>& cameraView : m_cameraViews)
+    {
+        for (ViewRendSectionFactory::ViewRendSection& section : cameraView->viewSectionsVec)
+            m_rendThreadPool.enqueue(&section);
+    }
     {
         ViewRendSectionFactory::ViewRendSection lastSec(m_viewSecFactory.create_section(lastSection));
         lastSec();
@@ -404,227 +736,462 @@ void GameGraphics::render_view(bool linearPersp)
 
 
 
-void GameGraphics::draw_view_section(int startY, int endY, bool linear, const RayInfoArr& rays, GameView& view, const GraphicsVars& graphVars, const StaticTextures& tex, const EntityTransform& camTransform)
-{
-    for (int i = startY; i < endY; ++i)
-    {
-        const RayInfo& currRay = rays.const_at(i);
-        float distance = currRay.length;
+//rays drawn in a column before the group is copied to the view rows: a group of columns stays in cache between the two passes
+constexpr int g_wallColumnsGroup = 16;
 
-        //--this code version maintains correct proportions, but causes texture distortion (not compatible with other parts of the code, which use the inverse function)--
-        //float wallAngle = (std::atan(m_gameGraphics.m_halfWallHeight / distance) );
-        //float screenWallHeight = g_windowHeight  * wallAngle / (m_verticalVisibleAngle * m_gameGraphics.m_halfWallHeight);
+//nearest column stretch: a ray is drawn on every view column that samples it (column * rayColumns / viewColumns == ray)
+inline int first_view_column(int ray, int rayColumns, int viewColumns)
+{
+    return (ray * viewColumns + rayColumns - 1) / rayColumns;
+}
 
-        //--this version is faster, has easy texture mapping but locks the vertical view angle at 90 deg (45 deg up 45 deg down)--
-        float screenWallHeight = (g_windowHeight / distance) * graphVars.halfWallHeight;
-        float floorHeight = (g_windowHeight - screenWallHeight) / 2;
+void GameGraphics::draw_view_section(int startY, int endY, bool linear, const RayInfoArr& rays, GameView& view, WallColumns& columns, const GraphicsVars& graphVars, const BackgroundRows& background, const StaticTextures& tex, const EntityTransform& camTransform)
+{
+    int rayColumns = rays.get_size();
+    //on short views the copy of the columns costs more than the strided writes it saves.
+    //Stretched rays (render width below the view width) are expanded by the copy
+    bool columnMajor = view.m_height >= graphVars.columnMajorWallsMinHeight || rayColumns < view.m_width;
 
-        //alpha of walls, bleanding them with the dark backgroud 
-        sf::Uint8 boxShade = (1 - (distance / (graphVars.maxSightDepth))) * 0xFF;
+    for (int group = startY; group < endY; group += g_wallColumnsGroup)
+    {
+        int groupEnd = std::min(group + g_wallColumnsGroup, endY);
 
-        bool dontDraw = false;
-        bool flatShading = true;
-        const Texture* currentTexture;
-        sf::Color flatColor(sf::Color::Transparent);
-        switch (currRay.entityHit)
+        for (int i = group; i < groupEnd; ++i)
         {
-        case HitType::Wall:
-            currentTexture = &tex.wallTexture;
-            flatShading = false;
-            break;
-        case HitType::Baudry:
-            currentTexture = &tex.baundryTexture;
-            flatShading = false;
-            //-------flat shading example-------
-            //flatShading = true;
-            //flatColor = { 0xff, (currRay.lastSideChecked == CellSide::Hori) ? (sf::Uint8)0xff : (sf::Uint8)0x0, 0xff , boxShade };
-            break;
-        case HitType::Nothing:
-            //this occurs when sight is clear up to a distance equivalent to graphVars.maxSightDepth
-            //viable options might be to draw nothing or to draw a black wall 
-            //here nothing is drawn (works better with linear persp)
-            screenWallHeight = 0;
-            floorHeight = g_windowHeight / 2;
-            break;
-        default:
-
-            break;
+            if (columnMajor)
+                draw_wall_column(i, linear, rays, columns.column(i), 4, columns, graphVars, background.get_row_tables(), tex, camTransform);
+            else
+                draw_wall_column(i, linear, rays, view.m_pixels + i * 4, view.m_width * 4, columns, graphVars, background.get_row_tables(), tex, camTransform);
         }
 
-        sf::Color currentColor;
+        //in linear perspective floor and ceiling are only drawn on the rows the walls leave uncovered
+        if (linear)
+            draw_background_columns(group, groupEnd, rays, columns, background);
 
-        //--variables for texture navigation--
-        //relative position in wall based on what face is being textured
-        float posOnWallSide = 0;
+        if (columnMajor)
+            copy_wall_columns(group, groupEnd, rays, view, columns);
+    }
+}
 
-        int textureU = 0;
-        float textureV = 0;
-        float texVStep = 0;
+void GameGraphics::draw_wall_column(int i, bool linear, const RayInfoArr& rays, sf::Uint8* pixels, int pixelStride, WallColumns& columns, const GraphicsVars& graphVars, const FloorRowTables& rowTables, const StaticTextures& tex, const EntityTransform& camTransform)
+{
+    int viewHeight = columns.height;
+    float distance = rays.length(i);
+    CellSide side = rays.side(i);
+    const math::Vect2& hitPos = rays.hit_pos(i);
+
+    //--this code version maintains correct proportions, but causes texture distortion (not compatible with other parts of the code, which use the inverse function)--
+    //float wallAngle = (std::atan(m_gameGraphics.m_halfWallHeight / distance) );
+    //float screenWallHeight = viewHeight  * wallAngle / (m_verticalVisibleAngle * m_gameGraphics.m_halfWallHeight);
+
+    //--this version is faster, has easy texture mapping but locks the vertical view angle at 90 deg (45 deg up 45 deg down)--
+    float screenWallHeight = (viewHeight / distance) * graphVars.halfWallHeight;
+    float floorHeight = (viewHeight - screenWallHeight) / 2;
+
+    //shade of walls, darkening them towards the black of the distance
+    sf::Uint8 boxShade = (1 - (distance / (graphVars.maxSightDepth))) * 0xFF;
+
+    bool dontDraw = false;
+    bool flatShading = true;
+    const Texture* currentTexture;
+    sf::Color flatColor(sf::Color::Transparent);
+    switch (rays.hit_type(i))
+    {
+    case HitType::Wall:
+        currentTexture = &tex.wallTexture;
+        flatShading = false;
+        break;
+    case HitType::Baudry:
+        currentTexture = &tex.baundryTexture;
+        flatShading = false;
+        //-------flat shading example-------
+        //flatShading = true;
+        //flatColor = { 0xff, (side == CellSide::Hori) ? (sf::Uint8)0xff : (sf::Uint8)0x0, 0xff , boxShade };
+        break;
+    case HitType::Nothing:
+        //this occurs when sight is clear up to a distance equivalent to graphVars.maxSightDepth
+        //viable options might be to draw nothing or to draw a black wall 
+        //here nothing is drawn (works better with linear persp)
+        screenWallHeight = 0;
+        floorHeight = viewHeight / 2;
+        break;
+    default:
 
-        //dont set up texture variables if not needed 
-        if (!flatShading)
-        {
-            if (currRay.lastSideChecked == CellSide::Hori)
-                posOnWallSide = currRay.hitPos.x + camTransform.coordinates.x;
+        break;
+    }
 
-            else
-                posOnWallSide = currRay.hitPos.y + camTransform.coordinates.y;
+    sf::Color currentColor;
 
-            posOnWallSide -= std::floor(posOnWallSide);
-            texVStep = currentTexture->height() / screenWallHeight;
-            textureU = (int)(posOnWallSide * currentTexture->width());
+    //--variables for texture navigation--
+    //relative position in wall based on what face is being textured
+    float posOnWallSide = 0;
 
-            //if the wall is seen from the south or west side, its texture's u needs to be inverted 
-            if (currRay.lastSideChecked == CellSide::Hori && currRay.hitPos.y < 0 ||
-                currRay.lastSideChecked == CellSide::Vert && currRay.hitPos.x > 0)
-                textureU = currentTexture->width() - textureU - 1;
+    int textureU = 0;
+    float textureV = 0;
+    float texVStep = 0;
+    //first texel of the sampled column and distance between two of its texels
+    const sf::Uint8* texColumn = nullptr;
+    int texRowStride = 0;
+    //with a power of two height rows are wrapped by a mask, otherwise textureV is reset at the end of the texture
+    int texRowMask = 0;
+    bool wrapByMask = false;
 
-            //if the textured box is bigger then the screen (hight wise), the initial unseen part of pixels must be skipped
-            textureV = (screenWallHeight > g_windowHeight)
-                ? texVStep * ((screenWallHeight - g_windowHeight) / 2)
-                : 0;
+    //dont set up texture variables if not needed 
+    if (!flatShading)
+    {
+        //distant walls step over several texels per pixel, a smaller level keeps about one
+        if (graphVars.mipmaps)
+            currentTexture = &currentTexture->get_mip(currentTexture->get_mip_for_step(currentTexture->height() / screenWallHeight));
+
+        posOnWallSide = rays.texture_u(i);
+        texVStep = currentTexture->height() / screenWallHeight;
+        textureU = (int)(posOnWallSide * currentTexture->width());
+
+        //if the wall is seen from the south or west side, its texture's u needs to be inverted 
+        if (side == CellSide::Hori && hitPos.y < 0 ||
+            side == CellSide::Vert && hitPos.x > 0)
+            textureU = currentTexture->width() - textureU - 1;
+
+        //if the textured box is bigger then the screen (hight wise), the initial unseen part of pixels must be skipped
+        textureV = (screenWallHeight > viewHeight)
+            ? texVStep * ((screenWallHeight - viewHeight) / 2)
+            : 0;
+
+        //column major textures are read sequentially
+        if (currentTexture->has_column_major_copy())
+        {
+            texColumn = currentTexture->get_column(textureU);
+            texRowStride = 4;
+        }
+        else
+        {
+            texColumn = currentTexture->m_texturePixels + textureU * 4;
+            texRowStride = currentTexture->width() * 4;
         }
 
-        int x = i * 4;
-        //vertical scan line
-        for (int y = 0; y < g_windowHeight * 4; y += 4)
+        wrapByMask = currentTexture->has_power_of_two_height();
+        texRowMask = currentTexture->height() - 1;
+    }
+
+    sf::Uint8* mask = columns.mask.data() + i * viewHeight;
+    //in linear perspective clear texels leave the background, the rows they cover are not copied to the view
+    bool masked = linear && !flatShading && currentTexture->has_clear_pixels();
+    int startRow = viewHeight;
+    int endRow = 0;
+
+    //vertical scan line, pixel is the offset of the row in pixels
+    for (int y = 0, pixel = 0; y < viewHeight * 4; y += 4, pixel += pixelStride)
+    {
+        //in the wall range
+        if (y > floorHeight * 4 && y <= (viewHeight - floorHeight) * 4)
         {
-            //in the wall range
-            if (y > floorHeight * 4 && y <= (g_windowHeight - floorHeight) * 4)
+            if (startRow == viewHeight)
+                startRow = y / 4;
+            endRow = y / 4 + 1;
+
+            if (flatShading)
             {
-                if (flatShading)
-                {
-                    view.m_pixels[y * g_windowWidth + x] = flatColor.r;
-                    view.m_pixels[y * g_windowWidth + x + 1] = flatColor.g;
-                    view.m_pixels[y * g_windowWidth + x + 2] = flatColor.b;
-                    view.m_pixels[y * g_windowWidth + x + 3] = flatColor.a;
-                }
+                const sf::Uint8* shadeValues = s_shadeTable.values[flatColor.a];
+                pixels[pixel] = shadeValues[flatColor.r];
+                pixels[pixel + 1] = shadeValues[flatColor.g];
+                pixels[pixel + 2] = shadeValues[flatColor.b];
+                pixels[pixel + 3] = 0xFF;
+            }
+            else
+            {
+                int textureRow;
+                if (wrapByMask)
+                    textureRow = int(textureV) & texRowMask;
                 else
                 {
                     //if the end of the texture is reached, start over
                     if (textureV >= currentTexture->height())
                         textureV = 0;
+                    textureRow = int(textureV);
+                }
 
-                    int viewPixel = (y * g_windowWidth + x);
-                    int texturePixel = (textureU + int(textureV) * currentTexture->width()) * 4;
+                const sf::Uint8* texel = texColumn + textureRow * texRowStride;
 
-                    if(!linear || !(currentTexture->m_texturePixels[texturePixel + 3] == 0))
-                        copy_pixels(view.m_pixels, currentTexture->m_texturePixels, viewPixel, texturePixel, boxShade);
+                bool drawn = !linear || !(texel[3] == 0);
+                if (drawn)
+                    copy_pixels(pixels, texel, pixel, 0, boxShade);
+                if (masked)
+                    mask[y / 4] = drawn;
 
-                    textureV += texVStep;
-                }
+                textureV += texVStep;
             }
-            else if (!linear && y <= floorHeight * 4)
-            {
-
-                float rayLength = (g_windowHeight * graphVars.halfWallHeight) / (g_windowHeight - (0.5f * y));
-                math::Vect2 xyPos = camTransform.coordinates + ((currRay.hitPos) / currRay.length) * rayLength;
-                int uvPos[2]{};
+        }
+        else if (!linear && y <= floorHeight * 4)
+        {
+            math::Vect2 xyPos = camTransform.coordinates + (hitPos / distance) * rowTables.distance[y / 4];
+            int uvPos[2]{};
 
-                //ceiling
-                uvPos[0] = std::abs((int)((xyPos.x - int(xyPos.x)) * tex.ceilingTexture.width()));
-                uvPos[1] = std::abs((int)((xyPos.y - int(xyPos.y)) * tex.ceilingTexture.height()));
+            //ceiling
+            uvPos[0] = std::abs((int)((xyPos.x - int(xyPos.x)) * tex.ceilingTexture.width()));
+            uvPos[1] = std::abs((int)((xyPos.y - int(xyPos.y)) * tex.ceilingTexture.height()));
 
-                int viewPixel = (y * g_windowWidth + x);
-                int texturePixel = (uvPos[1] * tex.ceilingTexture.width() + uvPos[0]) * 4;
+            int texturePixel = (uvPos[1] * tex.ceilingTexture.width() + uvPos[0]) * 4;
 
-                copy_pixels(view.m_pixels, tex.ceilingTexture.m_texturePixels, viewPixel, texturePixel, 0xFF);
+            copy_pixels(pixels, tex.ceilingTexture.m_texturePixels, pixel, texturePixel, 0xFF);
 
-                //floor
-                uvPos[0] = std::abs((int)((xyPos.x - int(xyPos.x)) * tex.floorTexture.width()));
-                uvPos[1] = std::abs((int)((xyPos.y - int(xyPos.y)) * tex.floorTexture.height()));
+            //floor
+            uvPos[0] = std::abs((int)((xyPos.x - int(xyPos.x)) * tex.floorTexture.width()));
+            uvPos[1] = std::abs((int)((xyPos.y - int(xyPos.y)) * tex.floorTexture.height()));
 
-                viewPixel = (g_windowHeight * 4 - y - 4) * g_windowWidth + x;
-                texturePixel = (uvPos[1] * tex.floorTexture.width() + uvPos[0]) * 4;
+            texturePixel = (uvPos[1] * tex.floorTexture.width() + uvPos[0]) * 4;
 
-                copy_pixels(view.m_pixels, tex.floorTexture.m_texturePixels, viewPixel, texturePixel, 0xFF);
-            }
+            copy_pixels(pixels, tex.floorTexture.m_texturePixels, (viewHeight - 1 - y / 4) * pixelStride, texturePixel, 0xFF);
         }
     }
+
+    //out of linear perspective ceiling and floor fill the rows around the wall
+    if (!linear)
+    {
+        startRow = 0;
+        endRow = viewHeight;
+    }
+    columns.start[i] = startRow;
+    columns.end[i] = endRow;
+    columns.masked[i] = masked;
 }
 
+void GameGraphics::copy_wall_columns(int startRay, int endRay, const RayInfoArr& rays, GameView& view, const WallColumns& columns)
+{
+    int rayColumns = rays.get_size();
+    int groupSize = endRay - startRay;
+    int viewWidth = view.m_width;
+
+    //local copies: the byte writes to the view could alias the vectors of columns, forcing a reload of each one at every pixel
+    int screenStart[g_wallColumnsGroup + 1];
+    int startRows[g_wallColumnsGroup];
+    int endRows[g_wallColumnsGroup];
+    const sf::Uint8* pixels[g_wallColumnsGroup];
+    const sf::Uint8* masks[g_wallColumnsGroup];
+
+    //rows written by at least one column of the group
+    int startRow = columns.height;
+    int endRow = 0;
+
+    for (int i = 0; i <= groupSize; ++i)
+    {
+        screenStart[i] = first_view_column(startRay + i, rayColumns, viewWidth);
+        if (i == groupSize)
+            break;
 
-//----------------background--
+        int ray = startRay + i;
+        startRows[i] = columns.start[ray];
+        endRows[i] = columns.end[ray];
+        pixels[i] = columns.pixels.data() + ray * columns.columnSize;
+        masks[i] = columns.masked[ray] ? columns.mask.data() + ray * columns.height : nullptr;
 
- void GameGraphics::draw_background_section(int startX, int endX, bool drawSky, GameView& view, const BackgroundVars& bgVars, const GraphicsVars& windowVars, GameCameraView& camera, const StaticTextures& tex)
-{
-    //the algorithm operates by linear inerpolating between the left and rightmost rays cast by the camera to obtain world coordinates 
-    //that are then translated into uv space. The lenght of the rays is calculated each scanline from the corresponding screen height.
-    // 
-    //ceiling vars
-    math::Vect2 leftmostRayDir = camera.vecs.forewardDirection - camera.vecs.plane / 2;
-    math::Vect2 rightmostRayDir = camera.vecs.forewardDirection + camera.vecs.plane / 2;
+        startRow = std::min(startRow, startRows[i]);
+        endRow = std::max(endRow, endRows[i]);
+    }
 
-    //sky vars
-    float skyUStart = -bgVars.skyPixPerCircle * (camera.transform.forewardAngle - camera.vars.fov / 2);
-    float skyVPos = bgVars.skyVIncrement * startX;
+    //rows copied as 4x4 blocks of pixels, none if empty
+    int blockStart = 0;
+    int blockEnd = 0;
 
-    for (int y = startX; y < endX; ++y)
+#ifdef RCM_X86_SIMD
+    //rows covered by every column of the group, with one view column per ray and no clear texels, are transposed 4x4 pixels at a time
+    bool blocks = groupSize % 4 == 0 && screenStart[groupSize] - screenStart[0] == groupSize;
+    for (int i = 0; i < groupSize && blocks; ++i)
+        blocks = masks[i] == nullptr;
+
+    if (blocks)
     {
-        //inverse of the formula used in draw_view() to calculate wall height, witch is:
-                    //  float screenWallHeight = (g_windowHeight / distance) * m_gameGraphics.m_halfWallHeight;
-                    //  float floorHeight = (g_windowHeight - screenWallHeight) / 2;
-        float rayLength = (g_windowHeight * windowVars.halfWallHeight) / (g_windowHeight - (2.f * y));
+        blockStart = *std::max_element(startRows, startRows + groupSize);
+        blockEnd = *std::min_element(endRows, endRows + groupSize);
+        blockEnd = (blockEnd > blockStart) ? blockStart + (blockEnd - blockStart) / 4 * 4 : blockStart;
+    }
 
-        //increment for interpolation
-        math::Vect2 xyIncrement = ((rightmostRayDir - leftmostRayDir) * rayLength) / g_windowWidth;
+    for (int row = blockStart; row < blockEnd; row += 4)
+    {
+        sf::Uint8* viewRow = view.m_pixels + (row * viewWidth + screenStart[0]) * 4;
+
+        for (int i = 0; i < groupSize; i += 4)
+        {
+            //4 rows of 4 columns
+            __m128i column0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels[i] + row * 4));
+            __m128i column1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels[i + 1] + row * 4));
+            __m128i column2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels[i + 2] + row * 4));
+            __m128i column3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels[i + 3] + row * 4));
+
+            __m128i rows01Low = _mm_unpacklo_epi32(column0, column1);
+            __m128i rows01High = _mm_unpacklo_epi32(column2, column3);
+            __m128i rows23Low = _mm_unpackhi_epi32(column0, column1);
+            __m128i rows23High = _mm_unpackhi_epi32(column2, column3);
+
+            sf::Uint8* block = viewRow + i * 4;
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(block), _mm_unpacklo_epi64(rows01Low, rows01High));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(block + viewWidth * 4), _mm_unpackhi_epi64(rows01Low, rows01High));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(block + viewWidth * 8), _mm_unpacklo_epi64(rows23Low, rows23High));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(block + viewWidth * 12), _mm_unpackhi_epi64(rows23Low, rows23High));
+        }
+    }
+#endif
+
+    //each view row is written once per group, reading one pixel from each column
+    for (int row = startRow; row < endRow; ++row)
+    {
+        if (row == blockStart && blockEnd > blockStart)
+        {
+            row = blockEnd - 1;
+            continue;
+        }
 
-        //start from the left, interpolete towards the right 
-        math::Vect2 worldPosLeft = camera.transform.coordinates + (leftmostRayDir * rayLength);
-        math::Vect2 xyPos = worldPosLeft;
-        int uvPos[2]{};
+        sf::Uint8* viewRow = view.m_pixels + row * viewWidth * 4;
 
-        sf::Uint8 shading = 0x0;
+        for (int i = 0; i < groupSize; ++i)
+        {
+            if (row < startRows[i] || row >= endRows[i] || (masks[i] != nullptr && !masks[i][row]))
+                continue;
 
-        if (rayLength <= windowVars.maxSightDepth)
-            shading = 0xFF * (1 - (rayLength / windowVars.maxSightDepth));
+            sf::Uint32 pixel;
+            std::memcpy(&pixel, pixels[i] + row * 4, 4);
+            for (int x = screenStart[i]; x < screenStart[i + 1]; ++x)
+                std::memcpy(viewRow + x * 4, &pixel, 4);
+        }
+    }
+}
 
-        float skyUPos = skyUStart;
+//----------------background--
 
-        for (int x = 0; x < g_windowWidth; ++x)
+void GameGraphics::draw_background_columns(int startRay, int endRay, const RayInfoArr& rays, const WallColumns& columns, const BackgroundRows& background)
+{
+    int rayColumns = rays.get_size();
+    int groupSize = endRay - startRay;
+    int viewWidth = background.get_view_width();
+    int viewHeight = columns.height;
+
+    int screenStart[g_wallColumnsGroup + 1];
+    //rows [wallStart, wallEnd) of each ray covered by its wall, in columns with clear texels only the rows set in their mask
+    int wallStart[g_wallColumnsGroup];
+    int wallEnd[g_wallColumnsGroup];
+    const sf::Uint8* masks[g_wallColumnsGroup];
+
+    int minWallStart = viewHeight;
+    int maxWallStart = 0;
+    int minWallEnd = viewHeight;
+    int maxWallEnd = 0;
+
+    for (int i = 0; i <= groupSize; ++i)
+    {
+        //same view columns of the walls
+        screenStart[i] = first_view_column(startRay + i, rayColumns, viewWidth);
+        if (i == groupSize)
+            break;
+
+        int ray = startRay + i;
+        bool walled = columns.end[ray] > columns.start[ray];
+        wallStart[i] = walled ? columns.start[ray] : viewHeight;
+        wallEnd[i] = walled ? columns.end[ray] : viewHeight;
+        masks[i] = columns.masked[ray] ? columns.mask.data() + ray * viewHeight : nullptr;
+
+        minWallStart = std::min(minWallStart, wallStart[i]);
+        //columns with clear texels can leave any row uncovered
+        maxWallStart = std::max(maxWallStart, masks[i] != nullptr ? viewHeight : wallStart[i]);
+        minWallEnd = std::min(minWallEnd, wallEnd[i]);
+        maxWallEnd = std::max(maxWallEnd, wallEnd[i]);
+    }
+
+    auto covered = [&](int i, int viewRow)
         {
-            if (drawSky)
-                //sky
-            {
+            return viewRow >= wallStart[i] && viewRow < wallEnd[i] && (masks[i] == nullptr || masks[i][viewRow]);
+        };
 
-                if (skyUPos >= tex.skyTexture.width())
-                    skyUPos -= tex.skyTexture.width();
-                else if (skyUPos < 0)
-                    skyUPos += tex.skyTexture.width();
+    const BackgroundVars& bgVars = background.get_vars();
+    const int* skyColumns = background.get_sky_columns();
 
-                int viewPixel = (y * view.m_texture.getSize().x + x) * 4;
-                int texturePixel = ((int)skyVPos * tex.skyTexture.width() + (int)skyUPos) * 4;
+    for (int viewRow = 0; viewRow < viewHeight; ++viewRow)
+    {
+        //covered by the walls of every column
+        if (viewRow >= maxWallStart && viewRow < minWallEnd)
+        {
+            viewRow = minWallEnd - 1;
+            continue;
+        }
 
-                copy_pixels(view.m_pixels, tex.skyTexture.m_texturePixels, viewPixel, texturePixel, 0xFF);
-            }
-            else
-                //ceiling
-            {
-                uvPos[0] = std::abs((int)((xyPos.x - int(xyPos.x)) * tex.ceilingTexture.width()));
-                uvPos[1] = std::abs((int)((xyPos.y - int(xyPos.y)) * tex.ceilingTexture.height()));
+        const BackgroundRow& row = background.get_row(viewRow);
+        if (row.pixels == nullptr)
+            continue;
 
-                int viewPixel = (y * g_windowWidth + x) * 4;
-                int texturePixel = (uvPos[1] * tex.ceilingTexture.width() + uvPos[0]) * 4;
+        //not covered by any wall
+        if (viewRow < minWallStart || viewRow >= maxWallEnd)
+        {
+            draw_background_span(row, screenStart[0], screenStart[groupSize], bgVars, skyColumns);
+            continue;
+        }
 
-                copy_pixels(view.m_pixels, tex.ceilingTexture.m_texturePixels, viewPixel, texturePixel, shading);
+        //runs of adjacent rays not covered on this row
+        for (int i = 0; i < groupSize;)
+        {
+            if (covered(i, viewRow))
+            {
+                ++i;
+                continue;
             }
 
-            //floor
-            uvPos[0] = std::abs((int)((xyPos.x - int(xyPos.x)) * tex.floorTexture.width()));
-            uvPos[1] = std::abs((int)((xyPos.y - int(xyPos.y)) * tex.floorTexture.height()));
+            int runEnd = i + 1;
+            while (runEnd < groupSize && !covered(runEnd, viewRow))
+                ++runEnd;
 
-            int viewPixel = (g_windowHeight - y - 1) * g_windowWidth * 4 + x * 4;
-            int texturePixel = (uvPos[1] * tex.floorTexture.width() + uvPos[0]) * 4;
+            draw_background_span(row, screenStart[i], screenStart[runEnd], bgVars, skyColumns);
+            i = runEnd;
+        }
+    }
+}
 
-            copy_pixels(view.m_pixels, tex.floorTexture.m_texturePixels, viewPixel, texturePixel, shading);
+void GameGraphics::draw_background_span(const BackgroundRow& row, int startX, int endX, const BackgroundVars& bgVars, const int* skyColumns)
+{
+    if (row.texture == nullptr)
+    {
+        for (int x = startX; x < endX; ++x)
+            copy_pixels(row.pixels, row.skyTexels, x * 4, skyColumns[x] * 4, 0xFF);
+        return;
+    }
 
-            xyPos += xyIncrement;
-            skyUPos += bgVars.skyUIncrement;
-        }
-        skyVPos += bgVars.skyVIncrement;
+    //rows past the sight depth are shaded to black, whatever the texels
+    if (row.shading == 0)
+    {
+        const sf::Uint8 black[4] = { 0, 0, 0, 0xFF };
+        for (int x = startX; x < endX; ++x)
+            std::memcpy(row.pixels + x * 4, black, 4);
+        return;
+    }
+
+    int x = startX;
+
+#ifdef RCM_X86_SIMD
+    //packets of adjacent pixels, the remaining ones are drawn one by one
+    if (bgVars.simdLevel == utils::SimdLevel::AVX2)
+    {
+        for (; x + 8 <= endX; x += 8)
+            draw_background_pixels_avx2(row, x);
+    }
+    else if (bgVars.simdLevel == utils::SimdLevel::SSE2)
+    {
+        for (; x + 4 <= endX; x += 4)
+            draw_background_pixels_sse2(row, x);
     }
+#endif
+
+    for (; x < endX; ++x)
+        draw_background_pixel(row, x);
 }
 
+void GameGraphics::draw_background_pixel(const BackgroundRow& row, int x)
+{
+    math::Vect2 xyPos = row.start + row.increment * (float)x;
+    float fractX = xyPos.x - int(xyPos.x);
+    float fractY = xyPos.y - int(xyPos.y);
+
+    const Texture& texture = *row.texture;
+    int u = std::abs((int)(fractX * texture.width()));
+    int v = std::abs((int)(fractY * texture.height()));
+
+    copy_pixels(row.pixels, texture.m_texturePixels, x * 4, (v * texture.width() + u) * 4, row.shading);
+}
  
 //-------------------Sprites-----------
 
@@ -637,20 +1204,40 @@ struct CompareBillboards
 
 void GameGraphics::render_sprites(const std::vector<std::unique_ptr<IEntity>>& entities)
 {
-    std::priority_queue<const Billboard*, std::vector<const Billboard*>, CompareBillboards> billbByDistMaxQ;
-
-    //sort by distance (in order to use the painter's algorithm)
+    m_billboardsToDraw.clear();
     for (const std::unique_ptr<IEntity>& entity : entities)
     {
         if (entity->m_visible && entity->m_billboard.distance > 0.2f)
         {
-            billbByDistMaxQ.push(&(entity->m_billboard));
+            m_billboardsToDraw.push_back(&(entity->m_billboard));
+        }
+    }
+    queue_billboards(m_billboardsToDraw, m_spriteSecFactory);
+
+    //the ones the core placed for each added camera
+    for (std::unique_ptr<CameraViewRender>& cameraView : m_cameraViews)
+    {
+        m_billboardsToDraw.clear();
+        for (const Billboard& billboard : cameraView->billboards)
+        {
+            if (billboard.distance > 0.2f)
+                m_billboardsToDraw.push_back(&billboard);
         }
+        queue_billboards(m_billboardsToDraw, cameraView->spriteSecFactory);
     }
 
-    while(!billbByDistMaxQ.empty())
+    render_sprite();
+}
+
+void GameGraphics::queue_billboards(std::vector<const Billboard*>& billboards, SpriteRendSectionFactory& spriteSecFactory)
+{
+    //sort by distance, nearest first: sprites are drawn front to back, skipping the pixels nearer ones already cover
+    std::sort(billboards.begin(), billboards.end(), CompareBillboards());
+
+    spriteSecFactory.clear_sprites();
+
+    for (const Billboard* billb : billboards)
     {
-        const Billboard* billb = billbByDistMaxQ.top();
         const Texture* spriteTex = nullptr;
 
         int currentId = -1;
@@ -696,27 +1283,39 @@ void GameGraphics::render_sprites(const std::vector<std::unique_ptr<IEntity>>& e
                 throw std::runtime_error(err);
             }
 
-            m_spriteSecFactory.set_target(*billb, *spriteTex);
-            update_sprite_sections();
-            render_sprite();
+            spriteSecFactory.add_sprite(*billb, *spriteTex);
         }
-
-        billbByDistMaxQ.pop();
     }
-
-    m_mainView.m_texture.update(m_mainView.m_pixels);
-    m_window.draw(m_mainView.m_sprite);
 }
 
 void GameGraphics::render_sprite()
 {
+    //the sprites of every view are drawn in one batch, the last main view section runs on this thread
+    bool mainSprites = m_spriteSecFactory.has_sprites();
+    int addedSections = 0;
+    for (const std::unique_ptr<CameraViewRender>& cameraView : m_cameraViews)
+    {
+        if (cameraView->spriteSecFactory.has_sprites())
+            addedSections += cameraView->spriteSectionsVec.size();
+    }
+    if (!mainSprites && addedSections == 0)
+        return;
+
     int lastSection = m_spriteSecFactory.get_size() - 1;
-    m_rendThreadPool.new_batch(m_spriteSecFactory.get_size() - 1);
+    m_rendThreadPool.new_batch((mainSprites ? lastSection : 0) + addedSections);
 
-    for (int i = 0; i < lastSection; ++i)
+    for (int i = 0; i < lastSection && mainSprites; ++i)
     {
         m_rendThreadPool.enqueue(&m_spriteSectionsVec.at(i));
     }
+    for (std::unique_ptr<CameraViewRender>& cameraView : m_cameraViews)
+    {
+        if (!cameraView->spriteSecFactory.has_sprites())
+            continue;
+        for (SpriteRendSectionFactory::SpriteRendSection& section : cameraView->spriteSectionsVec)
+            m_rendThreadPool.enqueue(&section);
+    }
+    if (mainSprites)
     {
         SpriteRendSectionFactory::SpriteRendSection lastSec(m_spriteSecFactory.create_section(lastSection));
         lastSec();
@@ -727,53 +1326,90 @@ void GameGraphics::render_sprite()
     }
 }
 
-void GameGraphics::draw_sprite_section(int startU, int endU, GameView& view, const SpriteRendVars& vars, const Billboard& billboard, const Texture& spriteTex, const GraphicsVars& graphicsVars, const RayInfoArr& rays)
+void GameGraphics::draw_sprite_section(int startX, int endX, GameView& view, const std::vector<SpriteRendVars>& sprites, const RayInfoArr& rays, SpriteCoverage& coverage)
 {
-    int screenU = startU + (billboard.positionOnScreen - vars.screenSpriteWidth / 2);
+    //depth is read from the ray drawn on the column
+    int columns = rays.get_size();
+    int viewWidth = view.m_width;
+    int viewHeight = view.m_height;
 
-    float textureU = startU * vars.texUStep;
-    if (screenU < 0)
+    //sprites are sorted front to back, each one is clipped to the strip
+    for (const SpriteRendVars& vars : sprites)
     {
-        textureU -= screenU * vars.texUStep;
-        screenU = 0;
-    }
+        int screenU = std::max(vars.screenUStart, std::max(startX, 0));
+        int screenUEnd = std::min(vars.screenUEnd, std::min(endX, viewWidth));
+        if (screenU >= screenUEnd)
+            continue;
 
-    int screenUEnd = endU + (billboard.positionOnScreen - vars.screenSpriteWidth / 2);
-    
-    for (; screenU < screenUEnd && screenU < g_windowWidth; ++screenU )
-    {
-        if (billboard.distance < rays.const_at( screenU ).length)
-        {
-            int screenV = (vars.floorHeight) < 0
-                ? 0 
-                : vars.floorHeight;
+        const Billboard& billboard = *vars.billboard;
+        const Texture& spriteTex = *vars.texture;
+        float textureU = (screenU - vars.screenUStart) * vars.texUStep;
 
-            float textureV = vars.textureVstart;
+        int screenVStart = (vars.floorHeight) < 0
+            ? 0 
+            : vars.floorHeight;
+        int screenVEnd = std::min(vars.screenVEnd, viewHeight);
 
-            for (; screenV < vars.screenVEnd && screenV < g_windowHeight; ++screenV)
-            {
+        for (; screenU < screenUEnd; ++screenU)
+        {
+            //columns hidden by a wall or whose rows are all covered by nearer sprites are skipped
+            bool hidden = !(billboard.distance < rays.length(screenU * columns / viewWidth)) ||
+                (screenVStart >= coverage.coveredStart[screenU] && screenVEnd <= coverage.coveredEnd[screenU]);
 
-                int uvPos[2]{};
+            if (!hidden)
+            {
+                sf::Uint8* stamps = coverage.column(screenU);
+                bool spanCovered = true;
 
-                uvPos[0] = int(textureU);
-                uvPos[1] = int(textureV);
+                float textureV = vars.textureVstart;
 
-                if (spriteTex.m_texturePixels[(uvPos[1] * spriteTex.width() + uvPos[0]) * 4 + 3] == 0xFF)
+                for (int screenV = screenVStart; screenV < screenVEnd; ++screenV)
                 {
-                    int viewPixel = (screenV * g_windowWidth + screenU) * 4;
-                    int texturePixel = (uvPos[1] * spriteTex.width() + uvPos[0]) * 4;
-
-                    copy_pixels(view.m_pixels, spriteTex.m_texturePixels, viewPixel, texturePixel, 0xFF);
+                    if (stamps[screenV] != coverage.stamp)
+                    {
+                        int uvPos[2]{};
+
+                        uvPos[0] = int(textureU);
+                        uvPos[1] = int(textureV);
+
+                        if (spriteTex.m_texturePixels[(uvPos[1] * spriteTex.width() + uvPos[0]) * 4 + 3] == 0xFF)
+                        {
+                            int viewPixel = (screenV * viewWidth + screenU) * 4;
+                            int texturePixel = (uvPos[1] * spriteTex.width() + uvPos[0]) * 4;
+
+                            copy_pixels(view.m_pixels, spriteTex.m_texturePixels, viewPixel, texturePixel, 0xFF);
+                            stamps[screenV] = coverage.stamp;
+                        }
+                        else
+                        {
+                            //TODO semi transparency
+                            spanCovered = false;
+                        }
+                    }
+
+                    textureV += vars.texVStep;
                 }
-                else
+
+                //a fully covered span joins the covered rows of the column (or replaces them, if longer)
+                if (spanCovered && screenVStart < screenVEnd)
                 {
-                    //TODO semi transparency
+                    int& coveredStart = coverage.coveredStart[screenU];
+                    int& coveredEnd = coverage.coveredEnd[screenU];
+
+                    if (screenVStart <= coveredEnd && screenVEnd >= coveredStart)
+                    {
+                        coveredStart = std::min(coveredStart, screenVStart);
+                        coveredEnd = std::max(coveredEnd, screenVEnd);
+                    }
+                    else if (screenVEnd - screenVStart > coveredEnd - coveredStart)
+                    {
+                        coveredStart = screenVStart;
+                        coveredEnd = screenVEnd;
+                    }
                 }
-
-                textureV += vars.texVStep;
             }
+            textureU += vars.texUStep;
         }
-        textureU += vars.texUStep;
     }
 }
 
@@ -787,8 +1423,8 @@ void GameGraphics::draw_minimap_rays(int winPixWidth, const RayInfoArr& rays)
         lines[i * 2] = sf::Vector2f(m_minimapInfo.minimapCenterY,
                                     m_minimapInfo.minimapCenterX);
 
-        lines[i * 2 + 1] = { {  m_minimapInfo.minimapCenterY + rays.const_at(i).hitPos.x * m_minimapInfo.minimapScale,
-                                m_minimapInfo.minimapCenterX + rays.const_at(i).hitPos.y * m_minimapInfo.minimapScale  },
+        lines[i * 2 + 1] = { {  m_minimapInfo.minimapCenterY + rays.hit_pos(i).x * m_minimapInfo.minimapScale,
+                                m_minimapInfo.minimapCenterX + rays.hit_pos(i).y * m_minimapInfo.minimapScale  },
                                 sf::Color::Cyan };
     }
     m_window.draw(lines);
@@ -802,9 +1438,9 @@ void GameGraphics::draw_minimap_triangles(int winPixWidth, const RayInfoArr& ray
 
     for (int i = 0; i < winPixWidth; ++i)
     {
-        triangles[i + 1] = { {  m_minimapInfo.minimapCenterY + rays.const_at(i).hitPos.x * m_minimapInfo.minimapScale,
-                                m_minimapInfo.minimapCenterX + rays.const_at(i).hitPos.y * m_minimapInfo.minimapScale  },
-                                sf::Color(0xFF, 0, 0, (1 - rays.const_at(i).length / graphVars.maxSightDepth) * 0xFF) };
+        triangles[i + 1] = { {  m_minimapInfo.minimapCenterY + rays.hit_pos(i).x * m_minimapInfo.minimapScale,
+                                m_minimapInfo.minimapCenterX + rays.hit_pos(i).y * m_minimapInfo.minimapScale  },
+                                sf::Color(0xFF, 0, 0, (1 - rays.length(i) / graphVars.maxSightDepth) * 0xFF) };
     }
     m_window.draw(triangles);
 }
@@ -899,7 +1535,7 @@ void GameGraphics::draw_minimap_background(const GameMap& gameMap, const EntityT
     {
         for (int x = startX; x < endX; ++x)
         {
-            char currentCell = gameMap.cells->at(y * gameMap.width + x);
+            char currentCell = MapGrid::to_char(gameMap.grid.at(x, y));
 
             if (currentCell != ' ')
             {
@@ -1,4 +1,6 @@
 #include <iostream>
+#include <algorithm>
+#include <cmath>
 #include "gameHandler.hpp"
 #include "dataManager.hpp"
 #include "gameGraphics.hpp"
@@ -7,6 +9,8 @@
 
 #define WINDOW_NAME "ray cast maze"
 #define GENERATION_TIME_STEP_MS 5
+//frames averaged before each render width change
+#define RENDER_WIDTH_UPDATE_FRAMES 8
 
 namespace rcm
 {
@@ -24,6 +28,11 @@ namespace rcm
 		inline char get_entity_cell(const EntityTransform& pos, const GameMap& map) override;
 		inline char get_entity_cell(const int cellX, const int cellY, const GameMap& map) override;
 		inline const GameMap& get_active_map() override { return m_gameData->gameMap; }
+		void set_map_cell(const int cellX, const int cellY, const char cell) override { m_gameCore->set_map_cell(cellX, cellY, cell); }
+		void check_lines_of_sight(const std::vector<SightQuery>& queries, std::vector<SightResult>& results) override { m_gameCore->check_lines_of_sight(queries, results); }
+		const VisibleCells& get_visible_cells() override { return m_gameCore->get_visible_cells(); }
+		int add_camera(const EntityTransform& transform, float fov, int renderWidth, const ViewportRect& viewport) override;
+		void remove_camera(int index) override;
 	private:
 		void start();
 		void performGameCycle();
@@ -32,9 +41,11 @@ namespace rcm
 		void handle_entities_actions(std::vector<std::unique_ptr<IEntity>>&);
 		void handle_entities_interactions(std::vector<std::unique_ptr<IEntity>>&);
 		void draw_text_ui();
+		void update_render_width(int frameTime);
 		inline bool goal_reached(const EntityTransform& pos, const GameMap& map);
 
 		std::unique_ptr<DataUtils::GameData> m_gameData;
+		std::unique_ptr<RendThreadPool> m_rendThreadPool;
 		std::unique_ptr<GameCore> m_gameCore;
 		std::unique_ptr<sf::RenderWindow> m_window;
 		std::unique_ptr<GameGraphics> m_gameGraphics;
@@ -42,6 +53,11 @@ namespace rcm
 		std::unique_ptr<GameCameraView> m_gameCameraView;
 		GameStateVars m_gameState{};
 		std::vector<std::unique_ptr<IEntity>> m_entitiesToAdd;
+
+		//time spent on each frame before displaying it (the frame rate limit is not included)
+		debug::GameTimer m_frameTimer;
+		long long m_frameTimeSum = 0;
+		int m_frameTimeCount = 0;
 	};
 
 	IGameHandler& get_gameHandler()
@@ -82,10 +98,12 @@ namespace rcm
 			throw std::runtime_error(err);
 		}
 
-		m_gameCore = std::make_unique<GameCore>(m_gameData->gameCameraVars, m_gameData->gameMap, player->m_transform);
+		//shared by ray casting (core) and rendering (graphics), which never run at the same time
+		m_rendThreadPool = std::make_unique<RendThreadPool>(utils::get_thread_number());
+		m_gameCore = std::make_unique<GameCore>(m_gameData->gameCameraVars, m_gameData->gameMap, player->m_transform, *(m_rendThreadPool));
 		m_gameCameraView = std::make_unique<GameCameraView>(GameCameraView{ player->m_transform, m_gameData->gameCameraVars, m_gameCore->get_camera_vecs() });
 		m_window = std::make_unique<sf::RenderWindow>(sf::VideoMode(windowVars::g_windowWidth, windowVars::g_windowHeight), WINDOW_NAME);
-		m_gameGraphics = std::make_unique<GameGraphics>(*(m_window), m_gameData->graphicsVars);
+		m_gameGraphics = std::make_unique<GameGraphics>(*(m_window), m_gameData->graphicsVars, *(m_rendThreadPool));
 		m_inputManager = std::make_unique<InputManager>(m_gameData->controlsMulti, *(m_window), m_gameState);
 
 		m_entitiesToAdd.emplace_back(player.release());
@@ -102,6 +120,35 @@ namespace rcm
 		m_entitiesToAdd.emplace_back(entity);
 	}
 
+	int GameHandler::add_camera(const EntityTransform& transform, float fov, int renderWidth, const ViewportRect& viewport)
+	{
+		if (renderWidth < 1 || renderWidth > windowVars::g_windowWidth)
+			throw std::invalid_argument("Camera render width must be in [1, window width].");
+
+		GameCameraVars cameraVars = m_gameData->gameCameraVars;
+		cameraVars.fov = math::deg_to_rad(fov);
+		cameraVars.pixelWidth = renderWidth;
+
+		int index = m_gameCore->add_camera(cameraVars, transform);
+		try
+		{
+			m_gameGraphics->add_camera_view(GameCameraView{ transform, m_gameCore->get_camera_vars(index), m_gameCore->get_camera_vecs(index) },
+				m_gameCore->get_ray_info_arr(index), m_gameCore->get_camera_billboards(index), viewport);
+		}
+		catch (std::exception&)
+		{
+			m_gameCore->remove_camera(index);
+			throw;
+		}
+		return index;
+	}
+
+	void GameHandler::remove_camera(int index)
+	{
+		m_gameCore->remove_camera(index);
+		m_gameGraphics->remove_camera_view(index);
+	}
+
 	void GameHandler::add_cached_entities()
 	{
 		while (!m_entitiesToAdd.empty())
@@ -119,6 +166,8 @@ namespace rcm
 		//game timer
 		debug::GameTimer gt;
 		gt.reset_timer();
+		long long rayCastingTime = 0;
+		long long savedRays = 0;
 
 		while (m_gameGraphics->is_running())
 		{
@@ -126,22 +175,29 @@ namespace rcm
 
 			//frame counter
 			gt.add_frame();
+			rayCastingTime += m_gameCore->get_ray_casting_time();
+			savedRays += m_gameCore->get_saved_rays();
 			if (gt.get_frame_rate_noreset() == 8)
 			{
-				std::cout << "fps: " << gt.get_frame_rate() << std::endl;
+				std::cout << "fps: " << gt.get_frame_rate() << "  ray casting: " << rayCastingTime / 8000 << " us";
+				if (m_gameData->gameCameraVars.raySubdivision > 1)
+					std::cout << "  rays saved: " << savedRays / 8 << "/" << m_gameData->gameCameraVars.pixelWidth;
+				std::cout << std::endl;
+				rayCastingTime = 0;
+				savedRays = 0;
 			}
 		}
 	}
 
 	char GameHandler::get_entity_cell(const EntityTransform& pos, const GameMap& map)
 	{
-		return map.cells->at(static_cast<int>(pos.coordinates.y) * map.width +
-			static_cast<int>(pos.coordinates.x));
+		return get_entity_cell(static_cast<int>(pos.coordinates.x), static_cast<int>(pos.coordinates.y), map);
 	}
 
 	char GameHandler::get_entity_cell(const int cellX, const int cellY, const GameMap& map)
 	{
-		return map.cells->at(cellX * map.width + cellY);
+		//the grid also covers maps that are not kept in memory (chunk files)
+		return MapGrid::to_char(map.grid.at(cellX, cellY));
 	}
 
 	bool GameHandler::goal_reached(const EntityTransform& pos, const GameMap& map)
@@ -218,7 +274,8 @@ namespace rcm
 	/// @brief main game cycle
 	void GameHandler::performGameCycle()
 	{
-		m_window->clear(sf::Color::Black);
+		m_frameTimer.reset_timer();
+		//the window is cleared by draw_view() only where the opaque main view doesn't cover it
 
 		m_inputManager->handle_events_main();
 
@@ -234,12 +291,43 @@ namespace rcm
 			m_gameState.isFindPathRequested = false;
 		}
 
+		//cycle through ray acceleration structures, to compare their ray casting time on the current map
+		if (m_gameState.isRayAccelerationSwitchRequested)
+		{
+			switch (m_gameData->gameCameraVars.rayAcceleration)
+			{
+			case RayAcceleration::None:
+				m_gameCore->set_ray_acceleration(RayAcceleration::DistanceField);
+				std::cout << "ray acceleration: distance field" << std::endl;
+				break;
+			case RayAcceleration::DistanceField:
+				m_gameCore->set_ray_acceleration(RayAcceleration::Pyramid);
+				std::cout << "ray acceleration: pyramid" << std::endl;
+				break;
+			default:
+				m_gameCore->set_ray_acceleration(RayAcceleration::None);
+				std::cout << "ray acceleration: none" << std::endl;
+				break;
+			}
+			m_gameState.isRayAccelerationSwitchRequested = false;
+		}
+
+		//switch between ray casting and wall spans, to compare their time on the current map
+		if (m_gameState.isWallRendererSwitchRequested)
+		{
+			m_gameCore->set_wall_spans(!m_gameData->gameCameraVars.wallSpans);
+			std::cout << "walls: " << (m_gameData->gameCameraVars.wallSpans ? "spans" : "rays") << std::endl;
+			m_gameState.isWallRendererSwitchRequested = false;
+		}
+
 		m_gameCore->view_by_ray_casting(m_gameState.isLinearPersp);
-		m_gameGraphics->draw_view(m_gameState.isLinearPersp, m_gameCore->get_entities());
+		m_gameGraphics->draw_view(m_gameCore->get_entities());
 
 		if (m_gameState.isPaused || m_gameState.isTabbed)
 		{
-			m_gameGraphics->draw_map(m_gameData->gameMap.width, m_gameData->gameMap.height, m_gameCameraView->transform.coordinates.x, m_gameCameraView->transform.coordinates.y, *(m_gameData->gameMap.cells));
+			//the full screen map is only drawn for maps kept in memory
+			if (m_gameData->gameMap.cells)
+				m_gameGraphics->draw_map(m_gameData->gameMap.width, m_gameData->gameMap.height, m_gameCameraView->transform.coordinates.x, m_gameCameraView->transform.coordinates.y, *(m_gameData->gameMap.cells));
 			m_gameGraphics->draw_path_out();
 		}
 		else
@@ -249,11 +337,55 @@ namespace rcm
 
 			draw_text_ui();
 		}
+		update_render_width(m_frameTimer.get_time_nano());
 		m_window->display();
 
 		m_gameCore->update_entities();
 	}
 
+	/// @brief dynamic resolution: the number of wall rays follows the average frame time, walls are then stretched to the window
+	void GameHandler::update_render_width(int frameTime)
+	{
+		const GameCameraVars& cameraVars = m_gameData->gameCameraVars;
+		if (cameraVars.frameTimeTarget <= 0)
+			return;
+
+		//frames drawn under the map or while the window is in the background don't tell the cost of the view,
+		//the average starts over once the game is back
+		if (m_gameState.isPaused || m_gameState.isTabbed || !m_gameState.hadFocus)
+		{
+			m_frameTimeSum = 0;
+			m_frameTimeCount = 0;
+			return;
+		}
+
+		m_frameTimeSum += frameTime;
+		if (++m_frameTimeCount < RENDER_WIDTH_UPDATE_FRAMES)
+			return;
+
+		float averageMs = m_frameTimeSum / (m_frameTimeCount * 1e6f);
+		m_frameTimeSum = 0;
+		m_frameTimeCount = 0;
+
+		//the width is kept while the frame time is a bit under the target, so that it doesn't oscillate around it
+		if (averageMs <= cameraVars.frameTimeTarget && averageMs >= cameraVars.frameTimeTarget * 0.85f)
+			return;
+
+		//frame time is taken as proportional to the width, big steps are limited to smooth out spikes
+		float ratio = std::clamp(cameraVars.frameTimeTarget * 0.925f / averageMs, 0.75f, 1.25f);
+
+		//multiples of 8 keep the ray packets full. Growing widths are rounded up: rounded down, widths of 24 columns or less
+		//would never grow (24 * 1.25 is 30, back to 24)
+		int maxWidth = m_gameCore->get_max_render_width();
+		int minWidth = std::max(8, (int)(maxWidth * cameraVars.minRenderScale) / 8 * 8);
+		int scaledWidth = ratio > 1
+			? (int)std::ceil(cameraVars.pixelWidth * ratio / 8) * 8
+			: (int)(cameraVars.pixelWidth * ratio) / 8 * 8;
+		int width = std::clamp(scaledWidth, std::min(minWidth, maxWidth), maxWidth);
+
+		m_gameCore->set_render_width(width);
+	}
+
 	void GameHandler::load_sprites(std::vector<std::unique_ptr<IEntity>>& entities)
 	{
 		for (const std::pair<int, std::string>& sprite : m_gameData->gameSprites)
@@ -68,6 +68,14 @@ void InputManager::handle_events_main()
             {
                 m_gameState.isFindPathRequested = true;
             }
+            if (event.key.scancode == sf::Keyboard::Scan::B)
+            {
+                m_gameState.isRayAccelerationSwitchRequested = true;
+            }
+            if (event.key.scancode == sf::Keyboard::Scan::V)
+            {
+                m_gameState.isWallRendererSwitchRequested = true;
+            }
         }
     }
     if (m_window.hasFocus())
@@ -0,0 +1,171 @@
+#include "mapChunks.hpp"
+#include "mapGrid.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MapChunkFile::MapChunkFile(const std::string& path)
+{
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		throw std::runtime_error("Could not open map chunks file.");
+	m_fileHandle = file;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize))
+	{
+		unmap();
+		throw std::runtime_error("Could not read map chunks file size.");
+	}
+	m_mappingSize = size_t(fileSize.QuadPart);
+
+	//copy on write: changed pages stay private to the process
+	m_mappingHandle = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+	if (m_mappingHandle != nullptr)
+		m_mapping = MapViewOfFile(m_mappingHandle, FILE_MAP_COPY, 0, 0, 0);
+	if (m_mapping == nullptr)
+	{
+		unmap();
+		throw std::runtime_error("Could not map map chunks file.");
+	}
+#else
+	int file = open(path.c_str(), O_RDONLY);
+	if (file < 0)
+		throw std::runtime_error("Could not open map chunks file.");
+
+	struct stat fileStat;
+	if (fstat(file, &fileStat) != 0)
+	{
+		close(file);
+		throw std::runtime_error("Could not read map chunks file size.");
+	}
+	m_mappingSize = size_t(fileStat.st_size);
+
+	//copy on write: changed pages stay private to the process. The mapping keeps the file open
+	void* mapping = m_mappingSize > 0 ? mmap(nullptr, m_mappingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0) : MAP_FAILED;
+	close(file);
+	if (mapping == MAP_FAILED)
+		throw std::runtime_error("Could not map map chunks file.");
+	m_mapping = mapping;
+#endif
+
+	Header header;
+	if (m_mappingSize < sizeof(Header))
+	{
+		unmap();
+		throw std::runtime_error("Map chunks file is too short.");
+	}
+	std::memcpy(&header, m_mapping, sizeof(Header));
+
+	int chunkSide = int(header.chunkSide);
+	bool validHeader = std::memcmp(header.magic, magic, sizeof(magic)) == 0 && header.version == version &&
+		header.width > 0 && header.height > 0 && header.width <= INT32_MAX && header.height <= INT32_MAX &&
+		chunkSide >= minChunkSide && (chunkSide & (chunkSide - 1)) == 0;
+	if (!validHeader)
+	{
+		unmap();
+		throw std::runtime_error("Not a map chunks file (or unsupported version).");
+	}
+
+	m_width = int(header.width);
+	m_height = int(header.height);
+	while ((1 << m_chunkShift) < chunkSide)
+		++m_chunkShift;
+	m_chunksPerRow = (m_width + chunkSide - 1) / chunkSide;
+	int chunksPerColumn = (m_height + chunkSide - 1) / chunkSide;
+
+	if (m_mappingSize < sizeof(Header) + size_t(m_chunksPerRow) * chunksPerColumn * chunkSide * chunkSide)
+	{
+		unmap();
+		throw std::runtime_error("Map chunks file is truncated.");
+	}
+	m_cells = static_cast<unsigned char*>(m_mapping) + sizeof(Header);
+}
+
+MapChunkFile::~MapChunkFile()
+{
+	unmap();
+}
+
+void MapChunkFile::unmap()
+{
+#ifdef _WIN32
+	if (m_mapping != nullptr)
+		UnmapViewOfFile(m_mapping);
+	if (m_mappingHandle != nullptr)
+		CloseHandle(m_mappingHandle);
+	if (m_fileHandle != nullptr)
+		CloseHandle(m_fileHandle);
+	m_mappingHandle = nullptr;
+	m_fileHandle = nullptr;
+#else
+	if (m_mapping != nullptr)
+		munmap(m_mapping, m_mappingSize);
+#endif
+	m_mapping = nullptr;
+	m_cells = nullptr;
+}
+
+void MapChunkFile::copy_row(int x, int y, int length, unsigned char* destination) const
+{
+	int chunkSide = 1 << m_chunkShift;
+	while (length > 0)
+	{
+		//cells of a row are contiguous up to the end of their chunk
+		int count = std::min(length, chunkSide - (x & (chunkSide - 1)));
+		std::memcpy(destination, m_cells + offset(x, y), count);
+		x += count;
+		destination += count;
+		length -= count;
+	}
+}
+
+void MapChunkFile::write(const std::string& path, int width, int height, const std::function<char(int, int)>& cellAt, int chunkSide)
+{
+	if (width <= 0 || height <= 0)
+		throw std::invalid_argument("Map dimensions must be positive.");
+	if (chunkSide < minChunkSide || (chunkSide & (chunkSide - 1)) != 0)
+		throw std::invalid_argument("Map chunk side must be a power of two, at least 16.");
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+		throw std::runtime_error("Could not create map chunks file.");
+
+	Header header;
+	std::memcpy(header.magic, magic, sizeof(magic));
+	header.version = version;
+	header.width = uint32_t(width);
+	header.height = uint32_t(height);
+	header.chunkSide = uint32_t(chunkSide);
+	file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+
+	std::vector<unsigned char> chunk(size_t(chunkSide) * chunkSide);
+	for (int chunkY = 0; chunkY < height; chunkY += chunkSide)
+		for (int chunkX = 0; chunkX < width; chunkX += chunkSide)
+		{
+			for (int y = 0; y < chunkSide; ++y)
+				for (int x = 0; x < chunkSide; ++x)
+				{
+					bool inside = chunkX + x < width && chunkY + y < height;
+					chunk[x + y * chunkSide] = MapGrid::from_char(inside ? cellAt(chunkX + x, chunkY + y) : ' ');
+				}
+			file.write(reinterpret_cast<const char*>(chunk.data()), chunk.size());
+		}
+
+	if (!file.good())
+		throw std::runtime_error("Could not write map chunks file.");
+}
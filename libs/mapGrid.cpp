@@ -0,0 +1,174 @@
+#include "mapGrid.hpp"
+#include "mapChunks.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+//extra bytes at the end of the grid, so that 4 bytes reads (simd gathers) starting from the last cells stay in bounds
+constexpr int g_gridTailPadding = 3;
+
+void MapGrid::load(int width, int height, const std::string& cells)
+{
+	if (width <= 0 || height <= 0)
+		throw std::invalid_argument("Map grid dimensions must be positive.");
+
+	m_width = width;
+	m_height = height;
+	m_chunks.reset();
+	//the whole map is resident
+	m_windowX = 0;
+	m_windowY = 0;
+	m_windowWidth = width;
+	m_windowHeight = height;
+	m_stride = width + 2;
+	m_cells.assign(m_stride * (height + 2) + g_gridTailPadding, Oob);
+
+	for (int y = 0; y < m_height; ++y)
+		for (int x = 0; x < m_width; ++x)
+		{
+			size_t i = x + y * size_t(m_width);
+			m_cells[index(x, y)] = from_char(i < cells.size() ? cells[i] : ' ');
+		}
+}
+
+void MapGrid::load(std::shared_ptr<MapChunkFile> chunks, int x, int y, int radius)
+{
+	if (chunks == nullptr)
+		throw std::invalid_argument("No map chunks file to load.");
+
+	m_chunks = std::move(chunks);
+	m_width = m_chunks->get_width();
+	m_height = m_chunks->get_height();
+	//no cells are kept from another map
+	m_cells.clear();
+	copy_window(x, y, radius);
+}
+
+bool MapGrid::update_window(int x, int y, int radius)
+{
+	if (m_chunks == nullptr)
+		return false;
+
+	if (is_area_resident(x, y, radius))
+		return false;
+
+	copy_window(x, y, radius);
+	return true;
+}
+
+bool MapGrid::is_area_resident(int x, int y, int radius) const
+{
+	//the window is never bigger than the map
+	radius = std::min(radius, std::max(m_width, m_height));
+	int firstX = std::clamp(x - radius, 0, m_width - 1);
+	int firstY = std::clamp(y - radius, 0, m_height - 1);
+	int lastX = std::clamp(x + radius, 0, m_width - 1);
+	int lastY = std::clamp(y + radius, 0, m_height - 1);
+	return is_resident(firstX, firstY) && is_resident(lastX, lastY);
+}
+
+void MapGrid::copy_window(int x, int y, int radius)
+{
+	int chunkSide = m_chunks->get_chunk_side();
+	radius = std::min(radius, std::max(m_width, m_height));
+	x = std::clamp(x, 0, m_width - 1);
+	y = std::clamp(y, 0, m_height - 1);
+
+	//half a chunk more on every side, so that the window doesn't move back and forth on a chunk edge.
+	//Whole chunks keep the window aligned to the occupancy pyramid blocks of the map
+	int margin = radius + chunkSide / 2;
+	int windowX = std::max(x - margin, 0) / chunkSide * chunkSide;
+	int windowY = std::max(y - margin, 0) / chunkSide * chunkSide;
+	int windowWidth = std::min((std::min(x + margin + 1, m_width) + chunkSide - 1) / chunkSide * chunkSide, m_width) - windowX;
+	int windowHeight = std::min((std::min(y + margin + 1, m_height) + chunkSide - 1) / chunkSide * chunkSide, m_height) - windowY;
+	int stride = windowWidth + 2;
+
+	//cells resident before and after the move are moved inside the buffer, only the others are read from the chunks
+	int keptX = std::max(windowX, m_windowX);
+	int keptY = std::max(windowY, m_windowY);
+	int keptEndX = std::min(windowX + windowWidth, m_windowX + m_windowWidth);
+	int keptEndY = std::min(windowY + windowHeight, m_windowY + m_windowHeight);
+	bool keep = !m_cells.empty() && keptX < keptEndX && keptY < keptEndY;
+
+	//the buffer keeps its capacity, it is only reallocated when a window is bigger than all the previous ones
+	size_t size = size_t(stride) * (windowHeight + 2) + g_gridTailPadding;
+	if (size > m_cells.size())
+		m_cells.resize(size, Oob);
+
+	if (keep)
+	{
+		auto source = [&](int row) { return size_t(keptX - m_windowX + 1) + size_t(row - m_windowY + 1) * m_stride; };
+		auto destination = [&](int row) { return size_t(keptX - windowX + 1) + size_t(row - windowY + 1) * stride; };
+		int keptWidth = keptEndX - keptX;
+
+		//both strides are at least keptWidth: rows moved towards the start of the buffer are moved first, in order,
+		//the other ones after them in reverse order, so that no row is overwritten before it is moved
+		for (int row = keptY; row < keptEndY; ++row)
+			if (destination(row) <= source(row))
+				std::memmove(&m_cells[destination(row)], &m_cells[source(row)], keptWidth);
+		for (int row = keptEndY - 1; row >= keptY; --row)
+			if (destination(row) > source(row))
+				std::memmove(&m_cells[destination(row)], &m_cells[source(row)], keptWidth);
+	}
+	m_cells.resize(size);
+
+	m_windowX = windowX;
+	m_windowY = windowY;
+	m_windowWidth = windowWidth;
+	m_windowHeight = windowHeight;
+	m_stride = stride;
+
+	//the border around the window stops rays like the map border
+	std::fill(m_cells.begin(), m_cells.begin() + m_stride, Oob);
+	std::fill(m_cells.begin() + size_t(m_stride) * (m_windowHeight + 1), m_cells.end(), Oob);
+	for (int row = 1; row <= m_windowHeight; ++row)
+	{
+		m_cells[size_t(row) * m_stride] = Oob;
+		m_cells[size_t(row) * m_stride + m_stride - 1] = Oob;
+	}
+
+	for (int row = m_windowY; row < m_windowY + m_windowHeight; ++row)
+	{
+		if (!keep || row < keptY || row >= keptEndY)
+		{
+			m_chunks->copy_row(m_windowX, row, m_windowWidth, &m_cells[index(m_windowX, row)]);
+			continue;
+		}
+		//new columns on the sides of the kept ones
+		if (keptX > m_windowX)
+			m_chunks->copy_row(m_windowX, row, keptX - m_windowX, &m_cells[index(m_windowX, row)]);
+		if (keptEndX < m_windowX + m_windowWidth)
+			m_chunks->copy_row(keptEndX, row, m_windowX + m_windowWidth - keptEndX, &m_cells[index(keptEndX, row)]);
+	}
+}
+
+void MapGrid::set_cell(int x, int y, char cell)
+{
+	if (!is_inside(x, y))
+		throw std::invalid_argument("Map cell out of bounds.");
+
+	if (m_chunks != nullptr)
+		m_chunks->set(x, y, from_char(cell));
+	if (is_resident(x, y))
+		m_cells[index(x, y)] = from_char(cell);
+}
+
+unsigned char MapGrid::at_chunks(int x, int y) const
+{
+	return (m_chunks != nullptr && is_inside(x, y)) ? m_chunks->at(x, y) : static_cast<unsigned char>(Oob);
+}
+
+MapGrid::Cell MapGrid::from_char(char cell)
+{
+	switch (cell)
+	{
+	case 'w':
+		return Wall;
+	case 'b':
+		return Boundary;
+	case 'g':
+		return Goal;
+	default:
+		return Empty;
+	}
+}
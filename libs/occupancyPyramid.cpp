@@ -0,0 +1,92 @@
+#include "occupancyPyramid.hpp"
+#include <utility>
+
+void OccupancyPyramid::build(const MapGrid& grid)
+{
+	m_originX = grid.get_window_x();
+	m_originY = grid.get_window_y();
+
+	for (int level = 0; level < levelsNumber; ++level)
+	{
+		int blockSide = 1 << levelShifts[level];
+
+		m_levels[level].width = (grid.get_window_width() + blockSide - 1) / blockSide;
+		m_levels[level].height = (grid.get_window_height() + blockSide - 1) / blockSide;
+		m_levels[level].emptyBlocks.assign(m_levels[level].width * m_levels[level].height, 0);
+
+		//levels are built from the finest, every level is computed from the previous one
+		for (int blockY = 0; blockY < m_levels[level].height; ++blockY)
+			for (int blockX = 0; blockX < m_levels[level].width; ++blockX)
+				update_block(grid, level, blockX, blockY);
+	}
+}
+
+void OccupancyPyramid::update(const MapGrid& grid, int x, int y)
+{
+	if (!is_built() || !grid.is_resident(x, y))
+		return;
+
+	for (int level = 0; level < levelsNumber; ++level)
+		update_block(grid, level, (x - m_originX) >> levelShifts[level], (y - m_originY) >> levelShifts[level]);
+}
+
+void OccupancyPyramid::update_window(const MapGrid& grid)
+{
+	if (!is_built())
+		return;
+
+	//a block only depends on the map cells (the ones out of the map are solid), not on the window it was computed in
+	int moveX = grid.get_window_x() - m_originX;
+	int moveY = grid.get_window_y() - m_originY;
+	m_originX = grid.get_window_x();
+	m_originY = grid.get_window_y();
+
+	for (int level = 0; level < levelsNumber; ++level)
+	{
+		int blockSide = 1 << levelShifts[level];
+		Level last = std::move(m_levels[level]);
+		Level& current = m_levels[level];
+
+		current.width = (grid.get_window_width() + blockSide - 1) / blockSide;
+		current.height = (grid.get_window_height() + blockSide - 1) / blockSide;
+		current.emptyBlocks.assign(current.width * current.height, 0);
+
+		//windows start on chunks, that are made of whole blocks
+		int lastOffsetX = moveX / blockSide;
+		int lastOffsetY = moveY / blockSide;
+		for (int blockY = 0; blockY < current.height; ++blockY)
+			for (int blockX = 0; blockX < current.width; ++blockX)
+			{
+				int lastX = blockX + lastOffsetX;
+				int lastY = blockY + lastOffsetY;
+				if (lastX >= 0 && lastY >= 0 && lastX < last.width && lastY < last.height)
+					current.emptyBlocks[blockX + blockY * current.width] = last.emptyBlocks[lastX + lastY * last.width];
+				else
+					update_block(grid, level, blockX, blockY);
+			}
+	}
+}
+
+void OccupancyPyramid::update_block(const MapGrid& grid, int level, int blockX, int blockY)
+{
+	bool empty = true;
+
+	if (level == 0)
+	{
+		//cells out of the map are solid, so blocks that exceed it are never empty
+		int side = 1 << levelShifts[0];
+		for (int y = m_originY + blockY * side; empty && y < m_originY + (blockY + 1) * side; ++y)
+			for (int x = m_originX + blockX * side; empty && x < m_originX + (blockX + 1) * side; ++x)
+				empty = !MapGrid::is_solid(grid.at(x, y));
+	}
+	else
+	{
+		const Level& finer = m_levels[level - 1];
+		int side = 1 << (levelShifts[level] - levelShifts[level - 1]);
+		for (int y = blockY * side; empty && y < (blockY + 1) * side; ++y)
+			for (int x = blockX * side; empty && x < (blockX + 1) * side; ++x)
+				empty = x < finer.width && y < finer.height && finer.emptyBlocks[x + y * finer.width];
+	}
+
+	m_levels[level].emptyBlocks[blockX + blockY * m_levels[level].width] = empty;
+}
@@ -1,12 +1,14 @@
 #include "pathFinder.hpp"
 #include <stack>
 
-PathFinder::PathFinder(int width, int height, const std::string& tiles, std::vector<std::pair<int, int>>& vec) :
-	m_width(width), m_height(height), m_tiles(tiles), m_solVec(vec) {}
+PathFinder::PathFinder(const MapGrid& tiles, std::vector<std::pair<int, int>>& vec) :
+	m_tiles(tiles), m_solVec(vec) {}
 
 bool PathFinder::find_path(int startX, int startY)
 {
 	m_solVec.clear();
+	if (!m_tiles.is_inside(startX, startY))
+		return false;
 	m_solVec.push_back({ startX, startY });
 	std::set<std::pair<int, int>> visitedTiles;
 	visitedTiles.insert({ startX, startY });
@@ -20,17 +22,18 @@ bool PathFinder::recursive_dfs(std::set<std::pair<int, int>>& visitedTiles)
 	std::pair<int, int> options[] = { { x + 1, y }, { x, y + 1 }, { x - 1, y }, { x, y - 1 } };
 	for (auto p : options)
 	{
-		if (!check_is_oob(p.first, p.second) && visitedTiles.find(p) == visitedTiles.end())
+		//cells out of the map are solid, the search can leave the resident cells of a chunked map
+		if (visitedTiles.find(p) == visitedTiles.end())
 		{
-			switch (m_tiles.at(p.first + p.second * m_width))
+			switch (m_tiles.at(p.first, p.second))
 			{
-			case ' ':
+			case MapGrid::Empty:
 				m_solVec.push_back({ p.first, p.second });
 				visitedTiles.insert(p);
 				if (recursive_dfs(visitedTiles))
 					return true;
 				break;
-			case 'g':
+			case MapGrid::Goal:
 				m_solVec.push_back({ p.first, p.second });
 				return true;
 				break;
@@ -41,9 +44,4 @@ bool PathFinder::recursive_dfs(std::set<std::pair<int, int>>& visitedTiles)
 	}
 	m_solVec.pop_back();
 	return false;
-}
-
-bool PathFinder::check_is_oob(int x, int y)
-{
-	return (x < 0 || y < 0 || x >= m_width || y >= m_height);
-}
+}
\ No newline at end of file
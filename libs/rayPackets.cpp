@@ -0,0 +1,203 @@
+#include "gameCore.hpp"
+
+#ifdef RCM_X86_SIMD
+#include <immintrin.h>
+
+using namespace rcm;
+
+//Packet versions of GameCore::view_walls_column(). Adjacent columns are walked together, one lane per ray:
+//every iteration each lane takes the same X or Y step the scalar loop would take, lanes that hit something
+//(or reach the max render distance) are masked off until the whole packet is done.
+//Lengths are computed from the steps count of each lane with the same operations of DDARay::length_x/y(),
+//so the results match the scalar loop.
+//Cells are read through their grid index: rays start inside the map and stop at the solid border, no bounds checks are needed.
+
+void GameCore::view_walls_packet_sse2(RayCamera& camera, int firstColumn, bool useCameraPlane)
+{
+	constexpr int lanes = 4;
+
+	const MapGrid& grid = m_gameMap.grid;
+	const unsigned char* cells = grid.data();
+
+	math::Vect2 rayDirs[lanes];
+	DDARay rays[lanes];
+
+	alignas(16) float firstX[lanes], firstY[lanes], incrementX[lanes], incrementY[lanes];
+	alignas(16) int cellStepX[lanes], cellIndex[lanes], cellStepY[lanes];
+
+	for (int l = 0; l < lanes; ++l)
+	{
+		rayDirs[l] = get_ray_direction(camera, firstColumn + l, useCameraPlane);
+		init_dda_ray(camera.transform.coordinates, rayDirs[l], rays[l]);
+
+		firstX[l] = rays[l].firstLengthX;
+		firstY[l] = rays[l].firstLengthY;
+		incrementX[l] = rays[l].lengthIncrementX;
+		incrementY[l] = rays[l].lengthIncrementY;
+		cellStepX[l] = rays[l].unitaryStepX;
+		cellIndex[l] = grid.index(rays[l].posInMap[0], rays[l].posInMap[1]);
+		cellStepY[l] = rays[l].unitaryStepY * grid.get_stride();
+	}
+
+	const __m128 firstXV = _mm_load_ps(firstX);
+	const __m128 firstYV = _mm_load_ps(firstY);
+	const __m128 incrementXV = _mm_load_ps(incrementX);
+	const __m128 incrementYV = _mm_load_ps(incrementY);
+	const __m128 maxDistV = _mm_set1_ps(camera.vars.maxRenderDist);
+
+	__m128i cellIndexV = _mm_load_si128((const __m128i*)cellIndex);
+	const __m128i cellStepXV = _mm_load_si128((const __m128i*)cellStepX);
+	const __m128i cellStepYV = _mm_load_si128((const __m128i*)cellStepY);
+
+	const __m128i solidBitV = _mm_set1_epi32(MapGrid::solidBit);
+	const __m128 oneV = _mm_set1_ps(1.f);
+
+	__m128 stepsXV = _mm_setzero_ps();
+	__m128 stepsYV = _mm_setzero_ps();
+
+	__m128i sideV = _mm_set1_epi32((int)CellSide::Unknown);
+	__m128i hitV = _mm_set1_epi32((int)HitType::Nothing);
+	__m128i activeV = _mm_set1_epi32(-1);
+
+	while (_mm_movemask_ps(_mm_castsi128_ps(activeV)) != 0)
+	{
+		//same comparisons of the scalar loop: X step if strictly shorter, stop if the next intersection is too far
+		__m128 lengthXV = _mm_add_ps(firstXV, _mm_mul_ps(stepsXV, incrementXV));
+		__m128 lengthYV = _mm_add_ps(firstYV, _mm_mul_ps(stepsYV, incrementYV));
+		__m128 takeXF = _mm_cmplt_ps(lengthXV, lengthYV);
+		__m128 nextLength = _mm_or_ps(_mm_and_ps(takeXF, lengthXV), _mm_andnot_ps(takeXF, lengthYV));
+		activeV = _mm_andnot_si128(_mm_castps_si128(_mm_cmpgt_ps(nextLength, maxDistV)), activeV);
+
+		__m128i takeX = _mm_castps_si128(takeXF);
+		__m128i movedX = _mm_and_si128(activeV, takeX);
+		__m128i movedY = _mm_andnot_si128(takeX, activeV);
+
+		cellIndexV = _mm_add_epi32(cellIndexV, _mm_or_si128(_mm_and_si128(cellStepXV, movedX), _mm_and_si128(cellStepYV, movedY)));
+		stepsXV = _mm_add_ps(stepsXV, _mm_and_ps(oneV, _mm_castsi128_ps(movedX)));
+		stepsYV = _mm_add_ps(stepsYV, _mm_and_ps(oneV, _mm_castsi128_ps(movedY)));
+
+		sideV = _mm_or_si128(_mm_andnot_si128(movedX, sideV), _mm_and_si128(movedX, _mm_set1_epi32((int)CellSide::Vert)));
+		sideV = _mm_or_si128(_mm_andnot_si128(movedY, sideV), _mm_and_si128(movedY, _mm_set1_epi32((int)CellSide::Hori)));
+
+		//sse2 has no gather, cells are fetched one lane at a time (lanes that are done just read their last cell again)
+		alignas(16) int lookupIndex[lanes], cellValue[lanes];
+		_mm_store_si128((__m128i*)lookupIndex, cellIndexV);
+		for (int l = 0; l < lanes; ++l)
+			cellValue[l] = cells[lookupIndex[l]];
+		__m128i cellV = _mm_load_si128((const __m128i*)cellValue);
+
+		//solid cells stop the ray, the hit type is the cell without the solid bit
+		__m128i hit = _mm_and_si128(activeV, _mm_cmpeq_epi32(_mm_and_si128(cellV, solidBitV), solidBitV));
+		hitV = _mm_or_si128(_mm_andnot_si128(hit, hitV), _mm_and_si128(hit, _mm_xor_si128(cellV, solidBitV)));
+
+		activeV = _mm_andnot_si128(hit, activeV);
+	}
+
+	alignas(16) int side[lanes], hitType[lanes], stepsX[lanes], stepsY[lanes];
+	_mm_store_si128((__m128i*)stepsX, _mm_cvtps_epi32(stepsXV));
+	_mm_store_si128((__m128i*)stepsY, _mm_cvtps_epi32(stepsYV));
+	_mm_store_si128((__m128i*)side, sideV);
+	_mm_store_si128((__m128i*)hitType, hitV);
+
+	for (int l = 0; l < lanes; ++l)
+	{
+		rays[l].stepsX = stepsX[l];
+		rays[l].stepsY = stepsY[l];
+		store_dda_ray(camera, firstColumn + l, rayDirs[l], rays[l], static_cast<HitType>(hitType[l]), static_cast<CellSide>(side[l]));
+	}
+}
+
+RCM_TARGET_AVX2 void GameCore::view_walls_packet_avx2(RayCamera& camera, int firstColumn, bool useCameraPlane)
+{
+	constexpr int lanes = 8;
+
+	const MapGrid& grid = m_gameMap.grid;
+	const unsigned char* cells = grid.data();
+
+	math::Vect2 rayDirs[lanes];
+	DDARay rays[lanes];
+
+	alignas(32) float firstX[lanes], firstY[lanes], incrementX[lanes], incrementY[lanes];
+	alignas(32) int cellStepX[lanes], cellIndex[lanes], cellStepY[lanes];
+
+	for (int l = 0; l < lanes; ++l)
+	{
+		rayDirs[l] = get_ray_direction(camera, firstColumn + l, useCameraPlane);
+		init_dda_ray(camera.transform.coordinates, rayDirs[l], rays[l]);
+
+		firstX[l] = rays[l].firstLengthX;
+		firstY[l] = rays[l].firstLengthY;
+		incrementX[l] = rays[l].lengthIncrementX;
+		incrementY[l] = rays[l].lengthIncrementY;
+		cellStepX[l] = rays[l].unitaryStepX;
+		cellIndex[l] = grid.index(rays[l].posInMap[0], rays[l].posInMap[1]);
+		cellStepY[l] = rays[l].unitaryStepY * grid.get_stride();
+	}
+
+	const __m256 firstXV = _mm256_load_ps(firstX);
+	const __m256 firstYV = _mm256_load_ps(firstY);
+	const __m256 incrementXV = _mm256_load_ps(incrementX);
+	const __m256 incrementYV = _mm256_load_ps(incrementY);
+	const __m256 maxDistV = _mm256_set1_ps(camera.vars.maxRenderDist);
+
+	__m256i cellIndexV = _mm256_load_si256((const __m256i*)cellIndex);
+	const __m256i cellStepXV = _mm256_load_si256((const __m256i*)cellStepX);
+	const __m256i cellStepYV = _mm256_load_si256((const __m256i*)cellStepY);
+
+	const __m256i byteMask = _mm256_set1_epi32(0xFF);
+	const __m256i solidBitV = _mm256_set1_epi32(MapGrid::solidBit);
+	const __m256 oneV = _mm256_set1_ps(1.f);
+
+	__m256 stepsXV = _mm256_setzero_ps();
+	__m256 stepsYV = _mm256_setzero_ps();
+
+	__m256i sideV = _mm256_set1_epi32((int)CellSide::Unknown);
+	__m256i hitV = _mm256_set1_epi32((int)HitType::Nothing);
+	__m256i activeV = _mm256_set1_epi32(-1);
+
+	while (!_mm256_testz_si256(activeV, activeV))
+	{
+		//same comparisons of the scalar loop: X step if strictly shorter, stop if the next intersection is too far
+		__m256 lengthXV = _mm256_add_ps(firstXV, _mm256_mul_ps(stepsXV, incrementXV));
+		__m256 lengthYV = _mm256_add_ps(firstYV, _mm256_mul_ps(stepsYV, incrementYV));
+		__m256 takeXF = _mm256_cmp_ps(lengthXV, lengthYV, _CMP_LT_OQ);
+		__m256 nextLength = _mm256_blendv_ps(lengthYV, lengthXV, takeXF);
+		activeV = _mm256_andnot_si256(_mm256_castps_si256(_mm256_cmp_ps(nextLength, maxDistV, _CMP_GT_OQ)), activeV);
+
+		__m256i takeX = _mm256_castps_si256(takeXF);
+		__m256i movedX = _mm256_and_si256(activeV, takeX);
+		__m256i movedY = _mm256_andnot_si256(takeX, activeV);
+
+		cellIndexV = _mm256_add_epi32(cellIndexV, _mm256_or_si256(_mm256_and_si256(cellStepXV, movedX), _mm256_and_si256(cellStepYV, movedY)));
+		stepsXV = _mm256_add_ps(stepsXV, _mm256_and_ps(oneV, _mm256_castsi256_ps(movedX)));
+		stepsYV = _mm256_add_ps(stepsYV, _mm256_and_ps(oneV, _mm256_castsi256_ps(movedY)));
+
+		sideV = _mm256_blendv_epi8(sideV, _mm256_set1_epi32((int)CellSide::Vert), movedX);
+		sideV = _mm256_blendv_epi8(sideV, _mm256_set1_epi32((int)CellSide::Hori), movedY);
+
+		//one byte per cell: gather 4 bytes from each cell index and keep the lowest (the grid is padded at the end)
+		__m256i cellV = _mm256_and_si256(byteMask,
+			_mm256_mask_i32gather_epi32(_mm256_setzero_si256(), (const int*)cells, cellIndexV, activeV, 1));
+
+		//solid cells stop the ray, the hit type is the cell without the solid bit
+		__m256i hit = _mm256_and_si256(activeV, _mm256_cmpeq_epi32(_mm256_and_si256(cellV, solidBitV), solidBitV));
+		hitV = _mm256_blendv_epi8(hitV, _mm256_xor_si256(cellV, solidBitV), hit);
+
+		activeV = _mm256_andnot_si256(hit, activeV);
+	}
+
+	alignas(32) int side[lanes], hitType[lanes], stepsX[lanes], stepsY[lanes];
+	_mm256_store_si256((__m256i*)stepsX, _mm256_cvtps_epi32(stepsXV));
+	_mm256_store_si256((__m256i*)stepsY, _mm256_cvtps_epi32(stepsYV));
+	_mm256_store_si256((__m256i*)side, sideV);
+	_mm256_store_si256((__m256i*)hitType, hitV);
+
+	for (int l = 0; l < lanes; ++l)
+	{
+		rays[l].stepsX = stepsX[l];
+		rays[l].stepsY = stepsY[l];
+		store_dda_ray(camera, firstColumn + l, rayDirs[l], rays[l], static_cast<HitType>(hitType[l]), static_cast<CellSide>(side[l]));
+	}
+}
+
+#endif
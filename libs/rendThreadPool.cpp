@@ -2,8 +2,7 @@
 
 //---------------------thread-pool--------------------------
 
-RendThreadPool::RendThreadPool(size_t num_threads) :
-    m_jobs(num_threads)
+RendThreadPool::RendThreadPool(size_t num_threads)
 {
     for (size_t i = 0; i < num_threads; ++i)
     {
@@ -15,8 +14,6 @@ RendThreadPool::RendThreadPool(size_t num_threads) :
                         std::unique_lock<std::mutex> lock(
                             m_queue_mutex);
 
-                        m_jobs--;
-
                         m_cv.wait(lock, [this] {
                             return (!m_tasks.empty() && m_jobs > 0) || m_stop;
                             });
@@ -30,6 +27,9 @@ RendThreadPool::RendThreadPool(size_t num_threads) :
                     }
 
                     (*(task))();
+
+                    //a job is done only once its section has been rendered
+                    m_jobs--;
                 }
             });
     }
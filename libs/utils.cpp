@@ -2,6 +2,11 @@
 #include <cmath>
 #include <thread>
 
+#if defined(RCM_X86_SIMD) && defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
 int debug::GameTimer::get_frame_rate()
 {
 	int fr = ((double)m_frameCounter / (double)(std::chrono::high_resolution_clock::now() - tStart).count()) * 1e9;
@@ -137,4 +142,30 @@ int utils::get_thread_number()
 {
 	int t = std::thread::hardware_concurrency();
 	return t == 0 ? 1 : t;
-}
\ No newline at end of file
+}
+
+utils::SimdLevel utils::get_simd_level()
+{
+#ifdef RCM_X86_SIMD
+#if defined(_MSC_VER) && !defined(__clang__)
+	int info[4]{};
+	__cpuid(info, 0);
+	if (info[0] >= 7)
+	{
+		bool osxsave = false;
+		__cpuid(info, 1);
+		osxsave = (info[2] & (1 << 27)) != 0;
+		__cpuidex(info, 7, 0);
+		//avx2 flag and ymm registers state saved by the os
+		if (osxsave && (info[1] & (1 << 5)) != 0 && (_xgetbv(0) & 0x6) == 0x6)
+			return SimdLevel::AVX2;
+	}
+#else
+	if (__builtin_cpu_supports("avx2"))
+		return SimdLevel::AVX2;
+#endif
+	return SimdLevel::SSE2;
+#else
+	return SimdLevel::Scalar;
+#endif
+}
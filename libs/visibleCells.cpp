@@ -0,0 +1,47 @@
+#include "visibleCells.hpp"
+
+void VisibleCells::reset(const MapGrid& grid, int sections)
+{
+	m_originX = grid.get_window_x();
+	m_originY = grid.get_window_y();
+	m_mapWidth = grid.get_width();
+	m_width = grid.get_window_width();
+	m_height = grid.get_window_height();
+	m_stride = grid.get_stride();
+
+	//value initialized: all stamps are 0
+	m_stamps = std::make_unique<std::atomic<unsigned int>[]>(m_stride * (m_height + 2));
+
+	m_frame = 1;
+	m_sectionCells.assign(sections, {});
+	m_cells.clear();
+}
+
+void VisibleCells::new_frame()
+{
+	if (++m_frame == 0)
+	{
+		//after a wrap around old stamps could match again
+		int size = m_stride * (m_height + 2);
+		for (int i = 0; i < size; ++i)
+			m_stamps[i].store(0, std::memory_order_relaxed);
+		m_frame = 1;
+	}
+
+	for (std::vector<int>& cells : m_sectionCells)
+		cells.clear();
+}
+
+void VisibleCells::end_frame()
+{
+	m_cells.clear();
+	for (const std::vector<int>& cells : m_sectionCells)
+		for (int gridIndex : cells)
+		{
+			//rays also reach the border around the resident cells
+			int x = gridIndex % m_stride - 1;
+			int y = gridIndex / m_stride - 1;
+			if (x >= 0 && y >= 0 && x < m_width && y < m_height)
+				m_cells.push_back((m_originX + x) + int64_t(m_originY + y) * m_mapWidth);
+		}
+}
@@ -0,0 +1,259 @@
+#include "gameCore.hpp"
+#include <cmath>
+#include <numeric>
+#include <algorithm>
+#include <limits>
+
+using namespace rcm;
+
+//Wall spans: instead of walking one ray per column, the solid cells around the camera are visited front to back
+//and the sides they show are projected on the screen, each one filling the columns it covers that are still empty.
+//A ray walk moves one cell at a time on the x or y axis, always away from its starting cell: every step increases
+//the manhattan distance (in cells) from the camera cell by one. Visiting the cells ring by ring (same manhattan distance)
+//is then a front to back order for every column, and the first side that covers a column is the one its ray would hit.
+//The ray of each column covered by a cell is checked with the same comparisons the walk would make to get into the cell,
+//and its state there is stored as the walk would: lengths, sides, hit positions and texture u are the ones of the walk,
+//bit by bit (also for the columns that hit nothing), and every renderer reading the rays of the camera works the same.
+
+void GameCore::set_wall_spans(bool wallSpans)
+{
+	for (std::unique_ptr<RayCamera>& camera : m_cameras)
+	{
+		camera->vars.wallSpans = wallSpans;
+		//the last rays could have been cast the other way
+		camera->rayCastState.valid = false;
+	}
+}
+
+int GameCore::next_uncovered_column(RayCamera& camera, int column)
+{
+	std::vector<int>& nextColumn = camera.spanNextColumn;
+
+	//path halving: the chains of covered columns get shorter every time they are walked
+	while (nextColumn[column] != column)
+	{
+		nextColumn[column] = nextColumn[nextColumn[column]];
+		column = nextColumn[column];
+	}
+	return column;
+}
+
+void GameCore::view_walls_spans(RayCamera& camera, bool useCameraPlane)
+{
+	const MapGrid& grid = m_gameMap.grid;
+	int width = camera.vars.pixelWidth;
+	float maxLength = camera.vars.maxRenderDist;
+
+	//every column points to itself until it is covered, the last one is the end of the screen
+	camera.spanNextColumn.resize(width + 1);
+	std::iota(camera.spanNextColumn.begin(), camera.spanNextColumn.end(), 0);
+	int uncovered = width;
+
+	int cameraCellX = (int)camera.transform.coordinates.x;
+	int cameraCellY = (int)camera.transform.coordinates.y;
+	//cells are read unchecked: the resident cells and their border (the whole map for maps kept in memory)
+	int firstX = grid.get_window_x() - 1, lastX = grid.get_window_x() + grid.get_window_width();
+	int firstY = grid.get_window_y() - 1, lastY = grid.get_window_y() + grid.get_window_height();
+
+	//a cell in the ring at distance d is at least (d - 2) / sqrt(2) away. Camera plane lengths are measured
+	//along the view direction: up to cos(fov / 2) shorter for the side columns
+	float lengthScale = useCameraPlane ? std::cos(camera.vars.fov / 2) : 1.f;
+	int lastRing = (int)std::ceil(maxLength * std::sqrt(2.f) / lengthScale) + 2;
+	//the border is the farthest cell that can be hit
+	int lastBorderRing = std::max(cameraCellX - firstX, lastX - cameraCellX) + std::max(cameraCellY - firstY, lastY - cameraCellY);
+	lastRing = std::min(lastRing, lastBorderRing);
+
+	for (int ring = 1; ring <= lastRing && uncovered > 0; ++ring)
+	{
+		int firstDx = std::max(-ring, firstX - cameraCellX);
+		int lastDx = std::min(ring, lastX - cameraCellX);
+
+		for (int dx = firstDx; dx <= lastDx; ++dx)
+		{
+			int dy = ring - std::abs(dx);
+			int cellX = cameraCellX + dx;
+
+			if (cameraCellY + dy <= lastY)
+				uncovered -= project_cell(camera, cellX, cameraCellY + dy, useCameraPlane);
+			if (dy != 0 && cameraCellY - dy >= firstY)
+				uncovered -= project_cell(camera, cellX, cameraCellY - dy, useCameraPlane);
+		}
+	}
+
+	//nothing is closer than maxLength on the columns left, their walk stops at the last intersection before it
+	for (int column = next_uncovered_column(camera, 0); column < width; column = next_uncovered_column(camera, column + 1))
+	{
+		math::Vect2 currentRayDir = get_ray_direction(camera, column, useCameraPlane);
+		DDARay ray;
+		init_dda_ray(camera.transform.coordinates, currentRayDir, ray);
+
+		CellSide side = CellSide::Unknown;
+		walk_to_length(ray, maxLength, side);
+		store_dda_ray(camera, column, currentRayDir, ray, HitType::Nothing, side);
+	}
+}
+
+int GameCore::project_cell(RayCamera& camera, int cellX, int cellY, bool useCameraPlane)
+{
+	const MapGrid& grid = m_gameMap.grid;
+
+	unsigned char cell = grid.at_unchecked(cellX, cellY);
+	if (!MapGrid::is_solid(cell))
+		return 0;
+
+	const math::Vect2& position = camera.transform.coordinates;
+	int cameraCellX = (int)position.x;
+	int cameraCellY = (int)position.y;
+	//direction a ray has to move on each axis to reach the cell, 0 if it starts in the same column (or row) of cells
+	int stepX = (cellX > cameraCellX) - (cellX < cameraCellX);
+	int stepY = (cellY > cameraCellY) - (cellY < cameraCellY);
+
+	//rays can only enter through the sides that face the camera cell, coming from an empty cell:
+	//if both neighbours are solid every ray that reaches the cell hits one of them first
+	bool openX = stepX != 0 && !MapGrid::is_solid(grid.at_unchecked(cellX - stepX, cellY));
+	bool openY = stepY != 0 && !MapGrid::is_solid(grid.at_unchecked(cellX, cellY - stepY));
+	if (!openX && !openY)
+		return 0;
+
+	int firstColumn = 0, lastColumn = 0;
+	if (!get_cell_columns(camera, cellX, cellY, useCameraPlane, firstColumn, lastColumn))
+		return 0;
+
+	HitType hitMarker = static_cast<HitType>(MapGrid::to_char(cell));
+	float maxLength = camera.vars.maxRenderDist;
+	int covered = 0;
+
+	for (int column = next_uncovered_column(camera, firstColumn); column <= lastColumn; column = next_uncovered_column(camera, column + 1))
+	{
+		math::Vect2 currentRayDir = get_ray_direction(camera, column, useCameraPlane);
+		DDARay ray;
+		init_dda_ray(position, currentRayDir, ray);
+
+		CellSide side = CellSide::Unknown;
+		if (!is_cell_reached(ray, cellX - cameraCellX, cellY - cameraCellY, maxLength, side))
+			continue;
+
+		//the walk stops inside the cell, after crossing the intersections between it and the camera cell
+		ray.stepsX = std::abs(cellX - cameraCellX);
+		ray.stepsY = std::abs(cellY - cameraCellY);
+		store_dda_ray(camera, column, currentRayDir, ray, hitMarker, side);
+		camera.spanNextColumn[column] = column + 1;
+		++covered;
+	}
+	return covered;
+}
+
+bool GameCore::is_cell_reached(const DDARay& ray, int cellDx, int cellDy, float maxLength, CellSide& side)
+{
+	//the walk only moves towards the side the ray points to
+	if ((cellDx != 0 && (cellDx > 0) != (ray.unitaryStepX > 0)) || (cellDy != 0 && (cellDy > 0) != (ray.unitaryStepY > 0)))
+		return false;
+
+	//the cell is reached after crossing stepsX x intersections and stepsY y ones. The walk takes the x intersection
+	//only if it is strictly shorter: every crossed one has to come before the next one on the other axis
+	int stepsX = std::abs(cellDx);
+	int stepsY = std::abs(cellDy);
+	if (stepsX > 0 && !(ray.length_x(stepsX - 1) < ray.length_y(stepsY)))
+		return false;
+	if (stepsY > 0 && !(ray.length_y(stepsY - 1) <= ray.length_x(stepsX)))
+		return false;
+
+	//entered from the last intersection crossed
+	if (stepsY == 0 || (stepsX > 0 && ray.length_y(stepsY - 1) <= ray.length_x(stepsX - 1)))
+		side = CellSide::Vert;
+	else
+		side = CellSide::Hori;
+
+	float entryLength = side == CellSide::Vert ? ray.length_x(stepsX - 1) : ray.length_y(stepsY - 1);
+	return entryLength <= maxLength;
+}
+
+void GameCore::walk_to_length(DDARay& ray, float maxLength, CellSide& side)
+{
+	//the walk crosses every intersection not longer than maxLength, on both axes. Lengths grow with the steps:
+	//the count is estimated, then fixed with the same comparisons
+	auto count_crossed = [maxLength](auto length, float first, float increment) -> int
+		{
+			float estimate = (maxLength - first) / increment;
+			int steps = estimate > 0 ? (int)estimate : 0;
+			while (steps > 0 && length(steps - 1) > maxLength)
+				--steps;
+			while (length(steps) <= maxLength)
+				++steps;
+			return steps;
+		};
+
+	ray.stepsX = count_crossed([&ray](int steps) { return ray.length_x(steps); }, ray.firstLengthX, ray.lengthIncrementX);
+	ray.stepsY = count_crossed([&ray](int steps) { return ray.length_y(steps); }, ray.firstLengthY, ray.lengthIncrementY);
+
+	//the last one crossed, an x intersection comes after a y one of the same length
+	if (ray.stepsX == 0 && ray.stepsY == 0)
+		side = CellSide::Unknown;
+	else if (ray.stepsY == 0 || (ray.stepsX > 0 && ray.length_y(ray.stepsY - 1) <= ray.length_x(ray.stepsX - 1)))
+		side = CellSide::Vert;
+	else
+		side = CellSide::Hori;
+}
+
+bool GameCore::get_cell_columns(const RayCamera& camera, int cellX, int cellY, bool useCameraPlane, int& firstColumn, int& lastColumn) const
+{
+	const math::Vect2& position = camera.transform.coordinates;
+	int width = camera.vars.pixelWidth;
+	float fov = camera.vars.fov;
+	float halfPlane = std::tan(fov / 2);
+
+	//corners in view space (along the view direction and to its left), in order around the cell
+	const math::Vect2 corners[4] = { { (float)cellX, (float)cellY }, { (float)cellX + 1, (float)cellY },
+									 { (float)cellX + 1, (float)cellY + 1 }, { (float)cellX, (float)cellY + 1 } };
+	float foreward[4], left[4];
+	bool behind = true, outLeft = true, outRight = true;
+	for (int c = 0; c < 4; ++c)
+	{
+		math::Vect2 relative = corners[c] - position;
+		foreward[c] = relative.x * camera.viewForeward.x + relative.y * camera.viewForeward.y;
+		left[c] = relative.x * camera.viewLeft.x + relative.y * camera.viewLeft.y;
+		behind = behind && foreward[c] <= 0;
+		outLeft = outLeft && left[c] > foreward[c] * halfPlane;
+		outRight = outRight && -left[c] > foreward[c] * halfPlane;
+	}
+
+	//behind the camera or out of one of the view edges (fov is below 180 degrees)
+	if (behind || outLeft || outRight)
+		return false;
+
+	float minColumn = float(width), maxColumn = 0.f;
+	auto add_column = [&](float column)
+		{
+			//corners almost on the camera plane go very far out of the screen
+			column = std::clamp(column, 0.f, float(width));
+			minColumn = std::min(minColumn, column);
+			maxColumn = std::max(maxColumn, column);
+		};
+
+	for (int c = 0; c < 4; ++c)
+	{
+		if (foreward[c] > 0)
+		{
+			if (useCameraPlane)
+				add_column((1 - (left[c] / foreward[c]) / halfPlane) * width / 2);
+			else
+				add_column((fov / 2 - std::atan2(left[c], foreward[c])) * width / fov);
+		}
+
+		//an edge that goes behind the camera reaches the screen border on the side it crosses the camera at
+		int next = (c + 1) % 4;
+		if ((foreward[c] > 0) != (foreward[next] > 0))
+		{
+			float crossLeft = left[c] + (left[next] - left[c]) * foreward[c] / (foreward[c] - foreward[next]);
+			if (crossLeft >= 0)
+				add_column(0.f);
+			if (crossLeft <= 0)
+				add_column(float(width));
+		}
+	}
+
+	//one more column on each end, every column is then checked against the cell
+	firstColumn = std::max(0, (int)std::floor(minColumn) - 1);
+	lastColumn = std::min(width - 1, (int)std::ceil(maxColumn) + 1);
+	return firstColumn <= lastColumn;
+}
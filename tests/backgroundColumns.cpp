@@ -0,0 +1,169 @@
+//In linear perspective the view sections draw floor, ceiling and sky only on the rows the walls of their rays leave uncovered
+//(GameGraphics::draw_background_columns()). Frames must be the same, bit by bit, of the ones drawn in separate passes: whole floor
+//rows, then whole ceiling or sky rows, then every wall column on top of them. Checked with walls written straight into the view
+//and in columns, stretched rays, walls with clear texels, sky and ceiling, and shading from rows shaded to black to almost none.
+//Textures are loaded from the assets folder copied in the build directory
+
+#include "gameGraphics.hpp"
+#include "testMaps.hpp"
+#include <climits>
+#include <iostream>
+
+using namespace rcm;
+using namespace testMaps;
+using namespace windowVars;
+
+namespace
+{
+	//render widths: one ray per view column, then stretched rays
+	const int g_renderWidths[] = { g_windowWidth, 1000, g_windowWidth / 2 };
+	//a wall texture without and one with clear texels (and a height that is not a power of two)
+	const char* const g_wallTextures[] = { "assets/wall2.png", "assets/heart.png" };
+	constexpr float g_renderDistance = 20.f;
+	//never below the render distance (as in the game). Rows past it are black, then the gradient is stretched to almost no shading
+	const float g_sightDepths[] = { g_renderDistance, 3 * g_renderDistance, 1e6f };
+
+	struct WallPath
+	{
+		const char* name;
+		int columnMajorWallsMinHeight;
+	};
+
+	const WallPath g_wallPaths[] = {
+		{ "rows", INT_MAX },
+		{ "columns", 0 },
+	};
+
+	//same stretch of the view sections: a ray is drawn on every view column that samples it
+	int first_view_column(int ray, int rayColumns, int viewColumns)
+	{
+		return (ray * viewColumns + rayColumns - 1) / rayColumns;
+	}
+
+	//floor, ceiling and sky drawn whole, walls drawn over them column by column
+	void draw_separate_passes(const RayInfoArr& rays, GameView& view, WallColumns& columns, const GraphicsVars& graphicsVars, const BackgroundRows& background, const StaticTextures& textures, const EntityTransform& transform)
+	{
+		const BackgroundVars& bgVars = background.get_vars();
+		for (int y = view.m_height / 2; y < view.m_height; ++y)
+		{
+			if (background.get_row(y).pixels != nullptr)
+				GameGraphics::draw_background_span(background.get_row(y), 0, view.m_width, bgVars, background.get_sky_columns());
+		}
+		for (int y = 0; y < view.m_height / 2; ++y)
+			GameGraphics::draw_background_span(background.get_row(y), 0, view.m_width, bgVars, background.get_sky_columns());
+
+		int rayColumns = rays.get_size();
+		for (int ray = 0; ray < rayColumns; ++ray)
+			for (int x = first_view_column(ray, rayColumns, view.m_width); x < first_view_column(ray + 1, rayColumns, view.m_width); ++x)
+				GameGraphics::draw_wall_column(ray, true, rays, view.m_pixels + x * 4, view.m_width * 4, columns, graphicsVars, background.get_row_tables(), textures, transform);
+	}
+
+	//three sections of uneven sizes, so that groups of rays don't start at multiples of their size
+	void draw_sections(const RayInfoArr& rays, GameView& view, WallColumns& columns, const GraphicsVars& graphicsVars, const BackgroundRows& background, const StaticTextures& textures, const EntityTransform& transform)
+	{
+		int rayColumns = rays.get_size();
+		const int bounds[] = { 0, rayColumns * 5 / 17, rayColumns * 11 / 17, rayColumns };
+		for (int section = 0; section < 3; ++section)
+			GameGraphics::draw_view_section(bounds[section], bounds[section + 1], true, rays, view, columns, graphicsVars, background, textures, transform);
+	}
+
+	int check_frames(GameMap& map, int frames, std::mt19937& randGen)
+	{
+		RendThreadPool rendThreadPool(1);
+		GameCameraVars cameraVars;
+		cameraVars.pixelWidth = g_windowWidth;
+		cameraVars.pixelHeight = g_windowHeight;
+		cameraVars.fov = math::deg_to_rad(90);
+		cameraVars.maxRenderDist = g_renderDistance;
+		EntityTransform transform;
+		GameCore core(cameraVars, map, transform, rendThreadPool);
+		GameCameraView camera{ transform, core.get_camera_vars(), core.get_camera_vecs() };
+		const RayInfoArr& rays = core.get_ray_info_arr();
+
+		StaticTextures textures[2];
+		for (int i = 0; i < 2; ++i)
+		{
+			textures[i].wallTexture.create(g_wallTextures[i], true, true);
+			textures[i].baundryTexture.create("assets/boundry2.png", true, true);
+			textures[i].floorTexture.create("assets/floor2.png", false, true);
+			textures[i].ceilingTexture.create("assets/ceiling2.png", false, true);
+			textures[i].skyTexture.create("assets/sky.png");
+		}
+
+		GameView separate, fused;
+		separate.create(g_windowWidth, g_windowHeight, true);
+		fused.create(g_windowWidth, g_windowHeight, true);
+		//each view has its own rows, they point to its pixels
+		BackgroundRows separateBackground, fusedBackground;
+		WallColumns separateColumns, fusedColumns;
+		separateColumns.create(rays.get_capacity(), g_windowHeight);
+		fusedColumns.create(rays.get_capacity(), g_windowHeight);
+		GameStateVars state;
+		GraphicsVars graphicsVars;
+		graphicsVars.mipmaps = true;
+
+		std::uniform_real_distribution<float> angle(-PI, PI);
+		int errors = 0;
+		for (int frame = 0; frame < frames; ++frame)
+		{
+			transform = { free_position(map, randGen), angle(randGen) };
+			state.drawSky = frame % 2 == 1;
+			graphicsVars.maxSightDepth = g_sightDepths[frame % 3];
+
+			for (int renderWidth : g_renderWidths)
+			{
+				core.set_render_width(renderWidth);
+				core.view_by_ray_casting(true);
+
+				for (int tex = 0; tex < 2; ++tex)
+				{
+					separateBackground.set_target(&separate, &textures[tex], &state, &graphicsVars, &camera);
+					fusedBackground.set_target(&fused, &textures[tex], &state, &graphicsVars, &camera);
+
+					for (const WallPath& path : g_wallPaths)
+					{
+						graphicsVars.columnMajorWallsMinHeight = path.columnMajorWallsMinHeight;
+						//pixels left unwritten by either pass differ
+						std::memset(separate.m_pixels, 0x11, g_windowWidth * g_windowHeight * 4);
+						std::memset(fused.m_pixels, 0xEE, g_windowWidth * g_windowHeight * 4);
+						draw_separate_passes(rays, separate, separateColumns, graphicsVars, separateBackground, textures[tex], transform);
+						draw_sections(rays, fused, fusedColumns, graphicsVars, fusedBackground, textures[tex], transform);
+
+						int mismatches = 0;
+						for (int pixel = 0; pixel < g_windowWidth * g_windowHeight; ++pixel)
+							mismatches += std::memcmp(separate.m_pixels + pixel * 4, fused.m_pixels + pixel * 4, 4) != 0;
+						if (mismatches == 0)
+							continue;
+						std::cerr << "frame " << frame << " (" << renderWidth << " rays, " << g_wallTextures[tex] << ", walls in " << path.name
+							<< (state.drawSky ? ", sky" : ", ceiling") << ", sight depth " << graphicsVars.maxSightDepth << "): "
+							<< mismatches << " pixels differ from the separate passes\n";
+						++errors;
+					}
+				}
+			}
+		}
+		return errors;
+	}
+}
+
+int main()
+{
+	std::mt19937 randGen(31);
+	int errors = 0;
+
+	GameMap maze;
+	generate_maze(maze, 41, 31);
+	errors += check_frames(maze, 6, randGen);
+
+	GameMap scattered;
+	generate_scattered(scattered, 96, 96, randGen);
+	errors += check_frames(scattered, 6, randGen);
+
+	if (errors != 0)
+	{
+		std::cerr << errors << " frames differ from the separate passes\n";
+		return 1;
+	}
+	std::cout << "background drawn around the walls matches the separate passes\n";
+	return 0;
+}
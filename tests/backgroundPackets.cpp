@@ -0,0 +1,143 @@
+//Floor and ceiling pixels drawn in packets (SSE2, AVX2) must be the same, bit by bit, of the ones drawn one by one,
+//and every one of them must be the texel darkened by the row shading, round(channel * shade / 255), and opaque.
+//Textures are loaded from the assets folder copied in the build directory
+
+#include "gameGraphics.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <random>
+
+using namespace windowVars;
+
+namespace
+{
+	struct PacketMode
+	{
+		const char* name;
+		utils::SimdLevel simdLevel;
+	};
+
+	const PacketMode g_modes[] = {
+		{ "scalar", utils::SimdLevel::Scalar },
+		{ "sse2", utils::SimdLevel::SSE2 },
+		{ "avx2", utils::SimdLevel::AVX2 },
+	};
+	constexpr int g_modesNumber = sizeof(g_modes) / sizeof(g_modes[0]);
+
+	//modes the cpu can run
+	int available_modes()
+	{
+		return std::min(g_modesNumber, static_cast<int>(utils::get_simd_level()) + 1);
+	}
+
+	void draw_row(BackgroundRow& row, sf::Uint8* pixels, int startX, int endX, utils::SimdLevel simdLevel)
+	{
+		BackgroundVars bgVars;
+		bgVars.simdLevel = simdLevel;
+		row.pixels = pixels;
+		GameGraphics::draw_background_span(row, startX, endX, bgVars, nullptr);
+	}
+
+	//rows that show a single texel, at every shade: pixels that differ from the rounded product
+	int check_shading(const Texture& texture)
+	{
+		int mismatches = 0;
+		std::vector<sf::Uint8> pixels(16 * 4);
+		for (int mode = 0; mode < available_modes(); ++mode)
+			for (int v = 0; v < texture.height(); ++v)
+				for (int u = 0; u < texture.width(); ++u)
+					for (int shade = 0; shade < 256; ++shade)
+					{
+						BackgroundRow row;
+						row.start = { (u + 0.5f) / texture.width(), (v + 0.5f) / texture.height() };
+						row.shading = static_cast<sf::Uint8>(shade);
+						row.texture = &texture;
+						draw_row(row, pixels.data(), 0, 16, g_modes[mode].simdLevel);
+
+						const sf::Uint8* texel = texture.m_texturePixels + (v * texture.width() + u) * 4;
+						for (int x = 0; x < 16; ++x)
+						{
+							const sf::Uint8* pixel = pixels.data() + x * 4;
+							bool same = pixel[3] == 0xFF;
+							//channel * shade / 255 is never half way between two integers
+							for (int c = 0; c < 3; ++c)
+								same = same && pixel[c] == (2 * texel[c] * shade + 255) / 510;
+							if (same)
+								continue;
+							if (mismatches < 10)
+								std::cerr << g_modes[mode].name << ": texel " << u << ", " << v << " at shade " << shade << " differs\n";
+							++mismatches;
+						}
+					}
+		return mismatches;
+	}
+
+	//rows seen from random places, also with negative positions, drawn on random spans: pixels that differ from the scalar ones
+	int compare_modes(const Texture& texture, int rows, std::mt19937& randGen)
+	{
+		std::uniform_real_distribution<float> position(-200.f, 200.f), increment(-0.05f, 0.05f);
+		std::uniform_int_distribution<> shade(0, 255), column(0, g_windowWidth);
+		std::vector<sf::Uint8> reference(g_windowWidth * 4), pixels(g_windowWidth * 4);
+
+		int mismatches = 0;
+		for (int i = 0; i < rows; ++i)
+		{
+			BackgroundRow row;
+			row.start = { position(randGen), position(randGen) };
+			row.increment = { increment(randGen), increment(randGen) };
+			row.shading = static_cast<sf::Uint8>(shade(randGen));
+			row.texture = &texture;
+
+			int startX = column(randGen);
+			int endX = column(randGen);
+			if (i % 3 == 0)
+				startX = 0, endX = g_windowWidth;
+			if (startX > endX)
+				std::swap(startX, endX);
+
+			std::fill(reference.begin(), reference.end(), 0);
+			draw_row(row, reference.data(), startX, endX, utils::SimdLevel::Scalar);
+			for (int mode = 1; mode < available_modes(); ++mode)
+			{
+				std::fill(pixels.begin(), pixels.end(), 0);
+				draw_row(row, pixels.data(), startX, endX, g_modes[mode].simdLevel);
+				for (int x = 0; x < g_windowWidth; ++x)
+				{
+					if (std::memcmp(reference.data() + x * 4, pixels.data() + x * 4, 4) == 0)
+						continue;
+					if (mismatches < 10)
+						std::cerr << g_modes[mode].name << ": pixel " << x << " of row " << i << " differs\n";
+					++mismatches;
+				}
+			}
+		}
+		return mismatches;
+	}
+}
+
+int main()
+{
+	std::cout << "cpu support: " << static_cast<int>(utils::get_simd_level()) << " (0 scalar, 1 SSE2, 2 AVX2)\n";
+
+	Texture floorTexture, ceilingTexture;
+	floorTexture.create("assets/floor1.png", false, true);
+	ceilingTexture.create("assets/ceiling2.png");
+
+	std::mt19937 randGen(7);
+	int mismatches = 0;
+
+	mismatches += check_shading(ceilingTexture);
+	mismatches += compare_modes(ceilingTexture, 2000, randGen);
+	//smaller levels have other widths and heights
+	for (int level = 0; level < 4; ++level)
+		mismatches += compare_modes(floorTexture.get_mip(level), 500, randGen);
+
+	if (mismatches != 0)
+	{
+		std::cerr << mismatches << " pixels differ from the shaded texels\n";
+		return 1;
+	}
+	std::cout << "background packets match the scalar pixels\n";
+	return 0;
+}
@@ -0,0 +1,153 @@
+//A camera added to the core is rendered by GameGraphics in its own buffer, pixelWidth columns by the rows of its viewport,
+//in the same batches of the main view. Seen from the same transform, with the same vars and a viewport that covers the window,
+//its buffer must be the main view one, bit by bit: walls, floor, ceiling, sky and sprites (the billboards the core places for it).
+//A smaller camera (half the columns and half the rows) must be, bit by bit, the same camera rendered on its own: the main camera of
+//another core, drawn by a single view section and a single sprite section on a buffer of that size.
+//Views are only rendered, never drawn: no window is opened. Textures are loaded from the assets folder copied in the build directory
+
+#include "testViews.hpp"
+#include <iostream>
+
+using namespace rcm;
+using namespace testMaps;
+using namespace testViews;
+using namespace windowVars;
+
+namespace
+{
+	GameMap copy_map(const GameMap& map)
+	{
+		GameMap copy;
+		copy.width = map.width;
+		copy.height = map.height;
+		copy.cells = std::make_unique<std::string>(*map.cells);
+		return copy;
+	}
+
+	int check_cameras(GameMap& map, float maxRenderDist, int frames, std::mt19937& randGen)
+	{
+		RendThreadPool rendThreadPool(4);
+		GameCameraVars cameraVars;
+		cameraVars.pixelWidth = g_windowWidth;
+		cameraVars.pixelHeight = g_windowHeight;
+		cameraVars.fov = math::deg_to_rad(90);
+		cameraVars.maxRenderDist = maxRenderDist;
+		EntityTransform transform;
+		GameCore core(cameraVars, map, transform, rendThreadPool);
+		GameCameraView mainCamera{ transform, core.get_camera_vars(), core.get_camera_vecs() };
+
+		//never opened: views are only rendered
+		sf::RenderWindow window;
+		GraphicsVars graphicsVars;
+		graphicsVars.maxSightDepth = maxRenderDist;
+		graphicsVars.mipmaps = true;
+		GameStateVars state;
+		GameGraphics graphics(window, graphicsVars, rendThreadPool);
+		graphics.create_assets(g_assets, map, graphicsVars, core.get_ray_info_arr(), state, mainCamera);
+		for (int id = 0; id < g_spriteTexturesNumber; ++id)
+			graphics.load_sprite(id, g_spriteTextures[id]);
+		std::vector<std::unique_ptr<Texture>> spriteTextures = load_sprite_textures();
+
+		//same camera of the main view, drawn over the whole window
+		EntityTransform fullTransform;
+		int full = core.add_camera(cameraVars, fullTransform);
+		graphics.add_camera_view(GameCameraView{ fullTransform, core.get_camera_vars(full), core.get_camera_vecs(full) },
+			core.get_ray_info_arr(full), core.get_camera_billboards(full), ViewportRect{});
+
+		//half the columns, in the bottom right quarter of the window
+		EntityTransform halfTransform;
+		GameCameraVars halfVars = cameraVars;
+		halfVars.pixelWidth = g_windowWidth / 2;
+		int half = core.add_camera(halfVars, halfTransform);
+		graphics.add_camera_view(GameCameraView{ halfTransform, core.get_camera_vars(half), core.get_camera_vecs(half) },
+			core.get_ray_info_arr(half), core.get_camera_billboards(half), ViewportRect{ 0.5f, 0.5f, 0.5f, 0.5f });
+
+		//the half size camera as the main camera of its own core
+		GameMap referenceMap = copy_map(map);
+		EntityTransform referenceTransform;
+		GameCore referenceCore(halfVars, referenceMap, referenceTransform, rendThreadPool);
+		StaticTextures textures;
+		load_textures(textures);
+		SingleCameraRender reference(GameCameraView{ referenceTransform, referenceCore.get_camera_vars(), referenceCore.get_camera_vecs() },
+			referenceCore.get_ray_info_arr(), textures, state, graphicsVars, g_windowHeight / 2);
+
+		if (graphics.get_view(full).m_width != g_windowWidth || graphics.get_view(full).m_height != g_windowHeight ||
+			graphics.get_view(half).m_width != g_windowWidth / 2 || graphics.get_view(half).m_height != g_windowHeight / 2)
+		{
+			std::cerr << "camera views are not sized to their render width and viewport\n";
+			return 1;
+		}
+
+		//overlapping sprites of both textures, at every alignment
+		const SpriteAlignment alignments[] = { SpriteAlignment::TopWindow, SpriteAlignment::Ceiling, SpriteAlignment::Center, SpriteAlignment::Floor, SpriteAlignment::BottomWindow };
+		std::vector<SpriteEntity*> entities, referenceEntities;
+		for (int i = 0; i < 24; ++i)
+		{
+			entities.push_back(new SpriteEntity(transform, i % 2, alignments[i % 5], 0.4f + (i % 4) * 0.3f));
+			core.add_entity(entities.back());
+			referenceEntities.push_back(new SpriteEntity(transform, i % 2, alignments[i % 5], 0.4f + (i % 4) * 0.3f));
+			referenceCore.add_entity(referenceEntities.back());
+		}
+
+		std::uniform_real_distribution<float> angle(-PI, PI), offset(-4.f, 4.f);
+		int errors = 0;
+		for (int frame = 0; frame < frames; ++frame)
+		{
+			transform.coordinates = free_position(map, randGen);
+			transform.forewardAngle = angle(randGen);
+			fullTransform = transform;
+			halfTransform = transform;
+			referenceTransform = transform;
+			for (int i = 0; i < (int)entities.size(); ++i)
+			{
+				entities[i]->m_transform = { transform.coordinates + math::Vect2{ offset(randGen), offset(randGen) }, angle(randGen) };
+				referenceEntities[i]->m_transform = entities[i]->m_transform;
+			}
+
+			state.isLinearPersp = frame % 2 == 0;
+			state.drawSky = frame % 4 < 2;
+			core.view_by_ray_casting(state.isLinearPersp);
+			graphics.render_views(core.get_entities());
+			referenceCore.view_by_ray_casting(state.isLinearPersp);
+			reference.render_view();
+			reference.render_sprites(entity_billboards(referenceCore.get_entities()), spriteTextures, false);
+
+			const char* perspective = state.isLinearPersp ? "linear" : "non linear";
+			int fullMismatches = count_mismatches(graphics.get_view(full), graphics.get_view(0));
+			if (fullMismatches != 0)
+			{
+				std::cerr << "frame " << frame << " (" << perspective << " perspective): " << fullMismatches << " pixels of the full size camera differ from the main view\n";
+				++errors;
+			}
+			int halfMismatches = count_mismatches(graphics.get_view(half), reference.view);
+			if (halfMismatches != 0)
+			{
+				std::cerr << "frame " << frame << " (" << perspective << " perspective): " << halfMismatches << " pixels of the half size camera differ from its single camera render\n";
+				++errors;
+			}
+		}
+		return errors;
+	}
+}
+
+int main()
+{
+	std::mt19937 randGen(11);
+	int errors = 0;
+
+	GameMap maze;
+	generate_maze(maze, 41, 31);
+	errors += check_cameras(maze, 20.f, 16, randGen);
+
+	GameMap scattered;
+	generate_scattered(scattered, 96, 96, randGen);
+	errors += check_cameras(scattered, 40.f, 16, randGen);
+
+	if (errors != 0)
+	{
+		std::cerr << errors << " camera views differ from single camera renders\n";
+		return 1;
+	}
+	std::cout << "camera views match single camera renders from the same transform\n";
+	return 0;
+}
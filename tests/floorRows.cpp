@@ -0,0 +1,153 @@
+//Floor and ceiling rows read their distance and shading from FloorRowTables, rebuilt when the graphics vars or the view height change.
+//Every entry must be the same, bit by bit, of the per row division it replaces: the one of the background pass,
+//height * halfWallHeight / (height - 2 * row), and the one of the non linear floor, computed on the row offset in bytes.
+//The rows of a BackgroundRows must be placed and shaded from the same distances, also after the vars change.
+//Textures are loaded from the assets folder copied in the build directory
+
+#include "gameGraphics.hpp"
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <memory>
+
+using namespace rcm;
+using namespace windowVars;
+
+namespace
+{
+	struct RowVars
+	{
+		float halfWallHeight;
+		float maxSightDepth;
+		int viewHeight;
+	};
+
+	//one var changes at each step (or none: the tables are kept)
+	const RowVars g_steps[] = {
+		{ 0.5f, 20.f, g_windowHeight },
+		{ 0.5f, 60.f, g_windowHeight },
+		{ 0.7f, 60.f, g_windowHeight },
+		{ 0.7f, 60.f, 433 },
+		{ 0.7f, 1e6f, 433 },
+		{ 0.7f, 1e6f, 433 },
+		{ 0.5f, 1e6f, 1440 },
+		{ 0.5f, 3.f, 1440 },
+		{ 0.5f, 3.f, g_windowHeight },
+	};
+
+	sf::Uint8 row_shading(float distance, float maxSightDepth)
+	{
+		sf::Uint8 shading = 0x0;
+		if (distance <= maxSightDepth)
+			shading = 0xFF * (1 - (distance / maxSightDepth));
+		return shading;
+	}
+
+	bool same_float(float a, float b)
+	{
+		return std::memcmp(&a, &b, sizeof(float)) == 0;
+	}
+
+	//entries that differ from the per row divisions
+	int check_tables(const FloorRowTables& tables, const RowVars& vars)
+	{
+		int mismatches = 0;
+		int height = vars.viewHeight;
+		for (int y = 0; y <= height / 2; ++y)
+		{
+			float background = (height * vars.halfWallHeight) / (height - (2.f * y));
+			//non linear walls step the rows by their offset in bytes
+			int rowOffset = y * 4;
+			float nonLinear = (height * vars.halfWallHeight) / (height - (0.5f * rowOffset));
+
+			bool same = tables.distance.size() == height / 2 + 1 && tables.shading.size() == height / 2 + 1 &&
+				same_float(tables.distance[y], background) && same_float(tables.distance[y], nonLinear) &&
+				tables.shading[y] == row_shading(background, vars.maxSightDepth);
+			if (same)
+				continue;
+			if (mismatches < 10)
+				std::cerr << "row " << y << " of " << height << " (half wall " << vars.halfWallHeight << ", sight depth " << vars.maxSightDepth << ") differs from the division\n";
+			++mismatches;
+		}
+		return mismatches;
+	}
+
+	//rows of the upper half and of the lower half that differ from the ones placed and shaded with the per row division
+	int check_rows(const BackgroundRows& background, const RowVars& vars, const GameCameraView& camera)
+	{
+		math::Vect2 leftmostRayDir = camera.vecs.forewardDirection - camera.vecs.plane / 2;
+		math::Vect2 rightmostRayDir = camera.vecs.forewardDirection + camera.vecs.plane / 2;
+		int height = vars.viewHeight;
+		int width = background.get_view_width();
+
+		int mismatches = 0;
+		for (int y = 0; y < height / 2; ++y)
+		{
+			float rayLength = (height * vars.halfWallHeight) / (height - (2.f * y));
+			math::Vect2 start = camera.transform.coordinates + (leftmostRayDir * rayLength);
+			math::Vect2 increment = ((rightmostRayDir - leftmostRayDir) * rayLength) / width;
+			sf::Uint8 shading = row_shading(rayLength, vars.maxSightDepth);
+
+			for (int viewRow : { y, height - y - 1 })
+			{
+				const BackgroundRow& row = background.get_row(viewRow);
+				bool same = same_float(row.start.x, start.x) && same_float(row.start.y, start.y) &&
+					same_float(row.increment.x, increment.x) && same_float(row.increment.y, increment.y) && row.shading == shading;
+				if (same)
+					continue;
+				if (mismatches < 10)
+					std::cerr << "background row " << viewRow << " of " << height << " (half wall " << vars.halfWallHeight << ", sight depth " << vars.maxSightDepth << ") differs from the division\n";
+				++mismatches;
+			}
+		}
+		return mismatches;
+	}
+}
+
+int main()
+{
+	StaticTextures textures;
+	textures.floorTexture.create("assets/floor2.png", false, true);
+	textures.ceilingTexture.create("assets/ceiling2.png", false, true);
+	textures.skyTexture.create("assets/sky.png");
+
+	EntityTransform transform{ { 12.3f, -4.7f }, 2.1f };
+	GameCameraVars cameraVars;
+	cameraVars.pixelWidth = g_windowWidth;
+	cameraVars.fov = math::deg_to_rad(90);
+	GameCameraPlane vecs{ { std::cos(transform.forewardAngle), std::sin(transform.forewardAngle) }, { -std::sin(transform.forewardAngle) * 2, std::cos(transform.forewardAngle) * 2 } };
+	GameCameraView camera{ transform, cameraVars, vecs };
+	GameStateVars state;
+	GraphicsVars graphicsVars;
+
+	//the tables alone, and the ones of the rows of a view
+	FloorRowTables tables;
+	std::unique_ptr<GameView> view;
+	BackgroundRows background;
+	int mismatches = 0;
+	for (const RowVars& vars : g_steps)
+	{
+		graphicsVars.halfWallHeight = vars.halfWallHeight;
+		graphicsVars.maxSightDepth = vars.maxSightDepth;
+		tables.update(graphicsVars, vars.viewHeight);
+		mismatches += check_tables(tables, vars);
+
+		if (!view || view->m_height != vars.viewHeight)
+		{
+			view = std::make_unique<GameView>();
+			view->create(g_windowWidth, vars.viewHeight, true);
+			background.set_target(view.get(), &textures, &state, &graphicsVars, &camera);
+		}
+		background.update();
+		mismatches += check_tables(background.get_row_tables(), vars);
+		mismatches += check_rows(background, vars, camera);
+	}
+
+	if (mismatches != 0)
+	{
+		std::cerr << mismatches << " rows differ from the per row division\n";
+		return 1;
+	}
+	std::cout << "floor row tables match the per row division\n";
+	return 0;
+}
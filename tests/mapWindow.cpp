@@ -0,0 +1,132 @@
+//Map grids read from a chunk file keep the cells still resident when their window moves, and the distance field only
+//computes the distances near the new cells: both must be the same of a grid loaded and a field built at the new window
+
+#include "distanceField.hpp"
+#include "mapChunks.hpp"
+#include <filesystem>
+#include <iostream>
+#include <random>
+
+namespace
+{
+	constexpr int g_mapWidth = 2000;
+	constexpr int g_mapHeight = 1500;
+
+	//number of resident cells (border included) that differ
+	int compare_grids(const MapGrid& grid, const MapGrid& reference)
+	{
+		if (grid.get_window_x() != reference.get_window_x() || grid.get_window_y() != reference.get_window_y() ||
+			grid.get_window_width() != reference.get_window_width() || grid.get_window_height() != reference.get_window_height())
+		{
+			std::cerr << "window at " << grid.get_window_x() << ", " << grid.get_window_y() << " instead of "
+				<< reference.get_window_x() << ", " << reference.get_window_y() << "\n";
+			return 1;
+		}
+
+		int mismatches = 0;
+		for (int y = grid.get_window_y() - 1; y <= grid.get_window_y() + grid.get_window_height(); ++y)
+			for (int x = grid.get_window_x() - 1; x <= grid.get_window_x() + grid.get_window_width(); ++x)
+				if (grid.at_unchecked(x, y) != reference.at_unchecked(x, y))
+				{
+					if (mismatches < 5)
+						std::cerr << "cell " << x << ", " << y << " is " << (int)grid.at_unchecked(x, y)
+							<< " instead of " << (int)reference.at_unchecked(x, y) << "\n";
+					++mismatches;
+				}
+		return mismatches;
+	}
+
+	//number of distances that differ from a field built from scratch
+	int compare_fields(const DistanceField& field, const MapGrid& grid)
+	{
+		DistanceField reference;
+		reference.build(grid);
+		int mismatches = 0;
+		for (int y = grid.get_window_y() - 1; y <= grid.get_window_y() + grid.get_window_height(); ++y)
+			for (int x = grid.get_window_x() - 1; x <= grid.get_window_x() + grid.get_window_width(); ++x)
+				if (field.at_unchecked(x, y) != reference.at_unchecked(x, y))
+				{
+					if (mismatches < 5)
+						std::cerr << "distance of cell " << x << ", " << y << " is " << (int)field.at_unchecked(x, y)
+							<< " instead of " << (int)reference.at_unchecked(x, y) << "\n";
+					++mismatches;
+				}
+		return mismatches;
+	}
+
+	//walks the camera around the map, with steps of up to maxStep cells on each axis
+	int check_moves(std::shared_ptr<MapChunkFile> chunks, int radius, int maxStep, int moves, std::mt19937& randGen)
+	{
+		std::uniform_int_distribution<int> step(-maxStep, maxStep), radiusChange(-8, 8), editOffset(-radius, radius), wallChance(0, 1);
+		int x = g_mapWidth / 2, y = g_mapHeight / 2;
+
+		MapGrid grid;
+		grid.load(chunks, x, y, radius);
+		DistanceField field;
+		field.build(grid);
+
+		int mismatches = 0;
+		int windowMoves = 0;
+		for (int move = 0; move < moves; ++move)
+		{
+			//some moves go out of the map, they are clamped to its border. The radius changes as the render distance would
+			x = std::clamp(x + step(randGen), -10, g_mapWidth + 10);
+			y = std::clamp(y + step(randGen), -10, g_mapHeight + 10);
+			int moveRadius = std::max(radius + radiusChange(randGen), 1);
+			if (!grid.update_window(x, y, moveRadius))
+				continue;
+			field.update_window(grid);
+			++windowMoves;
+
+			MapGrid reference;
+			reference.load(chunks, x, y, moveRadius);
+			mismatches += compare_grids(grid, reference);
+			mismatches += compare_fields(field, grid);
+
+			//cells changed in the window, then moved with it
+			for (int i = 0; i < 16; ++i)
+			{
+				int cellX = std::clamp(x + editOffset(randGen), 0, g_mapWidth - 1);
+				int cellY = std::clamp(y + editOffset(randGen), 0, g_mapHeight - 1);
+				grid.set_cell(cellX, cellY, wallChance(randGen) ? 'w' : ' ');
+				field.update(grid, cellX, cellY);
+			}
+		}
+
+		std::cout << "radius " << radius << ", steps up to " << maxStep << ": the window moved " << windowMoves << " times\n";
+		if (windowMoves < moves / 50)
+		{
+			std::cerr << "the window moved " << windowMoves << " times only\n";
+			++mismatches;
+		}
+		return mismatches;
+	}
+}
+
+int main()
+{
+	std::mt19937 randGen(23);
+	std::uniform_int_distribution<> percent(0, 99);
+	std::string path = (std::filesystem::temp_directory_path() / "rcmMapWindowTest.rcmc").string();
+
+	int mismatches = 0;
+	for (int chunkSide : { MapChunkFile::minChunkSide, MapChunkFile::defaultChunkSide })
+	{
+		MapChunkFile::write(path, g_mapWidth, g_mapHeight, [&](int, int) { return percent(randGen) < 8 ? 'w' : ' '; }, chunkSide);
+		auto chunks = std::make_shared<MapChunkFile>(path);
+
+		//short steps keep most of the window, long ones leave little or nothing of it
+		mismatches += check_moves(chunks, 40, 12, 2000, randGen);
+		mismatches += check_moves(chunks, 100, 60, 200, randGen);
+		mismatches += check_moves(chunks, 30, 200, 100, randGen);
+	}
+	std::filesystem::remove(path);
+
+	if (mismatches != 0)
+	{
+		std::cerr << mismatches << " cells differ from the ones of a new window\n";
+		return 1;
+	}
+	std::cout << "moved map windows match new ones\n";
+	return 0;
+}
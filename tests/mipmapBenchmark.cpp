@@ -0,0 +1,214 @@
+//Time and cache misses of drawing the walls and background of a 720p frame (one view section, one thread) with mipmaps off and on,
+//with generated wall, floor and ceiling textures of 512, 1024 and 2048 pixels.
+//Cache misses are read from the cpu counters (perf_event_open, Linux only): where they can't be opened (other systems,
+//virtual machines, perf_event_paranoid) only the times are printed.
+//Not a check (timings depend on the machine): run it by hand from a release build, from the build directory (it loads the sky)
+
+#include "gameGraphics.hpp"
+#include "testMaps.hpp"
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+using namespace rcm;
+using namespace testMaps;
+using namespace windowVars;
+
+namespace
+{
+	const int g_textureSizes[] = { 512, 1024, 2048 };
+	constexpr int g_frames = 100;
+
+	//counts an event of this thread between start() and stop()
+	class CacheMissCounter
+	{
+	public:
+#ifdef __linux__
+		CacheMissCounter(std::uint32_t type, std::uint64_t config)
+		{
+			perf_event_attr attributes;
+			std::memset(&attributes, 0, sizeof(attributes));
+			attributes.type = type;
+			attributes.size = sizeof(attributes);
+			attributes.config = config;
+			attributes.disabled = 1;
+			attributes.exclude_kernel = 1;
+			attributes.exclude_hv = 1;
+			m_fd = static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+			if (m_fd < 0)
+				m_error = std::strerror(errno);
+		}
+		~CacheMissCounter() { if (m_fd >= 0) close(m_fd); }
+
+		void start() { if (m_fd >= 0) { ioctl(m_fd, PERF_EVENT_IOC_RESET, 0); ioctl(m_fd, PERF_EVENT_IOC_ENABLE, 0); } }
+		void stop()
+		{
+			if (m_fd < 0)
+				return;
+			ioctl(m_fd, PERF_EVENT_IOC_DISABLE, 0);
+			long long count = 0;
+			if (read(m_fd, &count, sizeof(count)) == sizeof(count))
+				m_count += count;
+		}
+#else
+		CacheMissCounter(std::uint32_t, std::uint64_t) {}
+		void start() {}
+		void stop() {}
+#endif
+		CacheMissCounter(const CacheMissCounter&) = delete;
+		CacheMissCounter& operator=(const CacheMissCounter&) = delete;
+
+		bool available() const { return m_fd >= 0; }
+		const std::string& error() const { return m_error; }
+		long long take_count() { long long count = m_count; m_count = 0; return count; }
+
+	private:
+		int m_fd = -1;
+		std::string m_error = "cpu counters are only read on Linux";
+		long long m_count = 0;
+	};
+
+#ifdef __linux__
+	const std::uint32_t g_l1Type = PERF_TYPE_HW_CACHE;
+	const std::uint64_t g_l1ReadMisses = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+	const std::uint32_t g_llcType = PERF_TYPE_HARDWARE;
+	const std::uint64_t g_llcMisses = PERF_COUNT_HW_CACHE_MISSES;
+#else
+	const std::uint32_t g_l1Type = 0, g_llcType = 0;
+	const std::uint64_t g_l1ReadMisses = 0, g_llcMisses = 0;
+#endif
+
+	//opaque texture with detail at every scale (sums of random value grids), saved as png so that it is loaded as the game does
+	std::string generate_texture(int size, std::mt19937& randGen)
+	{
+		std::uniform_int_distribution<> value(0, 255);
+		sf::Image image;
+		image.create(size, size);
+		std::vector<int> channels(size * size * 3, 0);
+		for (int cell = 4; cell <= size; cell *= 4)
+		{
+			int grid = size / cell;
+			std::vector<int> values(grid * grid * 3);
+			for (int& v : values)
+				v = value(randGen);
+			for (int y = 0; y < size; ++y)
+				for (int x = 0; x < size; ++x)
+					for (int c = 0; c < 3; ++c)
+						channels[(y * size + x) * 3 + c] += values[((y / cell) * grid + x / cell) * 3 + c];
+		}
+		int levels = 0;
+		for (int cell = 4; cell <= size; cell *= 4)
+			++levels;
+		for (int y = 0; y < size; ++y)
+			for (int x = 0; x < size; ++x)
+			{
+				const int* pixel = &channels[(y * size + x) * 3];
+				image.setPixel(x, y, sf::Color(pixel[0] / levels, pixel[1] / levels, pixel[2] / levels));
+			}
+
+		std::string path = (std::filesystem::temp_directory_path() / ("mipmapBenchmark" + std::to_string(size) + ".png")).string();
+		if (!image.saveToFile(path))
+			throw std::runtime_error("Could not save the generated texture " + path);
+		return path;
+	}
+
+	void time_textures(int textureSize, GameMap& map, const std::vector<EntityTransform>& poses, std::mt19937& randGen, CacheMissCounter& l1Misses, CacheMissCounter& llcMisses)
+	{
+		std::string texturePath = generate_texture(textureSize, randGen);
+		//loaded as the game does, with their mip chains: GraphicsVars::mipmaps selects whether they are sampled
+		StaticTextures textures;
+		textures.wallTexture.create(texturePath, true, true);
+		textures.baundryTexture.create(texturePath, true, true);
+		textures.floorTexture.create(texturePath, false, true);
+		textures.ceilingTexture.create(texturePath, false, true);
+		textures.skyTexture.create("assets/sky.png");
+		std::filesystem::remove(texturePath);
+
+		RendThreadPool rendThreadPool(1);
+		EntityTransform transform = poses.front();
+		GameCameraVars cameraVars;
+		cameraVars.pixelWidth = g_windowWidth;
+		cameraVars.pixelHeight = g_windowHeight;
+		cameraVars.fov = math::deg_to_rad(90);
+		cameraVars.maxRenderDist = 20.f;
+		GameCore core(cameraVars, map, transform, rendThreadPool);
+		GameCameraView camera{ transform, core.get_camera_vars(), core.get_camera_vecs() };
+
+		GameView view;
+		view.create(g_windowWidth, g_windowHeight, true);
+		GameStateVars state;
+		GraphicsVars graphicsVars;
+		graphicsVars.maxSightDepth = cameraVars.maxRenderDist;
+		BackgroundRows background;
+		//a single section: the time of one thread drawing the whole view
+		ViewRendSectionFactory viewSecFactory(g_windowWidth, 1);
+
+		std::cout << textureSize << "x" << textureSize << " textures:\n";
+		for (int mipmaps = 0; mipmaps < 2; ++mipmaps)
+		{
+			graphicsVars.mipmaps = mipmaps;
+			background.set_target(&view, &textures, &state, &graphicsVars, &camera);
+			viewSecFactory.set_target(&core.get_ray_info_arr(), &view, &textures, &state, &graphicsVars, &transform, &background);
+
+			std::cout << "  mipmaps " << (mipmaps ? "on: " : "off:");
+			for (int linear = 1; linear >= 0; --linear)
+			{
+				state.isLinearPersp = linear;
+				double totalMs = 0;
+				for (const EntityTransform& pose : poses)
+				{
+					transform = pose;
+					core.view_by_ray_casting(linear);
+					auto start = std::chrono::steady_clock::now();
+					l1Misses.start();
+					llcMisses.start();
+					background.update();
+					viewSecFactory.create_section(0)();
+					llcMisses.stop();
+					l1Misses.stop();
+					totalMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+				}
+
+				std::cout << (linear ? " " : ", ") << totalMs / g_frames << " ms " << (linear ? "linear" : "non linear");
+				if (l1Misses.available())
+					std::cout << " (" << l1Misses.take_count() / g_frames << " L1 read misses";
+				if (llcMisses.available())
+					std::cout << (l1Misses.available() ? ", " : " (") << llcMisses.take_count() / g_frames << " last level misses";
+				if (l1Misses.available() || llcMisses.available())
+					std::cout << ")";
+			}
+			std::cout << " per frame\n";
+		}
+	}
+}
+
+int main()
+{
+	std::mt19937 randGen(29);
+
+	GameMap maze;
+	generate_maze(maze, 201, 201);
+	//every texture size is drawn from the same poses
+	std::vector<EntityTransform> poses(g_frames);
+	std::uniform_real_distribution<float> angle(-3.14f, 3.14f);
+	for (EntityTransform& pose : poses)
+		pose = { free_position(maze, randGen), angle(randGen) };
+
+	CacheMissCounter l1Misses(g_l1Type, g_l1ReadMisses);
+	CacheMissCounter llcMisses(g_llcType, g_llcMisses);
+	if (!l1Misses.available() && !llcMisses.available())
+		std::cout << "cache misses not counted: " << l1Misses.error() << "\n";
+
+	for (int textureSize : g_textureSizes)
+		time_textures(textureSize, maze, poses, randGen, l1Misses, llcMisses);
+	return 0;
+}
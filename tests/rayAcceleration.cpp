@@ -0,0 +1,165 @@
+//Wall rays that skip empty cells with a ray acceleration structure must be the same, bit by bit, of the ones walked
+//cell by cell (RayAcceleration::None): on mazes, open maps and after cells were changed with set_map_cell,
+//which updates the structures only around the changed cells
+
+#include "testMaps.hpp"
+#include "distanceField.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+using namespace rcm;
+using namespace testMaps;
+
+namespace
+{
+	struct Acceleration
+	{
+		const char* name;
+		RayAcceleration rayAcceleration;
+	};
+
+	const Acceleration g_accelerations[] = {
+		{ "distanceField", RayAcceleration::DistanceField },
+		{ "pyramid", RayAcceleration::Pyramid },
+	};
+
+	//cells changed every frame, around the camera so that the rays cross them
+	constexpr int g_editsPerFrame = 24;
+	constexpr int g_editRadius = 12;
+
+	//number of distances that differ from a field built from scratch
+	int compare_distance_fields(const DistanceField& field, const MapGrid& grid)
+	{
+		DistanceField reference;
+		reference.build(grid);
+		int mismatches = 0;
+		for (int y = -1; y <= grid.get_height(); ++y)
+			for (int x = -1; x <= grid.get_width(); ++x)
+				if (field.at_unchecked(x, y) != reference.at_unchecked(x, y))
+				{
+					if (mismatches < 5)
+						std::cerr << "distance of cell " << x << ", " << y << " is " << (int)field.at_unchecked(x, y)
+							<< " instead of " << (int)reference.at_unchecked(x, y) << "\n";
+					++mismatches;
+				}
+		return mismatches;
+	}
+
+	//number of columns that differ from the ones walked cell by cell, plus the wrong distances of an updated field
+	int compare_acceleration(const Acceleration& acceleration, GameMap& map, float maxRenderDist, int frames, bool editCells, std::mt19937& randGen)
+	{
+		RendThreadPool rendThreadPool(4);
+		EntityTransform transform{ { 1.5f, 1.5f }, 0.f };
+		GameCameraVars referenceVars, acceleratedVars;
+		for (GameCameraVars* cameraVars : { &referenceVars, &acceleratedVars })
+		{
+			cameraVars->pixelWidth = 1280;
+			cameraVars->pixelHeight = 720;
+			cameraVars->fov = math::deg_to_rad(90);
+			cameraVars->maxRenderDist = maxRenderDist;
+		}
+		//both cores read the same map grid, only the accelerated one is told of the changed cells
+		GameCore reference(referenceVars, map, transform, rendThreadPool);
+		GameCore accelerated(acceleratedVars, map, transform, rendThreadPool);
+		accelerated.set_ray_acceleration(acceleration.rayAcceleration);
+
+		//updated the same way of the one in the core, to check the distances themselves
+		DistanceField distanceField;
+		if (editCells && acceleration.rayAcceleration == RayAcceleration::DistanceField)
+			distanceField.build(map.grid);
+
+		std::uniform_real_distribution<float> angle(-3.14f, 3.14f);
+		std::uniform_int_distribution<int> editOffset(-g_editRadius, g_editRadius), wallChance(0, 1);
+		int mismatches = 0;
+		for (int frame = 0; frame < frames; ++frame)
+		{
+			transform.coordinates = free_position(map, randGen);
+			transform.forewardAngle = angle(randGen);
+			//rays from a cell border and from a cell center, diagonal ones pass through the cell corners
+			if (frame % 5 == 0)
+				transform.coordinates.x = std::floor(transform.coordinates.x);
+			if (frame % 5 == 1)
+			{
+				transform.coordinates = { std::floor(transform.coordinates.x) + 0.5f, std::floor(transform.coordinates.y) + 0.5f };
+				transform.forewardAngle = (frame % 4) * math::deg_to_rad(45);
+			}
+
+			if (editCells)
+			{
+				//walls are added and removed, never on the camera cell or the map border
+				for (int i = 0; i < g_editsPerFrame; ++i)
+				{
+					int cellX = std::clamp((int)transform.coordinates.x + editOffset(randGen), 1, map.width - 2);
+					int cellY = std::clamp((int)transform.coordinates.y + editOffset(randGen), 1, map.height - 2);
+					if (cellX == (int)transform.coordinates.x && cellY == (int)transform.coordinates.y)
+						continue;
+					accelerated.set_map_cell(cellX, cellY, wallChance(randGen) ? 'w' : ' ');
+					if (distanceField.is_built())
+						distanceField.update(map.grid, cellX, cellY);
+				}
+				if (distanceField.is_built())
+					mismatches += compare_distance_fields(distanceField, map.grid);
+			}
+
+			reference.update_entities();
+			accelerated.update_entities();
+
+			for (int cameraPlane = 0; cameraPlane < 2; ++cameraPlane)
+			{
+				reference.view_by_ray_casting(cameraPlane);
+				accelerated.view_by_ray_casting(cameraPlane);
+
+				const RayInfoArr& walked = reference.get_ray_info_arr();
+				const RayInfoArr& rays = accelerated.get_ray_info_arr();
+				for (int column = 0; column < acceleratedVars.pixelWidth; ++column)
+				{
+					if (same_ray(walked.const_at(column), rays.const_at(column)))
+						continue;
+					if (mismatches < 10)
+						std::cerr << acceleration.name << ": column " << column << " differs (frame " << frame
+							<< ", " << (cameraPlane ? "linear" : "non linear") << " perspective, length "
+							<< rays.length(column) << " instead of " << walked.length(column) << ")\n";
+					++mismatches;
+				}
+			}
+		}
+		return mismatches;
+	}
+}
+
+//argument: the name of the acceleration to test
+int main(int argc, char* argv[])
+{
+	const Acceleration* acceleration = nullptr;
+	for (const Acceleration& current : g_accelerations)
+		if (argc > 1 && std::strcmp(argv[1], current.name) == 0)
+			acceleration = &current;
+	if (acceleration == nullptr)
+	{
+		std::cerr << "unknown ray acceleration\n";
+		return 1;
+	}
+
+	std::mt19937 randGen(17);
+	int mismatches = 0;
+
+	GameMap maze;
+	generate_maze(maze, 41, 31);
+	mismatches += compare_acceleration(*acceleration, maze, 20.f, 100, false, randGen);
+	mismatches += compare_acceleration(*acceleration, maze, 20.f, 100, true, randGen);
+
+	//long jumps over empty areas, up to the capped distances
+	GameMap open;
+	generate_scattered(open, 128, 128, randGen, 1);
+	mismatches += compare_acceleration(*acceleration, open, 60.f, 100, false, randGen);
+	mismatches += compare_acceleration(*acceleration, open, 60.f, 100, true, randGen);
+
+	if (mismatches != 0)
+	{
+		std::cerr << mismatches << " values differ from the rays walked cell by cell\n";
+		return 1;
+	}
+	std::cout << acceleration->name << ": accelerated rays match the ones walked cell by cell\n";
+	return 0;
+}
@@ -0,0 +1,84 @@
+//Time spent casting the wall rays of a frame with each ray acceleration, on a generated maze and an open map.
+//Not a check (timings depend on the machine): run it by hand from a release build
+
+#include "testMaps.hpp"
+#include <chrono>
+#include <iostream>
+
+using namespace rcm;
+using namespace testMaps;
+
+namespace
+{
+	struct RayMode
+	{
+		const char* name;
+		RayAcceleration rayAcceleration;
+		utils::SimdLevel simdLevel;
+	};
+
+	//accelerated rays are cast one by one: plain rays are timed both one by one and in packets
+	const RayMode g_modes[] = {
+		{ "none (scalar)", RayAcceleration::None, utils::SimdLevel::Scalar },
+		{ "none (packets)", RayAcceleration::None, utils::SimdLevel::AVX2 },
+		{ "distance field", RayAcceleration::DistanceField, utils::SimdLevel::Scalar },
+		{ "pyramid", RayAcceleration::Pyramid, utils::SimdLevel::Scalar },
+	};
+
+	constexpr int g_renderWidth = 1280;
+	constexpr int g_frames = 400;
+
+	void time_modes(const char* mapName, GameMap& map, float maxRenderDist, std::mt19937& randGen)
+	{
+		//every mode casts from the same poses, all different so that no rays are reused
+		std::vector<EntityTransform> poses(g_frames);
+		std::uniform_real_distribution<float> angle(-3.14f, 3.14f);
+		for (EntityTransform& pose : poses)
+			pose = { free_position(map, randGen), angle(randGen) };
+
+		std::cout << mapName << " (" << map.width << "x" << map.height << ", render distance " << maxRenderDist << "):\n";
+		RendThreadPool rendThreadPool(1);
+		for (const RayMode& mode : g_modes)
+		{
+			EntityTransform transform = poses.front();
+			GameCameraVars cameraVars;
+			cameraVars.pixelWidth = g_renderWidth;
+			cameraVars.pixelHeight = 720;
+			cameraVars.fov = math::deg_to_rad(90);
+			cameraVars.maxRenderDist = maxRenderDist;
+			//one thread, so that only the cost of the rays is measured
+			cameraVars.parallelRayCasting = false;
+			cameraVars.raySimdLevel = mode.simdLevel;
+			cameraVars.rayAcceleration = mode.rayAcceleration;
+			GameCore core(cameraVars, map, transform, rendThreadPool);
+
+			double totalMs[2]{};
+			for (int cameraPlane = 0; cameraPlane < 2; ++cameraPlane)
+				for (const EntityTransform& pose : poses)
+				{
+					transform = pose;
+					core.update_entities();
+					auto start = std::chrono::steady_clock::now();
+					core.view_by_ray_casting(cameraPlane);
+					totalMs[cameraPlane] += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+				}
+
+			std::cout << "  " << mode.name << ": " << totalMs[1] / g_frames << " ms linear, "
+				<< totalMs[0] / g_frames << " ms non linear per frame\n";
+		}
+	}
+}
+
+int main()
+{
+	std::mt19937 randGen(19);
+
+	GameMap maze;
+	generate_maze(maze, 201, 201);
+	time_modes("maze", maze, 30.f, randGen);
+
+	GameMap open;
+	generate_scattered(open, 512, 512, randGen, 1);
+	time_modes("open map", open, 100.f, randGen);
+	return 0;
+}
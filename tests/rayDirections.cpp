@@ -0,0 +1,252 @@
+//Ray directions read from the per column tables (rotated by the view axes every frame) and the 1 / |direction| step lengths
+//must match the math they replaced: a ray rotated column by column (camera plane increments, or a rotation matrix per column
+//in the non linear perspective) walked with sqrt(1 + pow(y / x, 2)) steps. Billboards must match the relative angles
+//from math::vec_to_rad. The non linear perspective is compared at the view angle rounded to whole columns, the one
+//both rays and billboards use. Tolerances below are relative to the ray length or the screen width
+
+#include "testMaps.hpp"
+#include <algorithm>
+#include <iostream>
+#include <limits>
+
+using namespace rcm;
+using namespace testMaps;
+
+namespace
+{
+	constexpr int g_renderWidth = windowVars::g_windowWidth;
+	//rotating the ray column by column accumulates the rounding of every step
+	constexpr float g_directionTolerance = 1e-4f;
+	constexpr float g_lengthTolerance = 1e-4f;
+	//pixels
+	constexpr float g_screenTolerance = 0.01f;
+	constexpr float g_angleTolerance = 1e-5f;
+
+	struct StillEntity : public IEntity
+	{
+		StillEntity(const EntityTransform& transform) : IEntity(0, transform) {}
+		void on_create() override {}
+		void on_update() override {}
+		void on_late_update() override {}
+		void on_hit(EntityType) override {}
+	};
+
+	//per column ray directions as they were computed before the tables: rotated column by column
+	std::vector<math::Vect2> baseline_directions(float viewAngle, const GameCameraVars& cameraVars, bool useCameraPlane)
+	{
+		std::vector<math::Vect2> directions(cameraVars.pixelWidth);
+		math::Vect2 forewardDirection{ std::cos(viewAngle), std::sin(viewAngle) };
+		math::Vect2 plane = math::Vect2(forewardDirection.y, -forewardDirection.x) * std::tan(cameraVars.fov / 2) * 2;
+
+		math::Vect2 currentRayDir = useCameraPlane ? forewardDirection - plane / 2 : forewardDirection * math::rotation_mat2x2(cameraVars.fov / 2);
+		math::Vect2 rayRotationIncrement = plane / cameraVars.pixelWidth;
+
+		for (math::Vect2& direction : directions)
+		{
+			direction = currentRayDir;
+			if (useCameraPlane)
+				currentRayDir += rayRotationIncrement;
+			else
+				currentRayDir *= math::rotation_mat2x2(-cameraVars.fov / cameraVars.pixelWidth);
+		}
+		return directions;
+	}
+
+	float relative_difference(float value, float reference)
+	{
+		return std::abs(value - reference) / std::max(std::abs(reference), 1.f);
+	}
+
+	//ray length as it was walked before: pow / sqrt steps for the non linear perspective, accumulated lengths.
+	//closestTie is the smallest relative difference between two lengths the walk compared: the X and Y lengths at a cell corner,
+	//or a length and the render distance
+	float walk_baseline(const GameMap& map, const math::Vect2& start, const math::Vect2& currentRayDir, float maxRenderDist, bool useCameraPlane, float& closestTie)
+	{
+		float lengthIncrementX = 0, lengthIncrementY = 0;
+		if (useCameraPlane)
+		{
+			lengthIncrementX = 1 / std::abs(currentRayDir.x);
+			lengthIncrementY = 1 / std::abs(currentRayDir.y);
+		}
+		else
+		{
+			lengthIncrementX = std::sqrt(1 + std::pow(currentRayDir.y / currentRayDir.x, 2));
+			lengthIncrementY = std::sqrt(1 + std::pow(currentRayDir.x / currentRayDir.y, 2));
+		}
+
+		int posInMap[2] = { (int)start.x, (int)start.y };
+		int stepX = currentRayDir.x < 0 ? -1 : 1;
+		int stepY = currentRayDir.y < 0 ? -1 : 1;
+		float lengthX = (currentRayDir.x < 0 ? start.x - posInMap[0] : float(posInMap[0]) + (1 - start.x)) * lengthIncrementX;
+		float lengthY = (currentRayDir.y < 0 ? start.y - posInMap[1] : float(posInMap[1]) + (1 - start.y)) * lengthIncrementY;
+
+		bool lastX = true;
+		closestTie = std::numeric_limits<float>::max();
+		while (true)
+		{
+			closestTie = std::min({ closestTie, relative_difference(lengthX, lengthY), relative_difference(std::min(lengthX, lengthY), maxRenderDist) });
+			if (lengthX < lengthY)
+			{
+				if (lengthX > maxRenderDist)
+					break;
+				posInMap[0] += stepX;
+				lengthX += lengthIncrementX;
+				lastX = true;
+			}
+			else
+			{
+				if (lengthY > maxRenderDist)
+					break;
+				posInMap[1] += stepY;
+				lengthY += lengthIncrementY;
+				lastX = false;
+			}
+			//only walls and the boundary stop rays, the goal cell is seen through
+			char cell = map.cells->at(posInMap[0] + posInMap[1] * map.width);
+			if (cell == 'w' || cell == 'b')
+				break;
+		}
+		return lastX ? lengthX - lengthIncrementX : lengthY - lengthIncrementY;
+	}
+
+	//billboard as it was placed from the relative angle
+	Billboard place_baseline(const EntityTransform& entity, const EntityTransform& camera, float viewAngle, const GameCameraVars& cameraVars, bool useCameraPlane)
+	{
+		Billboard billboard(0);
+		math::Vect2 rayToCamera = entity.coordinates - camera.coordinates;
+		float euclideanRayLength = rayToCamera.Length();
+
+		float entityRelativeAngle = viewAngle - math::vec_to_rad(rayToCamera);
+		if (entityRelativeAngle >= PI)
+			entityRelativeAngle -= 2 * PI;
+		else if (entityRelativeAngle <= -PI)
+			entityRelativeAngle += 2 * PI;
+
+		billboard.cameraAngle = entity.forewardAngle - math::vec_to_rad(rayToCamera);
+		if (billboard.cameraAngle >= PI)
+			billboard.cameraAngle -= 2 * PI;
+		else if (billboard.cameraAngle <= -PI)
+			billboard.cameraAngle += 2 * PI;
+
+		if (!useCameraPlane)
+		{
+			billboard.distance = euclideanRayLength;
+			billboard.positionOnScreen = (cameraVars.fov / 2 + entityRelativeAngle) / cameraVars.fov * cameraVars.pixelWidth;
+		}
+		else
+		{
+			billboard.distance = euclideanRayLength * std::cos(entityRelativeAngle);
+			float projectionOnPlane = euclideanRayLength * std::sin(entityRelativeAngle);
+			float planeLength = std::tan(cameraVars.fov / 2) * 2;
+			billboard.positionOnScreen = (projectionOnPlane / billboard.distance / planeLength + 0.5f) * cameraVars.pixelWidth;
+		}
+		return billboard;
+	}
+
+	int check_directions(GameMap& map, float maxRenderDist, int frames, std::mt19937& randGen)
+	{
+		RendThreadPool rendThreadPool(4);
+		GameCameraVars cameraVars;
+		cameraVars.pixelWidth = g_renderWidth;
+		cameraVars.pixelHeight = 720;
+		cameraVars.fov = math::deg_to_rad(90);
+		cameraVars.maxRenderDist = maxRenderDist;
+		EntityTransform transform;
+		GameCore core(cameraVars, map, transform, rendThreadPool);
+
+		//entities are placed around the camera every frame
+		std::vector<StillEntity*> entities;
+		for (int i = 0; i < 32; ++i)
+		{
+			entities.push_back(new StillEntity(transform));
+			core.add_entity(entities.back());
+		}
+
+		std::uniform_real_distribution<float> angle(-PI, PI), offset(-8.f, 8.f);
+		const float angleIncrement = cameraVars.fov / g_renderWidth;
+		int errors = 0;
+
+		auto report = [&errors](int frame, bool useCameraPlane, const char* what, int index, float value, float reference)
+			{
+				if (errors < 10)
+					std::cerr << "frame " << frame << " (" << (useCameraPlane ? "linear" : "non linear") << " perspective): " << what << " " << index
+						<< " is " << value << " instead of " << reference << "\n";
+				++errors;
+			};
+
+		for (int frame = 0; frame < frames; ++frame)
+		{
+			transform.coordinates = free_position(map, randGen);
+			transform.forewardAngle = angle(randGen);
+			for (StillEntity* entity : entities)
+				entity->m_transform = { transform.coordinates + math::Vect2{ offset(randGen), offset(randGen) }, angle(randGen) };
+
+			for (int cameraPlane = 0; cameraPlane < 2; ++cameraPlane)
+			{
+				bool useCameraPlane = cameraPlane;
+				core.update_entities();
+				core.view_by_ray_casting(useCameraPlane);
+
+				float viewAngle = useCameraPlane
+					? transform.forewardAngle
+					: std::lround(std::remainder(transform.forewardAngle, 2 * PI) / angleIncrement) * angleIncrement;
+				std::vector<math::Vect2> baseline = baseline_directions(viewAngle, cameraVars, useCameraPlane);
+				const RayInfoArr& rays = core.get_ray_info_arr();
+
+				for (int column = 0; column < g_renderWidth; ++column)
+				{
+					math::Vect2 direction = core.get_column_ray_direction(column);
+					float directionError = (direction - baseline[column]).Length() / baseline[column].Length();
+					if (directionError > g_directionTolerance)
+						report(frame, useCameraPlane, "direction error of column", column, directionError, 0.f);
+
+					//the step lengths are compared along the same direction: near walls parallel to the ray
+					//any difference in direction moves the hit far along the wall. Rays that pass a cell corner, or cross
+					//a cell side at the render distance, closer than the tolerance can be rounded to either side and end elsewhere
+					float closestTie = 0.f;
+					float length = walk_baseline(map, transform.coordinates, direction, maxRenderDist, useCameraPlane, closestTie);
+					if (closestTie > g_lengthTolerance && relative_difference(rays.length(column), length) > g_lengthTolerance)
+						report(frame, useCameraPlane, "length of column", column, rays.length(column), length);
+				}
+
+				for (int i = 0; i < (int)entities.size(); ++i)
+				{
+					const Billboard& billboard = entities[i]->m_billboard;
+					Billboard reference = place_baseline(entities[i]->m_transform, transform, viewAngle, cameraVars, useCameraPlane);
+
+					if (std::abs(billboard.cameraAngle - reference.cameraAngle) > g_angleTolerance)
+						report(frame, useCameraPlane, "camera angle of entity", i, billboard.cameraAngle, reference.cameraAngle);
+					if (relative_difference(billboard.distance, reference.distance) > g_lengthTolerance)
+						report(frame, useCameraPlane, "distance of entity", i, billboard.distance, reference.distance);
+					//billboards beside or behind the camera are never drawn
+					if (reference.distance > 0.1f && std::abs(reference.positionOnScreen - g_renderWidth / 2) < g_renderWidth &&
+						std::abs(billboard.positionOnScreen - reference.positionOnScreen) > g_screenTolerance)
+						report(frame, useCameraPlane, "screen position of entity", i, billboard.positionOnScreen, reference.positionOnScreen);
+				}
+			}
+		}
+		return errors;
+	}
+}
+
+int main()
+{
+	std::mt19937 randGen(5);
+	int errors = 0;
+
+	GameMap maze;
+	generate_maze(maze, 41, 31);
+	errors += check_directions(maze, 20.f, 100, randGen);
+
+	GameMap scattered;
+	generate_scattered(scattered, 128, 128, randGen);
+	errors += check_directions(scattered, 60.f, 100, randGen);
+
+	if (errors != 0)
+	{
+		std::cerr << errors << " values differ from the per column math\n";
+		return 1;
+	}
+	std::cout << "ray directions and billboards match the per column math\n";
+	return 0;
+}
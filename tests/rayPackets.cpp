@@ -0,0 +1,115 @@
+//Wall rays cast in packets (SSE2, AVX2) must be the same, bit by bit, of the ones cast one by one.
+//This holds only if no code path fuses multiplications and additions (see -ffp-contract=off in CMakeLists.txt)
+
+#include "testMaps.hpp"
+#include <iostream>
+
+using namespace rcm;
+using namespace testMaps;
+
+namespace
+{
+	struct RayMode
+	{
+		const char* name;
+		utils::SimdLevel simdLevel;
+		bool parallel;
+	};
+
+	const RayMode g_modes[] = {
+		{ "scalar", utils::SimdLevel::Scalar, false },
+		{ "sse2", utils::SimdLevel::SSE2, false },
+		{ "avx2", utils::SimdLevel::AVX2, false },
+		{ "avx2 parallel", utils::SimdLevel::AVX2, true },
+	};
+	constexpr int g_modesNumber = sizeof(g_modes) / sizeof(g_modes[0]);
+
+	//number of columns that differ from the scalar ones
+	int compare_modes(GameMap& map, int renderWidth, float maxRenderDist, int frames, std::mt19937& randGen)
+	{
+		RendThreadPool rendThreadPool(4);
+		EntityTransform transform{ { 1.5f, 1.5f }, 0.f };
+		GameCameraVars cameraVars[g_modesNumber];
+		std::vector<std::unique_ptr<GameCore>> cores;
+		for (int i = 0; i < g_modesNumber; ++i)
+		{
+			cameraVars[i].pixelWidth = renderWidth;
+			cameraVars[i].pixelHeight = 720;
+			cameraVars[i].fov = math::deg_to_rad(90);
+			cameraVars[i].maxRenderDist = maxRenderDist;
+			cameraVars[i].raySimdLevel = g_modes[i].simdLevel;
+			cameraVars[i].parallelRayCasting = g_modes[i].parallel;
+			cores.push_back(std::make_unique<GameCore>(cameraVars[i], map, transform, rendThreadPool));
+		}
+
+		std::uniform_real_distribution<float> posX(1.f, map.width - 1.f), posY(1.f, map.height - 1.f), angle(-3.14f, 3.14f);
+		int mismatches = 0;
+		for (int frame = 0; frame < frames; ++frame)
+		{
+			//look from free cells only, some of them exactly on the cell borders
+			do
+				transform.coordinates = { posX(randGen), posY(randGen) };
+			while (map.cells->at((int)transform.coordinates.x + (int)transform.coordinates.y * map.width) != ' ');
+			transform.forewardAngle = angle(randGen);
+			if (frame % 5 == 0)
+				transform.coordinates.x = std::floor(transform.coordinates.x);
+			//diagonal rays from the cell centers reach X and Y sides at the same length
+			if (frame % 5 == 1)
+			{
+				transform.coordinates = { std::floor(transform.coordinates.x) + 0.5f, std::floor(transform.coordinates.y) + 0.5f };
+				transform.forewardAngle = (frame % 4) * math::deg_to_rad(90);
+			}
+
+			for (auto& core : cores)
+				core->update_entities();
+
+			for (int cameraPlane = 0; cameraPlane < 2; ++cameraPlane)
+			{
+				for (auto& core : cores)
+					core->view_by_ray_casting(cameraPlane);
+
+				const RayInfoArr& reference = cores.front()->get_ray_info_arr();
+				for (int i = 1; i < g_modesNumber; ++i)
+				{
+					const RayInfoArr& rays = cores[i]->get_ray_info_arr();
+					for (int column = 0; column < renderWidth; ++column)
+					{
+						if (same_ray(reference.const_at(column), rays.const_at(column)))
+							continue;
+						if (mismatches < 10)
+							std::cerr << g_modes[i].name << ": column " << column << " differs (frame " << frame
+								<< ", " << (cameraPlane ? "linear" : "non linear") << " perspective, length "
+								<< rays.const_at(column).length << " instead of " << reference.const_at(column).length << ")\n";
+						++mismatches;
+					}
+				}
+			}
+		}
+		return mismatches;
+	}
+}
+
+int main()
+{
+	std::cout << "cpu support: " << static_cast<int>(utils::get_simd_level()) << " (0 scalar, 1 SSE2, 2 AVX2)\n";
+
+	std::mt19937 randGen(7);
+	int mismatches = 0;
+
+	GameMap maze;
+	generate_maze(maze, 41, 31);
+	//the render width is not a multiple of the packet width, so that the last packet is partial
+	mismatches += compare_modes(maze, 1283, 20.f, 200, randGen);
+
+	GameMap scattered;
+	generate_scattered(scattered, 128, 128, randGen);
+	mismatches += compare_modes(scattered, 1280, 60.f, 100, randGen);
+
+	if (mismatches != 0)
+	{
+		std::cerr << mismatches << " columns differ from the scalar rays\n";
+		return 1;
+	}
+	std::cout << "packet rays match the scalar ones\n";
+	return 0;
+}
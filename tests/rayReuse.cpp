@@ -0,0 +1,144 @@
+//Wall rays reused from the last frame must be the same, bit by bit, of the ones cast from scratch:
+//with the camera still (both perspectives) and after turning it in the non linear perspective, where rays are
+//cast at the view angle rounded to whole columns and the ones of the last frame are shifted
+
+#include "testMaps.hpp"
+#include <iostream>
+
+using namespace rcm;
+using namespace testMaps;
+
+namespace
+{
+	constexpr int g_renderWidth = 1280;
+	constexpr int g_threads = 4;
+
+	GameCameraVars make_camera_vars(float maxRenderDist)
+	{
+		GameCameraVars cameraVars;
+		cameraVars.pixelWidth = g_renderWidth;
+		cameraVars.pixelHeight = 720;
+		cameraVars.fov = math::deg_to_rad(90);
+		cameraVars.maxRenderDist = maxRenderDist;
+		return cameraVars;
+	}
+
+	int count_mismatches(const GameCore& core, const GameCore& reference, const char* what)
+	{
+		int mismatches = 0;
+		for (int column = 0; column < g_renderWidth; ++column)
+		{
+			if (same_ray(core.get_ray_info_arr().const_at(column), reference.get_ray_info_arr().const_at(column)))
+				continue;
+			if (mismatches < 5)
+				std::cerr << what << ": column " << column << " differs (length " << core.get_ray_info_arr().const_at(column).length
+					<< " instead of " << reference.get_ray_info_arr().const_at(column).length << ")\n";
+			++mismatches;
+		}
+		return mismatches;
+	}
+
+	//number of wrong columns, plus one for each frame that should have reused rays and didn't
+	int check_reuse(GameMap& map, float maxRenderDist, int frames, std::mt19937& randGen)
+	{
+		RendThreadPool rendThreadPool(g_threads);
+		GameCameraVars cameraVars = make_camera_vars(maxRenderDist);
+		GameCameraVars referenceVars = make_camera_vars(maxRenderDist);
+		EntityTransform transform, referenceTransform;
+		GameCore core(cameraVars, map, transform, rendThreadPool);
+		GameCore reference(referenceVars, map, referenceTransform, rendThreadPool);
+
+		const float angleIncrement = cameraVars.fov / g_renderWidth;
+		//the reused core recasts the new columns on one thread only up to a section
+		const int maxShift = g_renderWidth / g_threads;
+		std::uniform_real_distribution<float> angle(-PI, PI), fraction(-0.45f, 0.45f);
+		std::uniform_int_distribution<int> shift(-maxShift, maxShift);
+
+		int errors = 0;
+		for (int frame = 0; frame < frames; ++frame)
+		{
+			transform.coordinates = free_position(map, randGen);
+			transform.forewardAngle = angle(randGen);
+			//some views turn across the angle wrap
+			if (frame % 10 == 0)
+				transform.forewardAngle = PI - angleIncrement * 3;
+
+			//still camera, both perspectives (the non linear one last, it is then turned)
+			for (int cameraPlane = 1; cameraPlane >= 0; --cameraPlane)
+			{
+				core.update_entities();
+				core.view_by_ray_casting(cameraPlane);
+				core.update_entities();
+				core.view_by_ray_casting(cameraPlane);
+				if (core.get_reused_rays() != g_renderWidth)
+				{
+					std::cerr << "frame " << frame << ": still camera recast its rays\n";
+					++errors;
+				}
+
+				//the reference moves away first, so that its rays are cast from scratch
+				referenceTransform = { { 0.f, 0.f }, 0.f };
+				reference.update_entities();
+				reference.view_by_ray_casting(cameraPlane);
+				referenceTransform = transform;
+				reference.update_entities();
+				reference.view_by_ray_casting(cameraPlane);
+				errors += count_mismatches(core, reference, "still camera");
+			}
+
+			//turn by a number of columns (not always a whole one), non linear perspective
+			int turn = shift(randGen);
+			if (frame % 10 == 0)
+				turn = 6;
+			float turnAngle = (turn + (frame % 2 ? fraction(randGen) : 0.f)) * angleIncrement;
+			float lastAngle = transform.forewardAngle;
+			transform.forewardAngle += turnAngle;
+			if (transform.forewardAngle >= PI)
+				transform.forewardAngle -= 2 * PI;
+			else if (transform.forewardAngle <= -PI)
+				transform.forewardAngle += 2 * PI;
+			core.update_entities();
+			core.view_by_ray_casting(false);
+
+			//the columns the view moved by (rounded view angles), unless it wrapped
+			int columns = (int)std::lround(std::remainder(transform.forewardAngle, 2 * PI) / angleIncrement) -
+				(int)std::lround(std::remainder(lastAngle, 2 * PI) / angleIncrement);
+			if (std::abs(columns) <= maxShift && core.get_reused_rays() != g_renderWidth - std::abs(columns))
+			{
+				std::cerr << "frame " << frame << ": turn by " << columns << " columns reused " << core.get_reused_rays() << " rays\n";
+				++errors;
+			}
+
+			referenceTransform = { { 0.f, 0.f }, 0.f };
+			reference.update_entities();
+			reference.view_by_ray_casting(false);
+			referenceTransform = transform;
+			reference.update_entities();
+			reference.view_by_ray_casting(false);
+			errors += count_mismatches(core, reference, "turned camera");
+		}
+		return errors;
+	}
+}
+
+int main()
+{
+	std::mt19937 randGen(11);
+	int errors = 0;
+
+	GameMap maze;
+	generate_maze(maze, 41, 31);
+	errors += check_reuse(maze, 20.f, 100, randGen);
+
+	GameMap scattered;
+	generate_scattered(scattered, 128, 128, randGen);
+	errors += check_reuse(scattered, 60.f, 100, randGen);
+
+	if (errors != 0)
+	{
+		std::cerr << errors << " reused rays differ from the ones cast from scratch\n";
+		return 1;
+	}
+	std::cout << "reused rays match the ones cast from scratch\n";
+	return 0;
+}
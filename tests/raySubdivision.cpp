@@ -0,0 +1,111 @@
+//Wall rays filled by column subdivision must be the same, bit by bit, of the ones cast for every column,
+//on mazes (short spans of the same cells) and open maps (long spans, far walls seen at grazing angles)
+
+#include "testMaps.hpp"
+#include <iostream>
+
+using namespace rcm;
+using namespace testMaps;
+
+namespace
+{
+	const int g_subdivisions[] = { 1, 2, 4, 8, 16 };
+	constexpr int g_subdivisionsNumber = sizeof(g_subdivisions) / sizeof(g_subdivisions[0]);
+
+	//number of columns that differ from the ones cast for every column, plus one for each subdivision that never filled a column
+	int compare_subdivisions(GameMap& map, int renderWidth, float maxRenderDist, int frames, std::mt19937& randGen)
+	{
+		RendThreadPool rendThreadPool(4);
+		EntityTransform transform{ { 1.5f, 1.5f }, 0.f };
+		GameCameraVars cameraVars[g_subdivisionsNumber];
+		std::vector<std::unique_ptr<GameCore>> cores;
+		for (int i = 0; i < g_subdivisionsNumber; ++i)
+		{
+			cameraVars[i].pixelWidth = renderWidth;
+			cameraVars[i].pixelHeight = 720;
+			cameraVars[i].fov = math::deg_to_rad(90);
+			cameraVars[i].maxRenderDist = maxRenderDist;
+			cameraVars[i].raySubdivision = g_subdivisions[i];
+			cores.push_back(std::make_unique<GameCore>(cameraVars[i], map, transform, rendThreadPool));
+		}
+
+		std::uniform_real_distribution<float> angle(-3.14f, 3.14f);
+		long long savedRays[g_subdivisionsNumber]{};
+		int mismatches = 0;
+		for (int frame = 0; frame < frames; ++frame)
+		{
+			transform.coordinates = free_position(map, randGen);
+			transform.forewardAngle = angle(randGen);
+			//rays from a cell border and from a cell center, diagonal ones pass through the cell corners
+			if (frame % 5 == 0)
+				transform.coordinates.x = std::floor(transform.coordinates.x);
+			if (frame % 5 == 1)
+			{
+				transform.coordinates = { std::floor(transform.coordinates.x) + 0.5f, std::floor(transform.coordinates.y) + 0.5f };
+				transform.forewardAngle = (frame % 4) * math::deg_to_rad(45);
+			}
+
+			for (auto& core : cores)
+				core->update_entities();
+
+			for (int cameraPlane = 0; cameraPlane < 2; ++cameraPlane)
+			{
+				for (int i = 0; i < g_subdivisionsNumber; ++i)
+				{
+					cores[i]->view_by_ray_casting(cameraPlane);
+					savedRays[i] += cores[i]->get_saved_rays();
+				}
+
+				const RayInfoArr& reference = cores.front()->get_ray_info_arr();
+				for (int i = 1; i < g_subdivisionsNumber; ++i)
+				{
+					const RayInfoArr& rays = cores[i]->get_ray_info_arr();
+					for (int column = 0; column < renderWidth; ++column)
+					{
+						if (same_ray(reference.const_at(column), rays.const_at(column)))
+							continue;
+						if (mismatches < 10)
+							std::cerr << "subdivision " << g_subdivisions[i] << ": column " << column << " differs (frame " << frame
+								<< ", " << (cameraPlane ? "linear" : "non linear") << " perspective, length "
+								<< rays.const_at(column).length << " instead of " << reference.const_at(column).length << ")\n";
+						++mismatches;
+					}
+				}
+			}
+		}
+
+		for (int i = 1; i < g_subdivisionsNumber; ++i)
+		{
+			std::cout << "subdivision " << g_subdivisions[i] << ": " << savedRays[i] / (2 * frames) << "/" << renderWidth << " columns filled per frame\n";
+			if (savedRays[i] == 0)
+			{
+				std::cerr << "subdivision " << g_subdivisions[i] << " never filled a column\n";
+				++mismatches;
+			}
+		}
+		return mismatches;
+	}
+}
+
+int main()
+{
+	std::mt19937 randGen(3);
+	int mismatches = 0;
+
+	GameMap maze;
+	generate_maze(maze, 41, 31);
+	mismatches += compare_subdivisions(maze, 1280, 20.f, 200, randGen);
+
+	GameMap open;
+	generate_scattered(open, 128, 128, randGen, 2);
+	//the render width is not a multiple of the subdivisions, so that the last span of each section is shorter
+	mismatches += compare_subdivisions(open, 1283, 60.f, 200, randGen);
+
+	if (mismatches != 0)
+	{
+		std::cerr << mismatches << " columns differ from casting every column\n";
+		return 1;
+	}
+	std::cout << "filled rays match the ones cast for every column\n";
+	return 0;
+}
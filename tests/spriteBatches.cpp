@@ -0,0 +1,131 @@
+//GameGraphics draws the sprites of every view (main view and added cameras) in a single thread pool batch, nearest first,
+//skipping the pixels nearer sprites already cover. Views must be the same, bit by bit, of the ones drawn sprite by sprite:
+//farthest first, each sprite in a batch of its own, over the same walls. Checked on clusters of overlapping sprites seen by
+//the main view and by an added camera of another size that looks at them from another angle, in both perspectives.
+//Views are only rendered, never drawn: no window is opened. Textures are loaded from the assets folder copied in the build directory
+
+#include "testViews.hpp"
+#include <iostream>
+
+using namespace rcm;
+using namespace testMaps;
+using namespace testViews;
+using namespace windowVars;
+
+namespace
+{
+	constexpr int g_spritesNumber = 32;
+	const ViewportRect g_cameraViewport{ 0.05f, 0.1f, 0.6f, 0.6f };
+
+	int check_batches(GameMap& map, int frames, std::mt19937& randGen)
+	{
+		RendThreadPool rendThreadPool(4);
+		GameCameraVars cameraVars;
+		cameraVars.pixelWidth = g_windowWidth;
+		cameraVars.pixelHeight = g_windowHeight;
+		cameraVars.fov = math::deg_to_rad(90);
+		cameraVars.maxRenderDist = 20.f;
+		EntityTransform transform;
+		GameCore core(cameraVars, map, transform, rendThreadPool);
+		GameCameraView mainCamera{ transform, core.get_camera_vars(), core.get_camera_vecs() };
+
+		//never opened: views are only rendered
+		sf::RenderWindow window;
+		GraphicsVars graphicsVars;
+		graphicsVars.maxSightDepth = cameraVars.maxRenderDist;
+		graphicsVars.mipmaps = true;
+		GameStateVars state;
+		GameGraphics graphics(window, graphicsVars, rendThreadPool);
+		graphics.create_assets(g_assets, map, graphicsVars, core.get_ray_info_arr(), state, mainCamera);
+		for (int id = 0; id < g_spriteTexturesNumber; ++id)
+			graphics.load_sprite(id, g_spriteTextures[id]);
+		std::vector<std::unique_ptr<Texture>> spriteTextures = load_sprite_textures();
+
+		EntityTransform cameraTransform;
+		GameCameraVars addedVars = cameraVars;
+		addedVars.pixelWidth = 800;
+		addedVars.fov = math::deg_to_rad(70);
+		int added = core.add_camera(addedVars, cameraTransform);
+		GameCameraView addedCamera{ cameraTransform, core.get_camera_vars(added), core.get_camera_vecs(added) };
+		graphics.add_camera_view(addedCamera, core.get_ray_info_arr(added), core.get_camera_billboards(added), g_cameraViewport);
+
+		//the same views drawn sprite by sprite, split in sections that run one after the other
+		StaticTextures textures;
+		load_textures(textures);
+		SingleCameraRender mainReference(mainCamera, core.get_ray_info_arr(), textures, state, graphicsVars, g_windowHeight, 3);
+		SingleCameraRender addedReference(addedCamera, core.get_ray_info_arr(added), textures, state, graphicsVars, graphics.get_view(added).m_height, 3);
+
+		const SpriteAlignment alignments[] = { SpriteAlignment::TopWindow, SpriteAlignment::Ceiling, SpriteAlignment::Center, SpriteAlignment::Floor, SpriteAlignment::BottomWindow };
+		std::vector<SpriteEntity*> entities;
+		for (int i = 0; i < g_spritesNumber; ++i)
+		{
+			entities.push_back(new SpriteEntity(transform, i % g_spriteTexturesNumber, alignments[i % 5], 0.3f + (i % 5) * 0.25f));
+			core.add_entity(entities.back());
+		}
+
+		std::uniform_real_distribution<float> angle(-PI, PI), turn(-0.5f, 0.5f), ahead(1.5f, 6.f), offset(-1.f, 1.f);
+		int errors = 0;
+		int drawnSprites = 0;
+		for (int frame = 0; frame < frames; ++frame)
+		{
+			transform = { free_position(map, randGen), angle(randGen) };
+			cameraTransform = { transform.coordinates, transform.forewardAngle + turn(randGen) };
+			//a cluster in front of the camera: sprites overlap each other, some are behind walls
+			math::Vect2 center = transform.coordinates + math::Vect2{ std::cos(transform.forewardAngle), std::sin(transform.forewardAngle) } * ahead(randGen);
+			for (SpriteEntity* entity : entities)
+				entity->m_transform = { center + math::Vect2{ offset(randGen), offset(randGen) }, angle(randGen) };
+
+			state.isLinearPersp = frame % 2 == 0;
+			state.drawSky = frame % 4 < 2;
+			core.view_by_ray_casting(state.isLinearPersp);
+			graphics.render_views(core.get_entities());
+
+			std::vector<const Billboard*> mainBillboards = entity_billboards(core.get_entities());
+			std::vector<const Billboard*> addedBillboards = camera_billboards(core.get_camera_billboards(added));
+			drawnSprites += mainBillboards.size() + addedBillboards.size();
+			mainReference.render_view();
+			mainReference.render_sprites(mainBillboards, spriteTextures, true);
+			addedReference.render_view();
+			addedReference.render_sprites(addedBillboards, spriteTextures, true);
+
+			const char* perspective = state.isLinearPersp ? "linear" : "non linear";
+			int mainMismatches = count_mismatches(graphics.get_view(0), mainReference.view);
+			int addedMismatches = count_mismatches(graphics.get_view(added), addedReference.view);
+			if (mainMismatches != 0)
+				std::cerr << "frame " << frame << " (" << perspective << " perspective): " << mainMismatches << " pixels of the main view differ from the sprite by sprite draw\n";
+			if (addedMismatches != 0)
+				std::cerr << "frame " << frame << " (" << perspective << " perspective): " << addedMismatches << " pixels of the added camera differ from the sprite by sprite draw\n";
+			errors += (mainMismatches != 0) + (addedMismatches != 0);
+		}
+
+		//clusters could all fall behind walls
+		if (drawnSprites < frames * g_spritesNumber / 2)
+		{
+			std::cerr << "only " << drawnSprites << " sprites were drawn in " << frames << " frames\n";
+			++errors;
+		}
+		return errors;
+	}
+}
+
+int main()
+{
+	std::mt19937 randGen(37);
+	int errors = 0;
+
+	GameMap maze;
+	generate_maze(maze, 41, 31);
+	errors += check_batches(maze, 16, randGen);
+
+	GameMap scattered;
+	generate_scattered(scattered, 96, 96, randGen);
+	errors += check_batches(scattered, 16, randGen);
+
+	if (errors != 0)
+	{
+		std::cerr << errors << " views differ from the sprite by sprite draw\n";
+		return 1;
+	}
+	std::cout << "sprites drawn in one batch for every view match the sprite by sprite draw\n";
+	return 0;
+}
@@ -0,0 +1,149 @@
+//Sprites of a batch are drawn nearest first: draw_sprite_section() skips the pixels nearer sprites of the batch already cover
+//(SpriteCoverage) and the columns where a wall is nearer than the sprite. Views must be the same, bit by bit, of the ones drawn in
+//painter's order: farthest first, each sprite in a batch of its own, over the same walls. Checked with clusters of overlapping
+//sprites (with and without clear texels, at every alignment, some larger than the view) partly hidden behind walls of random
+//depths, drawn by strips of columns, on views with a ray per column, with stretched rays and of another size than the window.
+//Textures are loaded from the assets folder copied in the build directory
+
+#include "testViews.hpp"
+#include <iostream>
+
+using namespace rcm;
+using namespace testViews;
+using namespace windowVars;
+
+namespace
+{
+	struct ViewCase
+	{
+		const char* name;
+		int width;
+		int height;
+		int rays;
+	};
+
+	const ViewCase g_views[] = {
+		{ "a ray per column", g_windowWidth, g_windowHeight, g_windowWidth },
+		{ "stretched rays", g_windowWidth, g_windowHeight, 427 },
+		{ "added camera", 800, 432, 800 },
+	};
+
+	constexpr int g_spritesNumber = 48;
+	//strips of the batched draw, their sizes don't divide the view widths
+	constexpr int g_strips = 7;
+
+	//walls of random depths, a few columns to a few hundreds wide
+	void place_walls(RayInfoArr& rays, std::mt19937& randGen)
+	{
+		std::uniform_int_distribution<> run(1, 120);
+		std::uniform_real_distribution<float> depth(0.4f, 14.f);
+		for (int ray = 0; ray < rays.get_size();)
+		{
+			int end = std::min(rays.get_size(), ray + run(randGen));
+			float length = depth(randGen);
+			for (; ray < end; ++ray)
+				rays.store(ray, HitType::Wall, {}, length, CellSide::Vert, 0.f);
+		}
+	}
+
+	//a cluster: sprites a few columns apart, at close distances
+	void place_sprites(std::vector<Billboard>& billboards, std::mt19937& randGen)
+	{
+		const SpriteAlignment alignments[] = { SpriteAlignment::TopWindow, SpriteAlignment::Ceiling, SpriteAlignment::Center, SpriteAlignment::Floor, SpriteAlignment::BottomWindow };
+		std::uniform_real_distribution<float> center(0.f, (float)g_windowWidth), spread(-250.f, 250.f), nearest(0.3f, 8.f), farther(0.f, 4.f), size(0.2f, 1.6f);
+		std::uniform_int_distribution<> alignment(0, 4), texture(0, g_spriteTexturesNumber - 1);
+		float clusterColumn = center(randGen);
+		float clusterDistance = nearest(randGen);
+		for (Billboard& billboard : billboards)
+		{
+			billboard.id = texture(randGen);
+			billboard.alignment = alignments[alignment(randGen)];
+			billboard.size = size(randGen);
+			billboard.positionOnScreen = clusterColumn + spread(randGen);
+			billboard.distance = clusterDistance + farther(randGen);
+		}
+	}
+
+	int check_view(const ViewCase& viewCase, int frames, const std::vector<std::unique_ptr<Texture>>& spriteTextures, std::mt19937& randGen)
+	{
+		RayInfoArr rays(viewCase.rays);
+		rays.resize(viewCase.rays);
+		GraphicsVars graphicsVars;
+		GameView batched, painter;
+		batched.create(viewCase.width, viewCase.height, true);
+		painter.create(viewCase.width, viewCase.height, true);
+
+		SpriteRendSectionFactory batchedSections(viewCase.width, g_strips);
+		batchedSections.set_environment(&batched, &graphicsVars, &rays);
+		SpriteRendSectionFactory painterSections(viewCase.width, 1);
+		painterSections.set_environment(&painter, &graphicsVars, &rays);
+
+		std::vector<Billboard> billboards(g_spritesNumber, Billboard(0));
+		std::vector<const Billboard*> order(g_spritesNumber);
+		std::vector<sf::Uint8> background(viewCase.width * viewCase.height * 4);
+		std::uniform_int_distribution<> noise(0, 255);
+		int errors = 0;
+		//pixels drawn by the sprites, to tell a check from an empty view
+		long long spritePixels = 0;
+		for (int frame = 0; frame < frames; ++frame)
+		{
+			place_walls(rays, randGen);
+			place_sprites(billboards, randGen);
+			//the same pixels under the sprites of both views
+			for (sf::Uint8& channel : background)
+				channel = noise(randGen);
+			std::memcpy(batched.m_pixels, background.data(), background.size());
+			std::memcpy(painter.m_pixels, background.data(), background.size());
+
+			for (int i = 0; i < g_spritesNumber; ++i)
+				order[i] = &billboards[i];
+			std::sort(order.begin(), order.end(), [](const Billboard* a, const Billboard* b) { return a->distance < b->distance; });
+
+			batchedSections.clear_sprites();
+			for (const Billboard* billboard : order)
+				batchedSections.add_sprite(*billboard, *spriteTextures[billboard->id]);
+			for (int strip = 0; strip < batchedSections.get_size(); ++strip)
+				batchedSections.create_section(strip)();
+
+			for (auto billboard = order.rbegin(); billboard != order.rend(); ++billboard)
+			{
+				painterSections.clear_sprites();
+				painterSections.add_sprite(**billboard, *spriteTextures[(*billboard)->id]);
+				painterSections.create_section(0)();
+			}
+
+			int mismatches = count_mismatches(batched, painter);
+			for (int pixel = 0; pixel < viewCase.width * viewCase.height; ++pixel)
+				spritePixels += std::memcmp(painter.m_pixels + pixel * 4, background.data() + pixel * 4, 4) != 0;
+			if (mismatches == 0)
+				continue;
+			std::cerr << viewCase.name << ", frame " << frame << ": " << mismatches << " pixels differ from the painter's order\n";
+			++errors;
+		}
+
+		//clusters could all fall behind walls or out of the view
+		if (spritePixels == 0)
+		{
+			std::cerr << viewCase.name << ": no sprite was drawn\n";
+			++errors;
+		}
+		return errors;
+	}
+}
+
+int main()
+{
+	std::mt19937 randGen(41);
+	std::vector<std::unique_ptr<Texture>> spriteTextures = load_sprite_textures();
+	int errors = 0;
+	for (const ViewCase& viewCase : g_views)
+		errors += check_view(viewCase, 40, spriteTextures, randGen);
+
+	if (errors != 0)
+	{
+		std::cerr << errors << " frames differ from the painter's order\n";
+		return 1;
+	}
+	std::cout << "sprites drawn front to back with coverage match the painter's order\n";
+	return 0;
+}
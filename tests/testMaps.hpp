@@ -0,0 +1,61 @@
+//Maps and comparisons shared by the ray checks
+
+#ifndef TESTMAPS_HPP
+#define TESTMAPS_HPP
+
+#include "gameCore.hpp"
+#include <cstring>
+#include <random>
+
+namespace testMaps
+{
+	//bit by bit
+	inline bool same_ray(const rcm::RayInfo& a, const rcm::RayInfo& b)
+	{
+		return a.entityHit == b.entityHit && a.lastSideChecked == b.lastSideChecked &&
+			std::memcmp(&a.hitPos, &b.hitPos, sizeof(a.hitPos)) == 0 &&
+			std::memcmp(&a.length, &b.length, sizeof(a.length)) == 0 &&
+			std::memcmp(&a.textureU, &b.textureU, sizeof(a.textureU)) == 0;
+	}
+
+	//maze made by the map generator of the game
+	inline void generate_maze(rcm::GameMap& map, int width, int height)
+	{
+		map.width = width;
+		map.height = height;
+		map.cells = std::make_unique<std::string>();
+		MapGenerator generator(1, 1, width, height, *map.cells);
+		generator.generate_map();
+	}
+
+	//open map with scattered walls (percent of the cells), bounded by 'b' cells
+	inline void generate_scattered(rcm::GameMap& map, int width, int height, std::mt19937& randGen, int percentWalls = 8)
+	{
+		std::uniform_int_distribution<> percent(0, 99);
+		map.width = width;
+		map.height = height;
+		map.cells = std::make_unique<std::string>(width * height, ' ');
+		for (int y = 0; y < height; ++y)
+			for (int x = 0; x < width; ++x)
+			{
+				char& cell = map.cells->at(x + y * width);
+				if (x == 0 || y == 0 || x == width - 1 || y == height - 1)
+					cell = 'b';
+				else if (percent(randGen) < percentWalls)
+					cell = 'w';
+			}
+	}
+
+	//random position in a free cell
+	inline math::Vect2 free_position(const rcm::GameMap& map, std::mt19937& randGen)
+	{
+		std::uniform_real_distribution<float> posX(1.f, map.width - 1.f), posY(1.f, map.height - 1.f);
+		math::Vect2 position;
+		do
+			position = { posX(randGen), posY(randGen) };
+		while (map.cells->at((int)position.x + (int)position.y * map.width) != ' ');
+		return position;
+	}
+}
+
+#endif
@@ -0,0 +1,146 @@
+//Views rendered on their own and sprite entities shared by the rendering checks.
+//Textures are loaded from the assets folder copied in the build directory
+
+#ifndef TESTVIEWS_HPP
+#define TESTVIEWS_HPP
+
+#include "gameGraphics.hpp"
+#include "testMaps.hpp"
+#include <algorithm>
+
+namespace testViews
+{
+	const rcm::GameAssets g_assets{ "assets/Roboto-Regular.ttf", "assets/wall2.png", "assets/boundry2.png", "assets/floor2.png", "assets/ceiling2.png", "assets/sky.png" };
+	//sprite texture of each billboard id
+	const char* const g_spriteTextures[] = { "assets/smallheart.png", "assets/lover0.png" };
+	constexpr int g_spriteTexturesNumber = sizeof(g_spriteTextures) / sizeof(g_spriteTextures[0]);
+
+	//an entity that only shows its sprite
+	struct SpriteEntity : public rcm::IEntity
+	{
+		SpriteEntity(const rcm::EntityTransform& transform, int textureId, rcm::SpriteAlignment alignment, float size) : IEntity(textureId, transform)
+		{
+			m_billboard.alignment = alignment;
+			m_billboard.size = size;
+		}
+		void on_create() override {}
+		void on_update() override {}
+		void on_late_update() override {}
+		void on_hit(rcm::EntityType) override {}
+	};
+
+	//same textures GameGraphics loads
+	inline void load_textures(StaticTextures& textures)
+	{
+		textures.wallTexture.create(g_assets.wallTexFilePath, true, true);
+		textures.baundryTexture.create(g_assets.boundryTexFilePath, true, true);
+		textures.floorTexture.create(g_assets.floorTexFilePath, false, true);
+		textures.ceilingTexture.create(g_assets.ceilingTexFilePath, false, true);
+		textures.skyTexture.create(g_assets.skyTexFilePath);
+	}
+
+	inline std::vector<std::unique_ptr<Texture>> load_sprite_textures()
+	{
+		std::vector<std::unique_ptr<Texture>> textures;
+		for (const char* path : g_spriteTextures)
+			textures.push_back(std::make_unique<Texture>(path));
+		return textures;
+	}
+
+	//the billboards GameGraphics draws on the main view
+	inline std::vector<const rcm::Billboard*> entity_billboards(const std::vector<std::unique_ptr<rcm::IEntity>>& entities)
+	{
+		std::vector<const rcm::Billboard*> billboards;
+		for (const std::unique_ptr<rcm::IEntity>& entity : entities)
+		{
+			if (entity->m_visible && entity->m_billboard.distance > 0.2f)
+				billboards.push_back(&entity->m_billboard);
+		}
+		return billboards;
+	}
+
+	//the billboards GameGraphics draws on the view of an added camera
+	inline std::vector<const rcm::Billboard*> camera_billboards(const std::vector<rcm::Billboard>& cameraBillboards)
+	{
+		std::vector<const rcm::Billboard*> billboards;
+		for (const rcm::Billboard& billboard : cameraBillboards)
+		{
+			if (billboard.distance > 0.2f)
+				billboards.push_back(&billboard);
+		}
+		return billboards;
+	}
+
+	//a camera drawn on its own view, as the main view of a core, by sections that run one after the other on this thread
+	struct SingleCameraRender
+	{
+		SingleCameraRender(const rcm::GameCameraView& cameraView, const rcm::RayInfoArr& cameraRays, const StaticTextures& textures, const rcm::GameStateVars& state,
+			const rcm::GraphicsVars& graphicsVars, int height, int sections = 1) :
+			camera(cameraView),
+			rays(cameraRays),
+			viewSecFactory(cameraView.vars.pixelWidth, sections),
+			spriteSecFactory(cameraView.vars.pixelWidth, sections)
+		{
+			view.create(camera.vars.pixelWidth, height, true);
+			background.set_target(&view, &textures, &state, &graphicsVars, &camera);
+			viewSecFactory.set_target(&rays, &view, &textures, &state, &graphicsVars, &camera.transform, &background);
+			spriteSecFactory.set_environment(&view, &graphicsVars, &rays);
+		}
+
+		//walls, floor, ceiling and sky
+		void render_view()
+		{
+			background.update();
+			viewSecFactory.set_task_number(rays.get_size());
+			for (int i = 0; i < viewSecFactory.get_size(); ++i)
+				viewSecFactory.create_section(i)();
+		}
+
+		/// @param spriteBySprite : false draws the sprites in one batch, nearest first (as GameGraphics), true draws them in
+		/// painter's order, farthest first, each one in a batch of its own
+		void render_sprites(std::vector<const rcm::Billboard*> billboards, const std::vector<std::unique_ptr<Texture>>& spriteTextures, bool spriteBySprite)
+		{
+			std::sort(billboards.begin(), billboards.end(), [](const rcm::Billboard* a, const rcm::Billboard* b) { return a->distance < b->distance; });
+			if (spriteBySprite)
+				std::reverse(billboards.begin(), billboards.end());
+
+			spriteSecFactory.clear_sprites();
+			for (const rcm::Billboard* billboard : billboards)
+			{
+				spriteSecFactory.add_sprite(*billboard, *spriteTextures.at(billboard->id));
+				if (spriteBySprite)
+				{
+					draw_sprite_sections();
+					spriteSecFactory.clear_sprites();
+				}
+			}
+			draw_sprite_sections();
+		}
+
+		GameView view;
+		rcm::GameCameraView camera;
+		const rcm::RayInfoArr& rays;
+		BackgroundRows background;
+		ViewRendSectionFactory viewSecFactory;
+		SpriteRendSectionFactory spriteSecFactory;
+
+	private:
+		void draw_sprite_sections()
+		{
+			if (!spriteSecFactory.has_sprites())
+				return;
+			for (int i = 0; i < spriteSecFactory.get_size(); ++i)
+				spriteSecFactory.create_section(i)();
+		}
+	};
+
+	inline int count_mismatches(const GameView& view, const GameView& reference)
+	{
+		int mismatches = 0;
+		for (int pixel = 0; pixel < view.m_width * view.m_height; ++pixel)
+			mismatches += std::memcmp(view.m_pixels + pixel * 4, reference.m_pixels + pixel * 4, 4) != 0;
+		return mismatches;
+	}
+}
+
+#endif
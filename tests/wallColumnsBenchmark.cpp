@@ -0,0 +1,133 @@
+//Time spent drawing the walls and background of a frame (one view section, one thread) with the walls written straight into
+//the view rows and with the walls drawn in columns then copied to the rows, at 720p, 1080p and 1440p.
+//GraphicsVars::columnMajorWallsMinHeight is the lowest height where the columns are faster.
+//Not a check (timings depend on the machine): run it by hand from a release build, from the build directory (it loads the assets)
+
+#include "gameGraphics.hpp"
+#include "testMaps.hpp"
+#include <chrono>
+#include <climits>
+#include <iostream>
+
+using namespace rcm;
+using namespace testMaps;
+
+namespace
+{
+	struct ViewSize
+	{
+		const char* name;
+		int width;
+		int height;
+	};
+
+	const ViewSize g_sizes[] = {
+		{ "720p", 1280, 720 },
+		{ "1080p", 1920, 1080 },
+		{ "1440p", 2560, 1440 },
+	};
+
+	constexpr int g_frames = 100;
+
+	struct WallPath
+	{
+		const char* name;
+		int columnMajorWallsMinHeight;
+	};
+
+	const WallPath g_paths[] = {
+		{ "rows", INT_MAX },
+		{ "columns", 0 },
+	};
+
+	//milliseconds per frame of each path, linear and non linear perspective
+	struct SizeTimes
+	{
+		double ms[2][2]{};
+	};
+
+	SizeTimes time_size(const ViewSize& size, GameMap& map, const StaticTextures& textures, std::mt19937& randGen)
+	{
+		std::vector<EntityTransform> poses(g_frames);
+		std::uniform_real_distribution<float> angle(-3.14f, 3.14f);
+		for (EntityTransform& pose : poses)
+			pose = { free_position(map, randGen), angle(randGen) };
+
+		RendThreadPool rendThreadPool(1);
+		EntityTransform transform = poses.front();
+		GameCameraVars cameraVars;
+		cameraVars.pixelWidth = size.width;
+		cameraVars.pixelHeight = size.height;
+		cameraVars.fov = math::deg_to_rad(90);
+		cameraVars.maxRenderDist = 20.f;
+		GameCore core(cameraVars, map, transform, rendThreadPool);
+		GameCameraView camera{ transform, core.get_camera_vars(), core.get_camera_vecs() };
+
+		GameView view;
+		view.create(size.width, size.height, true);
+		GameStateVars state;
+		GraphicsVars graphicsVars;
+		graphicsVars.maxSightDepth = cameraVars.maxRenderDist;
+		graphicsVars.mipmaps = true;
+		BackgroundRows background;
+		background.set_target(&view, &textures, &state, &graphicsVars, &camera);
+		//a single section: the time of one thread drawing the whole view
+		ViewRendSectionFactory viewSecFactory(size.width, 1);
+		viewSecFactory.set_target(&core.get_ray_info_arr(), &view, &textures, &state, &graphicsVars, &transform, &background);
+
+		SizeTimes times;
+		for (int path = 0; path < 2; ++path)
+		{
+			graphicsVars.columnMajorWallsMinHeight = g_paths[path].columnMajorWallsMinHeight;
+			for (int linear = 0; linear < 2; ++linear)
+			{
+				state.isLinearPersp = linear;
+				for (const EntityTransform& pose : poses)
+				{
+					transform = pose;
+					core.view_by_ray_casting(linear);
+					background.update();
+					auto start = std::chrono::steady_clock::now();
+					viewSecFactory.create_section(0)();
+					times.ms[path][linear] += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+				}
+				times.ms[path][linear] /= g_frames;
+			}
+		}
+		return times;
+	}
+}
+
+int main()
+{
+	std::mt19937 randGen(23);
+
+	StaticTextures textures;
+	textures.wallTexture.create("assets/wall2.png", true, true);
+	textures.baundryTexture.create("assets/boundry2.png", true, true);
+	textures.floorTexture.create("assets/floor2.png", false, true);
+	textures.ceilingTexture.create("assets/ceiling2.png", false, true);
+	textures.skyTexture.create("assets/sky.png");
+
+	GameMap maze;
+	generate_maze(maze, 201, 201);
+
+	//smallest size from which the columns are faster at every larger size
+	const ViewSize* fasterFrom = nullptr;
+	for (const ViewSize& size : g_sizes)
+	{
+		SizeTimes times = time_size(size, maze, textures, randGen);
+		std::cout << size.name << ":\n";
+		for (int path = 0; path < 2; ++path)
+			std::cout << "  " << g_paths[path].name << ": " << times.ms[path][1] << " ms linear, " << times.ms[path][0] << " ms non linear per frame\n";
+
+		bool columnsFaster = times.ms[1][1] < times.ms[0][1] && times.ms[1][0] < times.ms[0][0];
+		if (!columnsFaster)
+			fasterFrom = nullptr;
+		else if (fasterFrom == nullptr)
+			fasterFrom = &size;
+	}
+	std::cout << "columns faster in both perspectives from: " << (fasterFrom ? fasterFrom->name : "never") << " (GraphicsVars::columnMajorWallsMinHeight is "
+		<< GraphicsVars{}.columnMajorWallsMinHeight << ")\n";
+	return 0;
+}
@@ -0,0 +1,92 @@
+//Wall spans must fill the rays of a camera the same, bit by bit, of casting a ray per column:
+//sprites are tested against the same lengths, columns that hit nothing included
+
+#include "testMaps.hpp"
+#include <iostream>
+
+using namespace rcm;
+using namespace testMaps;
+
+namespace
+{
+	//number of columns that differ from the ones cast by rays
+	int compare_spans(GameMap& map, int renderWidth, float maxRenderDist, int frames, std::mt19937& randGen)
+	{
+		RendThreadPool rendThreadPool(4);
+		EntityTransform transform{ { 1.5f, 1.5f }, 0.f };
+		GameCameraVars rayVars, spanVars;
+		for (GameCameraVars* cameraVars : { &rayVars, &spanVars })
+		{
+			cameraVars->pixelWidth = renderWidth;
+			cameraVars->pixelHeight = 720;
+			cameraVars->fov = math::deg_to_rad(90);
+			cameraVars->maxRenderDist = maxRenderDist;
+		}
+		spanVars.wallSpans = true;
+		GameCore rayCore(rayVars, map, transform, rendThreadPool);
+		GameCore spanCore(spanVars, map, transform, rendThreadPool);
+
+		std::uniform_real_distribution<float> angle(-3.14f, 3.14f);
+		int mismatches = 0;
+		for (int frame = 0; frame < frames; ++frame)
+		{
+			transform.coordinates = free_position(map, randGen);
+			transform.forewardAngle = angle(randGen);
+			//from a cell border, and diagonally from a cell center through the cell corners
+			if (frame % 5 == 0)
+				transform.coordinates.y = std::floor(transform.coordinates.y);
+			if (frame % 5 == 1)
+			{
+				transform.coordinates = { std::floor(transform.coordinates.x) + 0.5f, std::floor(transform.coordinates.y) + 0.5f };
+				transform.forewardAngle = (frame % 8) * math::deg_to_rad(45);
+			}
+
+			rayCore.update_entities();
+			spanCore.update_entities();
+
+			for (int cameraPlane = 0; cameraPlane < 2; ++cameraPlane)
+			{
+				rayCore.view_by_ray_casting(cameraPlane);
+				spanCore.view_by_ray_casting(cameraPlane);
+
+				const RayInfoArr& reference = rayCore.get_ray_info_arr();
+				const RayInfoArr& spans = spanCore.get_ray_info_arr();
+				for (int column = 0; column < renderWidth; ++column)
+				{
+					if (same_ray(reference.const_at(column), spans.const_at(column)))
+						continue;
+					if (mismatches < 10)
+						std::cerr << "column " << column << " differs (frame " << frame << ", " << (cameraPlane ? "linear" : "non linear")
+							<< " perspective, hit " << static_cast<int>(spans.hit_type(column)) << " instead of " << static_cast<int>(reference.hit_type(column))
+							<< ", length " << spans.length(column) << " instead of " << reference.length(column) << ")\n";
+					++mismatches;
+				}
+			}
+		}
+		return mismatches;
+	}
+}
+
+int main()
+{
+	std::mt19937 randGen(13);
+	int mismatches = 0;
+
+	GameMap maze;
+	generate_maze(maze, 41, 31);
+	mismatches += compare_spans(maze, 1280, 20.f, 200, randGen);
+
+	//many columns hit nothing before the render distance
+	GameMap open;
+	generate_scattered(open, 128, 128, randGen, 3);
+	mismatches += compare_spans(open, 1283, 12.f, 200, randGen);
+	mismatches += compare_spans(open, 1280, 60.f, 100, randGen);
+
+	if (mismatches != 0)
+	{
+		std::cerr << mismatches << " columns differ from the rays cast per column\n";
+		return 1;
+	}
+	std::cout << "wall spans match the rays cast per column\n";
+	return 0;
+}
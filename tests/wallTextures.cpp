@@ -0,0 +1,207 @@
+//Wall columns sampled from the column major copy of a texture must be the same, bit by bit, of the ones sampled from its rows,
+//at every mip level, in both perspectives. Walls of textures with a power of two height wrap their rows with a mask: every pixel
+//must be the texel of the row wrapped as the other textures do (back to row 0 at the end of the texture), darkened by the wall shade.
+//Textures are loaded from the assets folder copied in the build directory
+
+#include "gameGraphics.hpp"
+#include <cstring>
+#include <iostream>
+#include <random>
+
+using namespace rcm;
+using namespace windowVars;
+
+namespace
+{
+	//a texture without and one with clear texels (and a height that is not a power of two)
+	const char* const g_wallTextures[] = { "assets/wall2.png", "assets/heart.png" };
+	const int g_viewHeights[] = { g_windowHeight, 433 };
+	constexpr int g_rays = 2000;
+	//walls nearer than a tenth of a cell are many times taller than the view
+	constexpr float g_minDistance = 0.1f, g_maxDistance = 30.f;
+
+	void load_textures(StaticTextures& textures, const char* wallTexture, bool columnMajor)
+	{
+		textures.wallTexture.create(wallTexture, columnMajor, true);
+		textures.baundryTexture.create("assets/boundry2.png", columnMajor, true);
+		textures.floorTexture.create("assets/floor2.png", false, true);
+		textures.ceilingTexture.create("assets/ceiling2.png", false, true);
+	}
+
+	//every texel of every level of the column major copy: texels that differ from the row major ones
+	int check_column_copies(const Texture& texture)
+	{
+		int mismatches = 0;
+		//levels past the last one give the last one
+		for (int level = 0; level == 0 || &texture.get_mip(level) != &texture.get_mip(level - 1); ++level)
+		{
+			const Texture& mip = texture.get_mip(level);
+			for (int u = 0; u < mip.width(); ++u)
+				for (int v = 0; v < mip.height(); ++v)
+				{
+					if (std::memcmp(mip.get_column(u) + v * 4, mip.m_texturePixels + (v * mip.width() + u) * 4, 4) == 0)
+						continue;
+					if (mismatches < 10)
+						std::cerr << "texel " << u << ", " << v << " of level " << level << " differs in the column major copy\n";
+					++mismatches;
+				}
+		}
+		return mismatches;
+	}
+
+	//walls and boundaries at random distances, seen from every side
+	void place_rays(RayInfoArr& rays, std::mt19937& randGen)
+	{
+		std::uniform_real_distribution<float> distance(g_minDistance, g_maxDistance), angle(-PI, PI), textureU(0.f, 1.f);
+		for (int i = 0; i < rays.get_size(); ++i)
+		{
+			float length = distance(randGen);
+			float direction = angle(randGen);
+			math::Vect2 hitPos{ std::cos(direction) * length, std::sin(direction) * length };
+			rays.store(i, i % 5 == 0 ? HitType::Baudry : HitType::Wall, hitPos, length, i % 2 ? CellSide::Vert : CellSide::Hori, textureU(randGen));
+		}
+	}
+
+	//the same rays drawn with column major and with row major textures: pixels and masks that differ
+	int compare_layouts(const char* wallTexture, int viewHeight, std::mt19937& randGen)
+	{
+		StaticTextures columnMajor, rowMajor;
+		load_textures(columnMajor, wallTexture, true);
+		load_textures(rowMajor, wallTexture, false);
+
+		RayInfoArr rays(g_rays);
+		place_rays(rays, randGen);
+		GraphicsVars graphicsVars;
+		graphicsVars.maxSightDepth = g_maxDistance;
+		FloorRowTables rowTables;
+		rowTables.update(graphicsVars, viewHeight);
+		EntityTransform transform{ { 10.5f, 20.25f }, 0.f };
+		WallColumns columnReads, rowReads;
+		columnReads.create(g_rays, viewHeight);
+		rowReads.create(g_rays, viewHeight);
+
+		int mismatches = 0;
+		for (int mipmaps = 0; mipmaps < 2; ++mipmaps)
+			for (int linear = 0; linear < 2; ++linear)
+			{
+				graphicsVars.mipmaps = mipmaps;
+				std::fill(columnReads.pixels.begin(), columnReads.pixels.end(), 0);
+				std::fill(rowReads.pixels.begin(), rowReads.pixels.end(), 0);
+				for (int i = 0; i < g_rays; ++i)
+				{
+					GameGraphics::draw_wall_column(i, linear, rays, columnReads.column(i), 4, columnReads, graphicsVars, rowTables, columnMajor, transform);
+					GameGraphics::draw_wall_column(i, linear, rays, rowReads.column(i), 4, rowReads, graphicsVars, rowTables, rowMajor, transform);
+				}
+
+				for (int i = 0; i < g_rays; ++i)
+				{
+					bool same = std::memcmp(columnReads.column(i), rowReads.column(i), columnReads.columnSize) == 0 &&
+						std::memcmp(columnReads.mask.data() + i * viewHeight, rowReads.mask.data() + i * viewHeight, viewHeight) == 0;
+					if (same)
+						continue;
+					if (mismatches < 10)
+						std::cerr << wallTexture << ", " << viewHeight << " rows, mipmaps " << (mipmaps ? "on" : "off") << (linear ? ", linear" : ", non linear")
+							<< ": column of ray " << i << " (distance " << rays.length(i) << ") differs from the row major reads\n";
+					++mismatches;
+				}
+			}
+		return mismatches;
+	}
+
+	//walls of a texture with a power of two height, drawn in linear perspective: pixels that differ from the texels of the rows
+	//wrapped back to 0 at the end of the texture
+	int check_wrap(const char* wallTexture, int viewHeight, std::mt19937& randGen)
+	{
+		StaticTextures textures;
+		load_textures(textures, wallTexture, true);
+		if (!textures.wallTexture.has_power_of_two_height())
+			return 0;
+
+		//seen from a side that doesn't flip the texture
+		RayInfoArr rays(g_rays);
+		std::uniform_real_distribution<float> distance(g_minDistance, g_maxDistance), textureU(0.f, 1.f);
+		for (int i = 0; i < g_rays; ++i)
+		{
+			float length = distance(randGen);
+			rays.store(i, HitType::Wall, { -length, 0.f }, length, CellSide::Vert, textureU(randGen));
+		}
+
+		GraphicsVars graphicsVars;
+		graphicsVars.maxSightDepth = g_maxDistance;
+		FloorRowTables rowTables;
+		rowTables.update(graphicsVars, viewHeight);
+		WallColumns columns;
+		columns.create(g_rays, viewHeight);
+
+		int mismatches = 0;
+		for (int mipmaps = 0; mipmaps < 2; ++mipmaps)
+		{
+			graphicsVars.mipmaps = mipmaps;
+			for (int i = 0; i < g_rays; ++i)
+			{
+				GameGraphics::draw_wall_column(i, true, rays, columns.column(i), 4, columns, graphicsVars, rowTables, textures, EntityTransform{});
+
+				//the wall as draw_wall_column() places it
+				float screenWallHeight = (viewHeight / rays.length(i)) * graphicsVars.halfWallHeight;
+				float floorHeight = (viewHeight - screenWallHeight) / 2;
+				sf::Uint8 shade = (1 - (rays.length(i) / graphicsVars.maxSightDepth)) * 0xFF;
+				const Texture& texture = mipmaps
+					? textures.wallTexture.get_mip(textures.wallTexture.get_mip_for_step(textures.wallTexture.height() / screenWallHeight))
+					: textures.wallTexture;
+				float texVStep = texture.height() / screenWallHeight;
+				int textureU = (int)(rays.texture_u(i) * texture.width());
+				float textureV = screenWallHeight > viewHeight ? texVStep * ((screenWallHeight - viewHeight) / 2) : 0;
+
+				for (int y = 0; y < viewHeight; ++y)
+				{
+					if (!(y * 4 > floorHeight * 4 && y * 4 <= (viewHeight - floorHeight) * 4))
+						continue;
+					if (textureV >= texture.height())
+						textureV = 0;
+					const sf::Uint8* texel = texture.m_texturePixels + ((int)textureV * texture.width() + textureU) * 4;
+					textureV += texVStep;
+
+					const sf::Uint8* pixel = columns.column(i) + y * 4;
+					bool same = pixel[3] == 0xFF;
+					//channel * shade / 255 is never half way between two integers
+					for (int c = 0; c < 3; ++c)
+						same = same && pixel[c] == (2 * texel[c] * shade + 255) / 510;
+					if (same)
+						continue;
+					if (mismatches < 10)
+						std::cerr << wallTexture << ", " << viewHeight << " rows, mipmaps " << (mipmaps ? "on" : "off") << ": row " << y << " of ray " << i
+							<< " (distance " << rays.length(i) << ") differs from the texel of the row wrapped back to 0\n";
+					++mismatches;
+				}
+			}
+		}
+		return mismatches;
+	}
+}
+
+int main()
+{
+	std::mt19937 randGen(43);
+	int mismatches = 0;
+
+	for (const char* wallTexture : g_wallTextures)
+	{
+		Texture texture;
+		texture.create(wallTexture, true, true);
+		mismatches += check_column_copies(texture);
+
+		for (int viewHeight : g_viewHeights)
+		{
+			mismatches += compare_layouts(wallTexture, viewHeight, randGen);
+			mismatches += check_wrap(wallTexture, viewHeight, randGen);
+		}
+	}
+
+	if (mismatches != 0)
+	{
+		std::cerr << mismatches << " texels, columns or pixels differ from the row major, wrapped back to 0 reads\n";
+		return 1;
+	}
+	std::cout << "column major copies and masked rows match the row major reads wrapped back to 0\n";
+	return 0;
+}